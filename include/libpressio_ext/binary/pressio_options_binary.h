@@ -0,0 +1,59 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  /**
+   * \file
+   * \brief binary serialization and deserialization for options structures
+   */
+
+#ifndef PRESSIO_OPTIONS_BINARY_H
+/**
+ * header guard
+ */
+#define PRESSIO_OPTIONS_BINARY_H
+#include <stddef.h>
+
+struct pressio;
+struct pressio_data;
+struct pressio_options;
+
+  /**
+   * Converts pressio_options to a compact, versioned binary encoding.  Unlike JSON, the encoding preserves
+   * the type of every entry and stores pressio_data values without conversion.  Entries of type
+   * pressio_option_userptr_type are omitted.
+   *
+   * \param[in] library optional argument, if the encoding fails, the error message is stored in the library object
+   * \param[in] options the options structure to serialize
+   * \return a byte pressio_data that needs to be freed with pressio_data_free
+   */
+ struct pressio_data* pressio_options_to_binary(struct pressio* library, struct pressio_options const* options);
+
+  /**
+   * Converts the binary encoding produced by pressio_options_to_binary to a pressio_options structure.
+   * Data payloads are copied out of the buffer.
+   *
+   * \param[in] library optional argument, if the parse fails, the error message is stored in the library object
+   * \param[in] buffer the encoded options
+   * \param[in] size the size of buffer in bytes
+   * \return a pressio_options that needs to be freed with pressio_options_free
+   */
+ struct pressio_options* pressio_options_new_binary(struct pressio* library, const void* buffer, size_t size);
+
+  /**
+   * Converts the binary encoding produced by pressio_options_to_binary to a pressio_options structure
+   * without copying data payloads.  The pressio_data values in the result refer to the memory of buffer
+   * which must outlive them.
+   *
+   * \param[in] library optional argument, if the parse fails, the error message is stored in the library object
+   * \param[in] buffer the encoded options
+   * \param[in] size the size of buffer in bytes
+   * \return a pressio_options that needs to be freed with pressio_options_free
+   */
+ struct pressio_options* pressio_options_new_binary_nocopy(struct pressio* library, const void* buffer, size_t size);
+
+#endif /* end of include guard: PRESSIO_OPTIONS_BINARY_H */
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,61 @@
+#ifndef LIBPRESSIO_BINARY_H
+#define LIBPRESSIO_BINARY_H
+#include <cstddef>
+
+/**
+ * \file
+ * \brief C++ interface to the binary serialization of pressio_options
+ *
+ * The encoding is versioned and self-describing: a header, then one record per option consisting of
+ * the key, a tag holding the option type, and the value.  Integers are stored as (zig-zag) varints,
+ * floating point values and pressio_data payloads are stored raw in the native byte order with payloads
+ * aligned to 8 bytes from the start of the buffer, so they can be decoded without copying.
+ *
+ * Entries of type pressio_option_userptr_type are omitted.  The functions in this header throw
+ * std::runtime_error if the input is not a valid encoding.
+ */
+
+struct pressio_data;
+struct pressio_options;
+
+/**
+ * \param[in] options the options to encode
+ * \returns the number of bytes options_to_binary will produce for options
+ */
+size_t options_binary_size(pressio_options const& options);
+
+/**
+ * \param[in] options the options to encode
+ * \returns a byte buffer containing the encoded options
+ */
+pressio_data options_to_binary(pressio_options const& options);
+
+/**
+ * decode options from a buffer, copying pressio_data payloads out of it
+ *
+ * \param[in] buffer the encoded options
+ * \param[in] size the size of buffer in bytes
+ * \returns the decoded options
+ */
+pressio_options options_from_binary(const void* buffer, size_t size);
+
+/**
+ * decode options from a buffer without copying pressio_data payloads;  the decoded pressio_data values
+ * are non-owning views into buffer which must outlive them.
+ *
+ * \param[in] buffer the encoded options
+ * \param[in] size the size of buffer in bytes
+ * \returns the decoded options
+ */
+pressio_options options_from_binary_nocopy(const void* buffer, size_t size);
+
+/**
+ * decode options from a buffer without copying pressio_data payloads;  the decoded pressio_data values
+ * share ownership of the buffer which is freed once the last of them is freed.
+ *
+ * \param[in] buffer the encoded options, ownership is transferred to the decoded values
+ * \returns the decoded options
+ */
+pressio_options options_from_binary(pressio_data&& buffer);
+
+#endif /* end of include guard: LIBPRESSIO_BINARY_H */
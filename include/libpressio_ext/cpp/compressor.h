@@ -15,6 +15,7 @@
 struct pressio_data;
 struct pressio_options;
 class libpressio_metrics_plugin;
+class libpressio_io_plugin;
 
 /**
  * plugin to provide a new compressor
@@ -79,7 +80,10 @@ class libpressio_compressor_plugin :public pressio_configurable, public pressio_
    * The compressor should set a value if they have been set as default
    * The compressor should set a "reset" value if they are required to be set, but don't have a meaningful default
    *
+   * The result is cached until the options or name of a configurable object change
+   *
    * \see pressio_compressor_get_options for the semantics this function should obey
+   * \see pressio_configurable::bump_generation to invalidate the cached result
    * \see pressio_options_clear to set a "reset" value
    * \see pressio_options_set_integer to set an integer value
    * \see pressio_options_set_double to set an double value
@@ -95,13 +99,13 @@ class libpressio_compressor_plugin :public pressio_configurable, public pressio_
    */
   int check_options(struct pressio_options const& options) override final;
 
-  /** get the compile time configuration of a compressor, handles metrics calls
+  /** get the compile time configuration of a compressor, handles metrics calls; cached like get_options
    *
    * \see pressio_compressor_get_configuration for the semantics this function should obey
    */
   struct pressio_options get_configuration() const override final;
 
-  /** get the documentation of a compressor, handles metrics calls
+  /** get the documentation of a compressor, handles metrics calls; cached like get_options
    *
    * \see pressio_compressor_get_documentation for the semantics this function should obey
    */
@@ -195,6 +199,55 @@ class libpressio_compressor_plugin :public pressio_configurable, public pressio_
     return ret;
   }
 
+  /**
+   * compresses data that may be too large to fit in memory.
+   *
+   * The input is read in slabs along its slowest varying dimension using read_region.
+   * The first write to output is a header recording the dtype and dimensions of the input, the slab size,
+   * and the prefix of the compressor.  Each slab is then compressed and written to output as one frame of
+   * the form [uint64_t compressed size][compressed bytes], so the number of frames is
+   * ceil(dims.back() / slab_size).  Reading, compression, and writing run concurrently,
+   * and at most window slabs are held in memory at once.  decompress_stream reverses the process.
+   *
+   * The input and output plugins are each used from a single background thread
+   * and must not be used elsewhere until this function returns.
+   *
+   * \param[in] input the io plugin to read slabs from
+   * \param[in] input_template the dtype and dimensions of the complete input
+   * \param[in] output the io plugin to write frames to; each frame is passed to a separate call to write,
+   * so output must append rather than replace, as the posix plugin does with io:file_descriptor.  Plugins
+   * with io:path set are rejected since they reopen the path on each call.
+   * \param[in] slab_size the extent of each slab in the slowest varying dimension
+   * \param[in] window the maximum number of slabs held in memory at once
+   * \returns 0 if successful, non-zero on error
+   */
+  int compress_stream(libpressio_io_plugin& input, pressio_data const& input_template,
+      libpressio_io_plugin& output, size_t slab_size, size_t window);
+
+  /**
+   * decompresses a stream written by compress_stream with a compressor with the same prefix.
+   *
+   * The header and frames are read from input with successive calls to read, each passed an empty
+   * byte buffer of the number of bytes wanted, so input must return consecutive bytes of the stream,
+   * as the posix plugin does with io:file_descriptor.  Each decompressed slab is passed to a separate
+   * call to output.write in order, so the concatenation of the writes is the complete input.  Plugins
+   * with io:path set are rejected for either input or output since they reopen the path on each call.
+   * A frame larger than twice the size of its decompressed slab plus 1MiB is treated as corrupt.
+   * Reading, decompression, and writing run concurrently, and at most window slabs are held in
+   * memory at once.
+   *
+   * The input and output plugins are each used from a single background thread
+   * and must not be used elsewhere until this function returns.
+   *
+   * \param[in] input the io plugin to read the stream from
+   * \param[in] output the io plugin to write decompressed slabs to
+   * \param[in] window the maximum number of slabs held in memory at once
+   * \param[out] output_template if not null, set to an empty pressio_data with the dtype and dimensions of the complete input
+   * \returns 0 if successful, non-zero on error
+   */
+  int decompress_stream(libpressio_io_plugin& input, libpressio_io_plugin& output, size_t window,
+      pressio_data* output_template = nullptr);
+
   /**
    * \returns a pressio_options structure containing the metrics returned by the provided metrics plugin
    * \see libpressio_metricsplugin for how to compute results
@@ -291,6 +344,9 @@ class libpressio_compressor_plugin :public pressio_configurable, public pressio_
   virtual int compress_many_impl(compat::span<const pressio_data* const> const& inputs, compat::span<pressio_data*> & outputs);
 
   private:
+  pressio_options_cache options_cache;
+  pressio_options_cache configuration_cache;
+  pressio_options_cache documentation_cache;
   pressio_metrics metrics_plugin;
   std::string metrics_id;
   int32_t metrics_errors_fatal = 1;
@@ -1,7 +1,11 @@
 #ifndef LIBPRESSIO_CONFIGURABLE_H
 #define LIBPRESSIO_CONFIGURABLE_H
+#include <cstdint>
+#include <functional>
+#include <mutex>
 #include <string>
 #include <utility>
+#include <vector>
 #include "options.h"
 #include "pressio_compressor.h"
 
@@ -35,8 +39,55 @@ class pressio_configurable {
   virtual void set_name(std::string const& new_name) {
     this->set_name_impl(new_name);
     this->name = new_name;
+    bump_generation();
   }
 
+  /**
+   * \returns a counter that increases each time the options or name of this object change
+   */
+  uint64_t get_generation() const {
+    return generation;
+  }
+
+  /**
+   * records that the options or name of this object changed.  This is done by set_name and the
+   * set_options of the plugin base classes; plugins whose options change in other ways should call it
+   * so that results cached by this object, or by any object containing it, are recomputed.
+   */
+  void bump_generation();
+
+  /**
+   * \returns a counter that increases each time the generation of any configurable object changes.
+   * Results computed from a configurable object and its children remain valid while it is unchanged.
+   */
+  static uint64_t current_epoch();
+
+  /**
+   * called after set_options changes the options of a configurable object with the entries of
+   * get_options() that changed and their new values
+   */
+  using options_listener = std::function<void(pressio_configurable const&, pressio_options const&)>;
+
+  /**
+   * registers a function to be called each time set_options changes the options of this object.
+   * Listeners are not copied when the object is copied or cloned.
+   *
+   * \param[in] listener the function to call
+   * \returns an id that can be passed to remove_options_listener
+   */
+  uint64_t add_options_listener(options_listener listener);
+
+  /**
+   * \param[in] id the id returned from add_options_listener of the listener to remove
+   */
+  void remove_options_listener(uint64_t id);
+
+  /**
+   * \param[in] options the options that would be passed to set_options
+   * \returns the entries of get_options() that options would change, with the values from options
+   */
+  pressio_options changed_options(pressio_options const& options) const;
+
   /**
    * Meta-compressors need to know when names are changed so they can update their children
    *
@@ -279,6 +330,65 @@ class pressio_configurable {
 
   protected:
 
+  /**
+   * plugins that call option_changed from set_options_impl call this from their constructor so that
+   * the options in effect before each call to set_options are recorded
+   *
+   * \param[in] track if the changes should be recorded
+   */
+  void track_option_changes(bool track = true) {
+    changes.tracking = track;
+  }
+
+  /**
+   * allows plugins to skip expensive reconfiguration when nothing they depend on changed.
+   * Only meaningful within set_options when track_option_changes was called; otherwise it
+   * conservatively returns true.
+   *
+   * \param[in] key the key to check, without the name prefix
+   * \returns false if key was reported by get_options() before set_options was called and the
+   * options being set leave it unchanged
+   */
+  template <class StringType>
+  bool option_changed(StringType const& key) const {
+    if(changes.incoming == nullptr) return true;
+    if(name.empty()) return option_changed(changes.before.find(key), "", key);
+    return option_changed(changes.before.find(name, key), name, key);
+  }
+
+  /**
+   * records the options in effect before set_options for option_changed and the options listeners,
+   * and afterwards, if set_options succeeded, bumps the generation and notifies the listeners.  Used
+   * by the set_options of the plugin base classes.
+   */
+  class options_change_scope {
+    public:
+    /**
+     * \param[in] configurable the object whose options are being set
+     * \param[in] options the options being set
+     */
+    options_change_scope(pressio_configurable& configurable, pressio_options const& options);
+    ~options_change_scope();
+    options_change_scope(options_change_scope const&)=delete;
+    options_change_scope& operator=(options_change_scope const&)=delete;
+
+    /**
+     * records the result of setting the options; nothing is reported unless this is called with
+     * a result that is not an error
+     *
+     * \param[in] rc the return value of set_options_impl
+     * \returns rc
+     */
+    int finish(int rc) {
+      succeeded = rc <= 0;
+      return rc;
+    }
+
+    private:
+    pressio_configurable& configurable;
+    bool succeeded = false;
+  };
+
   /**
    * 
    * \returns that returns the thread_safe configuration parameter
@@ -299,6 +409,69 @@ class pressio_configurable {
 
   /** the name of the configurable used in nested hierarchies*/
   std::string name;
+
+  private:
+  bool option_changed(pressio_options::const_iterator before, compat::string_view const& name, compat::string_view const& key) const;
+
+  /** the state used by option_changed and the options listeners; copies start out empty */
+  struct option_changes {
+    option_changes()=default;
+    option_changes(option_changes const& rhs): tracking(rhs.tracking) {}
+    option_changes& operator=(option_changes const& rhs) {
+      tracking = rhs.tracking;
+      return *this;
+    }
+
+    bool tracking = false;
+    pressio_options const* incoming = nullptr;
+    pressio_options before;
+    uint64_t next_listener_id = 0;
+    std::vector<std::pair<uint64_t, options_listener>> listeners;
+  };
+
+  uint64_t generation = 0;
+  option_changes changes;
+};
+
+/**
+ * memoizes a pressio_options computed from a configurable object until the options or name of any
+ * configurable object change.  Copies start out empty.
+ */
+class pressio_options_cache {
+  public:
+  pressio_options_cache()=default;
+  /** copies start out empty */
+  pressio_options_cache(pressio_options_cache const&) {}
+  /** assignment empties the cache \returns *this */
+  pressio_options_cache& operator=(pressio_options_cache const&) {
+    std::lock_guard<std::mutex> guard(lock);
+    cached_epoch = 0;
+    return *this;
+  }
+
+  /**
+   * \param[in] compute called to compute the options if the cached value is out of date
+   * \returns the cached options, or the result of compute
+   */
+  template <class Compute>
+  pressio_options get(Compute&& compute) const {
+    const uint64_t epoch = pressio_configurable::current_epoch();
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      if(cached_epoch == epoch) return value;
+    }
+    //compute without holding the lock; compute may query this object again
+    pressio_options computed = compute();
+    std::lock_guard<std::mutex> guard(lock);
+    value = computed;
+    cached_epoch = epoch;
+    return computed;
+  }
+
+  private:
+  mutable std::mutex lock;
+  mutable uint64_t cached_epoch = 0;
+  mutable pressio_options value;
 };
 
 #endif /* end of include guard: LIBPRESSIO_CONFIGURABLE_H */
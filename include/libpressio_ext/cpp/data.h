@@ -316,6 +316,28 @@ struct pressio_data {
   bool has_data() const {
     return data_ptr != nullptr && size_in_bytes() > 0;
   }
+
+  /**
+   * \returns true if the structure frees its buffer when it is destroyed
+   */
+  bool owns_data() const noexcept {
+    return deleter != nullptr;
+  }
+
+  /**
+   * gives up ownership of a buffer allocated with malloc so that it can be handed to code that
+   * frees it with free without copying it.  Afterwards the structure keeps its type and dimensions
+   * but has no data.
+   *
+   * \returns the buffer, or nullptr if the buffer is not owned or not freed with free; in that case
+   * the structure is unchanged
+   */
+  void* release_malloc() noexcept {
+    if(deleter != pressio_data_libc_free_fn) return nullptr;
+    deleter = nullptr;
+    metadata_ptr = nullptr;
+    return compat::exchange(data_ptr, nullptr);
+  }
   
   /**
    * \returns the data type of the buffer
@@ -2,6 +2,7 @@
 #define PRESSIO_IO_PLUGIN_H
 #include <string>
 #include <memory>
+#include <vector>
 #include "configurable.h"
 #include "versionable.h"
 #include "errorable.h"
@@ -32,6 +33,29 @@ struct libpressio_io_plugin: public pressio_configurable, public pressio_version
    */
   struct pressio_data* read(struct pressio_data* data);
 
+  /** reads a subset of a pressio_data buffer from some persistent storage. Modules should override read_region_impl instead.
+   *
+   * The result is equivalent to read(data)->select(start, stride, count, block), but modules which
+   * support it only read the selected elements from storage.
+   *
+   * \param[in] data data object describing the full dataset (type and dimensions), or nullptr to
+   * determine them from the file if supported.  callers should treat this buffer as if it is moved
+   * in a C++11 sense
+   * \param[in] start the position in the array to start reading, start[i]>=0
+   * \param[in] stride the number of elements to skip between the first elements of each block, stride[i] >=1
+   * \param[in] count the number of blocks to read, count[i] >= 1
+   * \param[in] block the dimensions of the block to read, block[i] >= 1
+   *
+   * \returns a new pressio data buffer containing the selected elements, or nullptr on error
+   * \see pressio_data::select for the semantics of the selection
+   * \see pressio_io_read_region for the semantics this function should obey
+   */
+  struct pressio_data* read_region(struct pressio_data* data,
+      std::vector<size_t> const& start,
+      std::vector<size_t> const& stride,
+      std::vector<size_t> const& count,
+      std::vector<size_t> const& block);
+
   /** reads a multiple pressio_data buffers from some persistent storage. Modules should override read_many_impl instead.
    * \param[in,out] data_begin contiguous iterator to the beginning of the data objects.  Pointed to objects are replaced with the read data, freeing the input if required.
    * \param[in,out] data_end contiguous iterator past the end of the data objects. Pointed to objects are replaced with the read data, freeing the output if required.
@@ -140,6 +164,24 @@ struct libpressio_io_plugin: public pressio_configurable, public pressio_version
    */
   virtual int write_impl(struct pressio_data const* data)=0;
 
+  /** reads a subset of a pressio_data buffer from some persistent storage
+   *
+   * the default version reads the entire buffer and then selects the requested subset from it;
+   * modules that can seek in their storage should override it to read only the requested elements.
+   *
+   * \param[in] data data object describing the full dataset, or nullptr to determine it from the file if supported
+   * \param[in] start the position in the array to start reading
+   * \param[in] stride the number of elements to skip between the first elements of each block
+   * \param[in] count the number of blocks to read
+   * \param[in] block the dimensions of the block to read
+   * \see pressio_io_read_region for the semantics this function should obey
+   */
+  virtual pressio_data* read_region_impl(struct pressio_data* data,
+      std::vector<size_t> const& start,
+      std::vector<size_t> const& stride,
+      std::vector<size_t> const& count,
+      std::vector<size_t> const& block);
+
   /** reads multiple pressio_data buffers from some persistent storage
    * \param[in] data data object to populate, or nullptr to allocate it from the file if supported
    * \see pressio_io_read for the semantics this function should obey
@@ -1,4 +1,6 @@
 #include <nlohmann/json_fwd.hpp>
+#include <cstddef>
+#include <string>
 struct pressio_data;
 struct pressio_option;
 struct pressio_options;
@@ -9,3 +11,23 @@ void to_json(nlohmann::json& j, pressio_options const& options);
 void from_json(nlohmann::json const& j, pressio_data& data);
 void from_json(nlohmann::json const& j, pressio_option& option);
 void from_json(nlohmann::json const& j, pressio_options& options);
+
+/**
+ * parses json directly into pressio_options without building a nlohmann::json document;  numeric
+ * arrays are parsed directly into pressio_data buffers.  Accepts the same documents as from_json.
+ *
+ * \param[in] json the json to parse
+ * \param[in] size the length of json in bytes
+ * \returns the parsed options
+ * \throws std::invalid_argument if json is not valid json, std::runtime_error if it can not be represented as options
+ */
+pressio_options options_from_json(const char* json, size_t size);
+
+/**
+ * formats pressio_options as json without building a nlohmann::json document.  Produces the same
+ * structure as to_json.
+ *
+ * \param[in] options the options to format
+ * \returns the formatted json
+ */
+std::string options_to_json(pressio_options const& options);
@@ -146,6 +146,13 @@ class libpressio_metrics_plugin : public pressio_configurable, public pressio_er
    */
   void set_name(std::string const& new_name) override final;
 
+  /** sets a set of options for the metrics module and records that they changed;
+   * override set_options_impl instead
+   * \param[in] options to set for configuration of the metrics module
+   * \see pressio_metrics_set_options for the semantics this function should obey
+   */
+  int set_options(struct pressio_options const& options) override final;
+
   /**
    * \returns a pressio_options structure containing the metrics returned by the provided metrics plugin
    */
@@ -208,6 +215,12 @@ protected:
    */
   virtual int end_set_options_impl(struct pressio_options const& options, int rc);
 
+  /** sets a set of options for the metrics module
+   * \param[in] options to set for configuration of the metrics module
+   * \see pressio_metrics_set_options for the semantics this function should obey
+   */
+  virtual int set_options_impl(struct pressio_options const& options);
+
   /**
    * called at the beginning of compress 
    * \param [in] input the value passed in to compress
@@ -4,10 +4,12 @@
 #include <cwchar>
 #include <string>
 #include <map>
+#include <memory>
 #include <type_traits>
 #include <utility>
 #include <vector>
 #include <initializer_list>
+#include <iterator>
 #include "pressio_options.h"
 #include "pressio_option.h"
 #include "libpressio_ext/cpp/data.h"
@@ -23,6 +25,84 @@
  * \brief C++ pressio_options and pressio_option interfaces
  */
 
+/**
+ * holds an optional pressio_data that is shared between copies of the pressio_option that holds it.
+ *
+ * The buffer is never modified once it is stored; assigning a new value to the option replaces it instead,
+ * so copying options, even ones with large data values, only copies a reference.
+ */
+class pressio_option_shared_data {
+  public:
+  /** constructs an object without a value */
+  pressio_option_shared_data()=default;
+  /** constructs an object without a value */
+  pressio_option_shared_data(compat::nullopt_t) {}
+  /**
+   * \param[in] value the data to copy into shared storage
+   */
+  pressio_option_shared_data(pressio_data const& value): data(std::make_shared<const pressio_data>(value)) {}
+  /**
+   * \param[in] value the data to move into shared storage
+   */
+  pressio_option_shared_data(pressio_data&& value): data(std::make_shared<const pressio_data>(std::move(value))) {}
+  /**
+   * \param[in] value the data to copy into shared storage if it has a value
+   */
+  pressio_option_shared_data(compat::optional<pressio_data> const& value):
+    data(value ? std::make_shared<const pressio_data>(*value) : nullptr) {}
+
+  /** \returns true if the object holds a value */
+  bool has_value() const noexcept { return data != nullptr; }
+  /** \returns true if the object holds a value */
+  explicit operator bool() const noexcept { return has_value(); }
+  /** \returns the held value; unspecified if there is no value */
+  pressio_data const& operator*() const { return *data; }
+  /** \returns the held value; unspecified if there is no value */
+  pressio_data const* operator->() const { return data.get(); }
+  /** \returns the held value; unspecified if there is no value */
+  pressio_data const& value() const { return *data; }
+
+  /**
+   * \param[in] rhs the object to compare to
+   * \returns true if both hold no value or equal values
+   */
+  bool operator==(pressio_option_shared_data const& rhs) const {
+    if(data == rhs.data) return true;
+    if(!data || !rhs.data) return false;
+    return *data == *rhs.data;
+  }
+
+  private:
+  std::shared_ptr<const pressio_data> data;
+};
+
+/**
+ * the type used to store values of type T in a pressio_option
+ */
+template <class T>
+struct pressio_option_storage {
+  /** the storage type */
+  using type = compat::optional<T>;
+};
+
+/**
+ * pressio_data values are shared between copies of an option
+ */
+template <>
+struct pressio_option_storage<pressio_data> {
+  /** the storage type */
+  using type = pressio_option_shared_data;
+};
+
+/**
+ * plugins that hold a pressio_option_shared_data share it with the option rather than copying it
+ */
+template <>
+struct pressio_option_storage<pressio_option_shared_data> {
+  /** the storage type */
+  using type = pressio_option_shared_data;
+};
+
 namespace {
 using option_type = compat::variant<compat::monostate,
       compat::optional<int8_t>,
@@ -38,7 +118,7 @@ using option_type = compat::variant<compat::monostate,
       compat::optional<std::string>,
       compat::optional<void*>,
       compat::optional<std::vector<std::string>>,
-      compat::optional<pressio_data>
+      pressio_option_shared_data
       >;
 
 
@@ -83,7 +163,7 @@ struct pressio_option final {
     !std::is_same<T, const char*>::value &&
     !std::is_same<T, compat::monostate>::value
     >::type>
-  pressio_option(compat::optional<T> const& value): option(value) {}
+  pressio_option(compat::optional<T> const& value): option(typename pressio_option_storage<T>::type(value)) {}
 
   /** constructs an option that holds the specified value
    * \param[in] value the value the option is to hold
@@ -94,7 +174,7 @@ struct pressio_option final {
     !std::is_same<T, const char*>::value &&
     !std::is_same<T, compat::monostate>::value
     >::type>
-  pressio_option(compat::optional<T> && value): option(value) {}
+  pressio_option(compat::optional<T> && value): option(typename pressio_option_storage<T>::type(value)) {}
 
   /** constructs an option that holds the specified value
    * \param[in] value the value the option is to hold
@@ -105,7 +185,12 @@ struct pressio_option final {
     !std::is_same<T, const char*>::value &&
     !std::is_same<T, compat::monostate>::value
     >::type>
-  pressio_option(T const& value): option(compat::optional<T>(value)) {}
+  pressio_option(T const& value): option(typename pressio_option_storage<T>::type(value)) {}
+
+  /** specialization for data to move the buffer into the option rather than copy it
+   * \param[in] value the data to store
+   * */
+  pressio_option(pressio_data&& value): option(pressio_option_shared_data(std::move(value))) {}
 
 
   /** specialization for option to reset the type to hold no type or value
@@ -142,7 +227,7 @@ struct pressio_option final {
    */
   template <class T, typename std::enable_if<!std::is_same<T,compat::monostate>::value,int>::type = 0>
   bool holds_alternative() const {
-    return compat::holds_alternative<compat::optional<T>>(option);
+    return compat::holds_alternative<typename pressio_option_storage<T>::type>(option);
   }
 
   /** Specialization for the compat::monostate singleton
@@ -154,11 +239,12 @@ struct pressio_option final {
   }
 
   /** 
-   * \returns a std::optional which holds a value if the option has one or an empty optional otherwise
+   * \returns a std::optional which holds a value if the option has one or an empty optional otherwise;
+   * for pressio_data a pressio_option_shared_data with the same interface is returned
    */
   template <class T>
-  compat::optional<T> const& get() const{
-    return compat::get<compat::optional<T>>(option);
+  typename pressio_option_storage<T>::type const& get() const{
+    return compat::get<typename pressio_option_storage<T>::type>(option);
   }
 
   /** 
@@ -219,7 +305,7 @@ struct pressio_option final {
    */
   template <class T>
   void set(T v) {
-    option = compat::optional<T>(v);
+    option = typename pressio_option_storage<T>::type(std::move(v));
   }
 
   /**
@@ -272,7 +358,7 @@ struct pressio_option final {
         option = compat::optional<std::vector<std::string>>();
         break;
       case pressio_option_data_type:
-        option = compat::optional<pressio_data>();
+        option = pressio_option_shared_data();
         break;
     }
   }
@@ -304,6 +390,8 @@ struct pressio_option final {
 };
 
 
+struct pressio_options_diff;
+
 /**
  * represents a map of dynamically typed objects
  */
@@ -313,6 +401,26 @@ struct pressio_options final {
   using key_type = std::string;
   /** type of the mapped_type for pressio_options, useful for lua */
   using mapped_type = pressio_option;
+  /** the type of the elements stored in the options */
+  using value_type = std::pair<std::string, pressio_option>;
+
+  private:
+  /*
+   * options are stored as a vector sorted by key so that lookups are a binary search over contiguous
+   * memory and iteration order is deterministic.  Keys are compared as std::string_view so lookups,
+   * including lookups of hierarchical names, do not allocate.
+   */
+  std::vector<value_type> options;
+
+  public:
+  /**
+   * type of the returned iterator
+   */
+  using iterator = typename decltype(options)::iterator;
+  /**
+   * type of the const iterators
+   */
+  using const_iterator = typename decltype(options)::const_iterator;
 
   /** create an empty pressio_options structure */
   pressio_options()=default;
@@ -340,9 +448,16 @@ struct pressio_options final {
   /**
    * create a literal pressio_options structure from a std::initializer_list
    *
-   * \param[in] opts the options to put into the map
+   * \param[in] opts the options to put into the map; if a key appears more than once the first value is used
    */
-  pressio_options(std::initializer_list<std::pair<const std::string, pressio_option>> opts): options(opts) {}
+  pressio_options(std::initializer_list<std::pair<const std::string, pressio_option>> opts): options(opts.begin(), opts.end()) {
+    std::stable_sort(options.begin(), options.end(), [](value_type const& lhs, value_type const& rhs) {
+        return lhs.first < rhs.first;
+    });
+    options.erase(std::unique(options.begin(), options.end(), [](value_type const& lhs, value_type const& rhs) {
+        return lhs.first == rhs.first;
+    }), options.end());
+  }
 
   /**
    * checks the status of a key in a option set
@@ -350,15 +465,8 @@ struct pressio_options final {
    *          pressio_options_key_exists if the key exists but has no value
    *          pressio_options_key_set if the key exists and is set
    */
-  pressio_options_key_status key_status(std::string const& key) const {
-    auto it = options.find(key);
-    if(it == options.end()) {
-      return pressio_options_key_does_not_exist;
-    } else if (it->second.has_value()) {
-      return pressio_options_key_set;
-    } else { 
-      return pressio_options_key_exists;
-    }
+  pressio_options_key_status key_status(compat::string_view const& key) const {
+    return status_of(find_name({}, key));
   }
 
   /**
@@ -368,8 +476,18 @@ struct pressio_options final {
    *          pressio_options_key_set if the key exists and is set
    */
   template <class StringType>
-  pressio_options_key_status key_status(StringType const& name, std::string const& key) const {
-    return key_status(format_name(name, key));
+  pressio_options_key_status key_status(StringType const& name, compat::string_view const& key) const {
+    return status_of(find_name(name, key));
+  }
+
+  /**
+   * \param[in] name the name to use
+   * \param[in] key the key to find
+   * \returns an iterator to the most specific option for key in the search order of name, or end() if there is none
+   * \see search for the search order
+   */
+  const_iterator lookup(compat::string_view const& name, compat::string_view const& key) const {
+    return search_name(name, key);
   }
 
   /**
@@ -379,7 +497,7 @@ struct pressio_options final {
    */
   template <class StringType>
   void set(StringType&& key,  pressio_option const& value) {
-    options[std::forward<StringType>(key)] = value;
+    find_or_insert({}, std::forward<StringType>(key))->second = value;
   }
 
   /**
@@ -390,7 +508,7 @@ struct pressio_options final {
    */
   template <class StringType, class StringType2>
   void set(StringType const& name, StringType2 const& key,  pressio_option const& value) {
-    set(format_name(name, key), value);
+    find_or_insert(name, key)->second = value;
   }
 
 
@@ -402,15 +520,7 @@ struct pressio_options final {
    */
   template <class StringType>
   enum pressio_options_key_status cast_set(StringType && key,  pressio_option const& value, enum pressio_conversion_safety safety= pressio_conversion_implicit) {
-    switch(key_status(key))
-    {
-      case pressio_options_key_set:
-      case pressio_options_key_exists:
-        return options[std::forward<StringType>(key)].cast_set(value, safety);
-      default:
-        return pressio_options_key_does_not_exist;
-    }
-
+    return cast_set_at(find_name({}, key), value, safety);
   }
 
   /**
@@ -422,7 +532,7 @@ struct pressio_options final {
    */
   template <class StringType, class StringType2>
   enum pressio_options_key_status cast_set(StringType const& name, StringType2 const& key,  pressio_option const& value, enum pressio_conversion_safety safety= pressio_conversion_implicit) {
-    return cast_set(format_name(name, key), value, safety);
+    return cast_set_at(find_name(name, key), value, safety);
   }
 
   /**
@@ -432,7 +542,7 @@ struct pressio_options final {
    */
   template <class StringType>
   void set_type(StringType && key, pressio_option_type type) {
-    options[std::forward<StringType>(key)].set_type(type);
+    find_or_insert({}, std::forward<StringType>(key))->second.set_type(type);
   }
 
   /**
@@ -443,7 +553,7 @@ struct pressio_options final {
    */
   template <class StringType, class StringType2>
   void set_type(StringType const& name, StringType2 const& key, pressio_option_type type) {
-    set_type(format_name(name, key), type);
+    find_or_insert(name, key)->second.set_type(type);
   }
 
   /**
@@ -452,7 +562,7 @@ struct pressio_options final {
    */
   template<class StringType>
   pressio_option const& get(StringType const& key) const {
-    return options.find(key)->second;
+    return find_name({}, key)->second;
   }
 
   /**
@@ -462,14 +572,7 @@ struct pressio_options final {
    */
   template <class StringType, class StringType2>
   pressio_option const& get(compat::string_view const& name, StringType2 const& key) const {
-    std::string prefix_key;
-    for (auto path : search(name)) {
-      prefix_key = format_name(path, key);
-      if(options.find(prefix_key) != options.end()) {
-        return get(prefix_key);
-      }
-    }
-    return get(key);
+    return search_name(name, key)->second;
   }
 
   /**
@@ -482,22 +585,7 @@ struct pressio_options final {
    */
   template <class PointerType, class StringType>
   enum pressio_options_key_status get(StringType const& key, compat::optional<PointerType>* value) const {
-    switch(key_status(key)){
-      case pressio_options_key_set:
-        {
-          auto variant = get(key);
-          if (variant.template holds_alternative<PointerType>()) { 
-            *value = variant.template get<PointerType>();
-            return pressio_options_key_set;
-          } else {
-            return pressio_options_key_exists;
-          }
-        }
-        break;
-      default:
-        //value does not exist
-        return pressio_options_key_does_not_exist;
-    }
+    return get_at(find_name({}, key), value);
   }
 
   /**
@@ -510,23 +598,7 @@ struct pressio_options final {
    */
   template <class PointerType, class StringType>
   enum pressio_options_key_status get(StringType const& key, PointerType value) const {
-    using ValueType = typename std::remove_pointer<PointerType>::type;
-    switch(key_status(key)){
-      case pressio_options_key_set:
-        {
-          auto variant = get(key);
-          if (variant.template holds_alternative<ValueType>()) { 
-            *value = variant.template get_value<ValueType>();
-            return pressio_options_key_set;
-          } else {
-            return pressio_options_key_exists;
-          }
-        }
-        break;
-      default:
-        //value does not exist
-        return pressio_options_key_does_not_exist;
-    }
+    return get_at(find_name({}, key), value);
   }
 
   /**
@@ -540,14 +612,7 @@ struct pressio_options final {
    */
   template <class PointerType, class StringType, class StringType2>
   enum pressio_options_key_status get(StringType const& name, StringType2 const& key, PointerType value) const {
-    std::string prefix_key;
-    for (auto path : search(name)) {
-      prefix_key = format_name(std::string(path), key);
-      if(options.find(prefix_key) != options.end()) {
-        return get(prefix_key, value);
-      }
-    }
-    return get(key, value);
+    return get_at(search_name(name, key), value);
   }
 
   /**
@@ -561,24 +626,7 @@ struct pressio_options final {
    */
   template <class PointerType, class StringType>
   enum pressio_options_key_status cast(StringType const& key, PointerType value, enum pressio_conversion_safety safety) const {
-    using ValueType = typename std::remove_pointer<PointerType>::type;
-    switch(key_status(key)){
-      case pressio_options_key_set:
-        {
-          auto variant = get(key);
-          auto converted = pressio_option(variant).as(pressio_type_to_enum<ValueType>(), safety);
-          if(converted.has_value()) {
-            *value = converted.template get_value<ValueType>();
-            return pressio_options_key_set;
-          } else {
-            return pressio_options_key_exists;
-          }
-        }
-        break;
-      default:
-        //value does not exist
-        return pressio_options_key_does_not_exist;
-    }
+    return cast_at(find_name({}, key), value, safety);
   }
 
   /**
@@ -593,14 +641,7 @@ struct pressio_options final {
    */
   template <class PointerType, class StringType, class StringType2>
   enum pressio_options_key_status cast(StringType const& name, StringType2 const& key, PointerType value, enum pressio_conversion_safety safety) const {
-    std::string prefix_key;
-    for (auto path : search(name)) {
-      prefix_key = format_name(path, key);
-      if(options.find(prefix_key) != options.end()) {
-        return cast(prefix_key, value, safety);
-      }
-    }
-    return cast(key, value, safety);
+    return cast_at(search_name(name, key), value, safety);
   }
 
   /**
@@ -608,6 +649,30 @@ struct pressio_options final {
    */
   static std::vector<compat::string_view> search(compat::string_view const& value);
 
+  /**
+   * calls f with each name in the search order for a given string until f returns true
+   *
+   * \param[in] value the name to search
+   * \param[in] f the function to call
+   * \returns true if f returned true
+   * \see search for the order in which the names are visited
+   */
+  template <class Function>
+  static bool search_each(compat::string_view value, Function&& f) {
+    //normalize the string
+    if(!value.empty() && value.front() == '/') value.remove_prefix(1);
+    if(!value.empty() && value.back() == '/') value.remove_suffix(1);
+
+    if(!value.empty()) {
+      auto len = compat::string_view::npos;
+      do {
+        if(f(value.substr(0, len))) return true;
+        len = (len == 0) ? compat::string_view::npos : value.rfind('/', len - 1);
+      } while(len != compat::string_view::npos);
+    }
+    return f(compat::string_view());
+  }
+
   /**
    * removes all options
    */
@@ -616,42 +681,61 @@ struct pressio_options final {
   }
 
   /**
-   * copies all of the options from o
+   * copies all of the options from o that are not already present
    * \param[in] o the options to copy from
    */
   void copy_from(pressio_options const& o) {
-    insert(o.begin(), o.end());
-  }
-
-  private:
-
-  std::string format_name(std::string const& name, std::string const& key) const {
-    if(name == "") return key;
-    else return '/' + name + ':' + key;
+    if(o.options.empty()) return;
+    if(options.empty()) {
+      options = o.options;
+      return;
+    }
+    //both are sorted, so merge them in linear time; existing values win
+    std::vector<value_type> merged;
+    merged.reserve(options.size() + o.options.size());
+    auto lhs = options.begin();
+    auto rhs = o.options.begin();
+    while(lhs != options.end() && rhs != o.options.end()) {
+      int cmp = lhs->first.compare(rhs->first);
+      if(cmp < 0) merged.emplace_back(std::move(*lhs++));
+      else if(cmp > 0) merged.emplace_back(*rhs++);
+      else {
+        merged.emplace_back(std::move(*lhs++));
+        ++rhs;
+      }
+    }
+    std::move(lhs, options.end(), std::back_inserter(merged));
+    std::copy(rhs, o.options.end(), std::back_inserter(merged));
+    options = std::move(merged);
   }
 
-  std::map<std::string, pressio_option, compat::less<>> options;
-
-
-  public:
   /**
-   * type of the returned iterator
+   * computes the changes that turn this set of options into updated in linear time
+   * \param[in] updated the options to compare against
+   * \returns the entries of updated that are new or have different values, and the keys that are not in updated
    */
-  using iterator = typename decltype(options)::iterator;
+  pressio_options_diff diff(pressio_options const& updated) const;
+
   /**
-   * type of the const iterators
+   * applies changes computed by diff; afterwards a.diff(b) applied to a makes a equal to b
+   * \param[in] changes the changes to apply
    */
-  using const_iterator = typename decltype(options)::const_iterator;
+  void patch(pressio_options_diff const& changes);
+
   /**
-   * the map's value_type
+   * function to insert new values into the map; existing values are not replaced
+   * \returns an iterator to the element with the key
    */
-  using value_type = typename decltype(options)::value_type;
+  iterator insert(const_iterator, value_type const& value) {
+    return insert(value).first;
+  }
 
   /**
-   * function to insert new values into the map
+   * function to insert new values into the map; existing values are not replaced
+   * \returns an iterator to the element with the key
    */
-  iterator insert(const_iterator it, value_type const& value) {
-    return options.insert(it, value);
+  iterator insert(const_iterator, value_type&& value) {
+    return insert(std::move(value)).first;
   }
 
   /**
@@ -662,7 +746,9 @@ struct pressio_options final {
    */
   template <class InputIt>
   void insert(InputIt begin, InputIt end){
-    options.insert(begin, end);
+    for (; begin != end; ++begin) {
+      insert(value_type(*begin));
+    }
   }
 
 
@@ -703,8 +789,29 @@ struct pressio_options final {
    * \param[in] key the key to search for
    * \returns an iterator to the found key
    */
-  iterator find(key_type const& key) {
-    return options.find(key);
+  iterator find(compat::string_view const& key) {
+    auto it = lower_bound({}, key);
+    if(it != options.end() && it->first == key) return it;
+    return options.end();
+  }
+
+  /**
+   * find an element of the container.  if it is not found, return end().
+   * \param[in] key the key to search for
+   * \returns an iterator to the found key
+   */
+  const_iterator find(compat::string_view const& key) const {
+    return find_name({}, key);
+  }
+
+  /**
+   * find the element with exactly the given name and key.  if it is not found, return end().
+   * \param[in] name the name of the key
+   * \param[in] key the key to search for
+   * \returns an iterator to the found key
+   */
+  const_iterator find(compat::string_view const& name, compat::string_view const& key) const {
+    return find_name(name, key);
   }
 
   /**
@@ -712,17 +819,31 @@ struct pressio_options final {
    * \param[in] key the key to search for
    * \returns the number of elements erased
    */
-  size_t erase(key_type const& key) {
-    return options.erase(key);
+  size_t erase(compat::string_view const& key) {
+    auto it = find(key);
+    if(it == options.end()) return 0;
+    options.erase(it);
+    return 1;
   }
 
   /**
-   * insert a new key-value pair into the options, useful for lua
+   * insert a new key-value pair into the options if the key is not already present, useful for lua
    * \param[in] value the value to insert
-   * \returns the number of elements erased
+   * \returns an iterator to the element with the key and true if the value was inserted
+   */
+  std::pair<iterator, bool> insert(value_type const& value) {
+    return insert(value_type(value));
+  }
+
+  /**
+   * insert a new key-value pair into the options if the key is not already present
+   * \param[in] value the value to insert
+   * \returns an iterator to the element with the key and true if the value was inserted
    */
-  auto insert(value_type const& value) -> decltype(options.insert(value)) {
-    return options.insert(value);
+  std::pair<iterator, bool> insert(value_type&& value) {
+    auto it = lower_bound({}, value.first);
+    if(it != options.end() && it->first == value.first) return {it, false};
+    return {options.emplace(it, std::move(value)), true};
   }
 
   /** 
@@ -734,11 +855,202 @@ struct pressio_options final {
 
   /**\returns the number of set options*/
   size_t num_set() const {
-    return std::count_if(std::begin(options), std::end(options), [](decltype(options)::value_type const& key_option){
+    return std::count_if(std::begin(options), std::end(options), [](value_type const& key_option){
           return key_option.second.has_value();
         });
   }
+
+  private:
+
+  /**
+   * compares a stored key to the key that format_name(name, key) would produce without building it
+   */
+  static int compare_name(compat::string_view stored, compat::string_view name, compat::string_view key) {
+    if(name.empty()) return stored.compare(key);
+    const compat::string_view pieces[] = {"/", name, ":", key};
+    for (auto const& piece : pieces) {
+      const size_t n = std::min(stored.size(), piece.size());
+      const int cmp = stored.substr(0, n).compare(piece.substr(0, n));
+      if(cmp != 0) return cmp;
+      if(n < piece.size()) return -1;
+      stored.remove_prefix(n);
+    }
+    return (stored.empty()) ? 0 : 1;
+  }
+
+  std::string format_name(compat::string_view const& name, compat::string_view const& key) const {
+    std::string formatted;
+    if(name.empty()) {
+      formatted.assign(key.data(), key.size());
+    } else {
+      formatted.reserve(name.size() + key.size() + 2);
+      formatted.push_back('/');
+      formatted.append(name.data(), name.size());
+      formatted.push_back(':');
+      formatted.append(key.data(), key.size());
+    }
+    return formatted;
+  }
+
+  iterator lower_bound(compat::string_view const& name, compat::string_view const& key) {
+    return std::lower_bound(options.begin(), options.end(), 0, [&](value_type const& stored, int) {
+        return compare_name(stored.first, name, key) < 0;
+    });
+  }
+  const_iterator lower_bound(compat::string_view const& name, compat::string_view const& key) const {
+    return std::lower_bound(options.begin(), options.end(), 0, [&](value_type const& stored, int) {
+        return compare_name(stored.first, name, key) < 0;
+    });
+  }
+
+  const_iterator find_name(compat::string_view const& name, compat::string_view const& key) const {
+    auto it = lower_bound(name, key);
+    if(it != options.end() && compare_name(it->first, name, key) == 0) return it;
+    return options.end();
+  }
+  iterator find_name(compat::string_view const& name, compat::string_view const& key) {
+    auto it = lower_bound(name, key);
+    if(it != options.end() && compare_name(it->first, name, key) == 0) return it;
+    return options.end();
+  }
+
+  /**
+   * finds the most specific option for key in the search order of name
+   */
+  const_iterator search_name(compat::string_view const& name, compat::string_view const& key) const {
+    const_iterator found = options.end();
+    search_each(name, [&](compat::string_view const& path) {
+        found = find_name(path, key);
+        return found != options.end();
+    });
+    return found;
+  }
+
+  iterator find_or_insert(compat::string_view const& name, compat::string_view const& key) {
+    auto it = lower_bound(name, key);
+    if(it != options.end() && compare_name(it->first, name, key) == 0) return it;
+    return options.emplace(it, format_name(name, key), pressio_option());
+  }
+
+  pressio_options_key_status status_of(const_iterator it) const {
+    if(it == options.end()) {
+      return pressio_options_key_does_not_exist;
+    } else if (it->second.has_value()) {
+      return pressio_options_key_set;
+    } else { 
+      return pressio_options_key_exists;
+    }
+  }
+
+  enum pressio_options_key_status cast_set_at(const_iterator it, pressio_option const& value, enum pressio_conversion_safety safety) {
+    if(it == options.end()) return pressio_options_key_does_not_exist;
+    return options[it - options.cbegin()].second.cast_set(value, safety);
+  }
+
+  template <class PointerType>
+  enum pressio_options_key_status get_at(const_iterator it, compat::optional<PointerType>* value) const {
+    if(status_of(it) != pressio_options_key_set) return pressio_options_key_does_not_exist;
+    auto const& variant = it->second;
+    if (variant.template holds_alternative<PointerType>()) { 
+      *value = variant.template get_value<PointerType>();
+      return pressio_options_key_set;
+    } else {
+      return pressio_options_key_exists;
+    }
+  }
+
+  enum pressio_options_key_status get_at(const_iterator it, pressio_option_shared_data* value) const {
+    if(status_of(it) != pressio_options_key_set) return pressio_options_key_does_not_exist;
+    auto const& variant = it->second;
+    if (variant.template holds_alternative<pressio_data>()) { 
+      *value = variant.template get<pressio_data>();
+      return pressio_options_key_set;
+    } else {
+      return pressio_options_key_exists;
+    }
+  }
+
+  template <class PointerType>
+  enum pressio_options_key_status get_at(const_iterator it, PointerType value) const {
+    using ValueType = typename std::remove_pointer<PointerType>::type;
+    if(status_of(it) != pressio_options_key_set) return pressio_options_key_does_not_exist;
+    auto const& variant = it->second;
+    if (variant.template holds_alternative<ValueType>()) { 
+      *value = variant.template get_value<ValueType>();
+      return pressio_options_key_set;
+    } else {
+      return pressio_options_key_exists;
+    }
+  }
+
+  template <class PointerType>
+  enum pressio_options_key_status cast_at(const_iterator it, PointerType value, enum pressio_conversion_safety safety) const {
+    using ValueType = typename std::remove_pointer<PointerType>::type;
+    if(status_of(it) != pressio_options_key_set) return pressio_options_key_does_not_exist;
+    auto converted = it->second.as(pressio_type_to_enum<ValueType>(), safety);
+    if(converted.has_value()) {
+      *value = converted.template get_value<ValueType>();
+      return pressio_options_key_set;
+    } else {
+      return pressio_options_key_exists;
+    }
+  }
+};
+
+
+/**
+ * the changes between two pressio_options
+ * \see pressio_options::diff
+ * \see pressio_options::patch
+ */
+struct pressio_options_diff {
+  /** entries that were added or whose values changed, with their new values */
+  pressio_options changed;
+  /** keys that were removed, in sorted order */
+  std::vector<std::string> removed;
+
+  /** \returns true if there are no changes */
+  bool empty() const {
+    return changed.size() == 0 && removed.empty();
+  }
 };
 
+inline pressio_options_diff pressio_options::diff(pressio_options const& updated) const {
+  pressio_options_diff changes;
+  auto lhs = options.begin();
+  auto rhs = updated.options.begin();
+  while(lhs != options.end() || rhs != updated.options.end()) {
+    const int cmp = (lhs == options.end()) ? 1 : (rhs == updated.options.end()) ? -1 : lhs->first.compare(rhs->first);
+    if(cmp < 0) {
+      changes.removed.emplace_back((lhs++)->first);
+    } else if(cmp > 0) {
+      changes.changed.options.emplace_back(*rhs++);
+    } else {
+      if(!(lhs->second == rhs->second)) changes.changed.options.emplace_back(*rhs);
+      ++lhs;
+      ++rhs;
+    }
+  }
+  return changes;
+}
+
+inline void pressio_options::patch(pressio_options_diff const& changes) {
+  std::vector<value_type> merged;
+  merged.reserve(options.size() + changes.changed.options.size());
+  auto removed = changes.removed.begin();
+  auto rhs = changes.changed.options.begin();
+  for (auto& entry : options) {
+    while(rhs != changes.changed.options.end() && rhs->first < entry.first) merged.emplace_back(*rhs++);
+    while(removed != changes.removed.end() && *removed < entry.first) ++removed;
+    if(rhs != changes.changed.options.end() && rhs->first == entry.first) {
+      merged.emplace_back(*rhs++);
+    } else if(removed == changes.removed.end() || *removed != entry.first) {
+      merged.emplace_back(std::move(entry));
+    }
+  }
+  std::copy(rhs, changes.changed.options.end(), std::back_inserter(merged));
+  options = std::move(merged);
+}
+
 
 #endif
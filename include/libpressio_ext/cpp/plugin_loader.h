@@ -0,0 +1,91 @@
+#ifndef LIBPRESSIO_PLUGIN_LOADER_H
+#define LIBPRESSIO_PLUGIN_LOADER_H
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * \file
+ * \brief C++ interface to load plugins from shared objects
+ *
+ * A plugin module is a shared object that registers plugins from static pressio_register objects, just
+ * as plugins built into libpressio do.  Modules named libpressio_plugin_\<name\>.so found on the search
+ * path are loaded the first time a plugin called \<name\> is looked up in any registry, so neither the
+ * module nor the libraries it depends on are loaded or initialized by jobs that do not use it.  Other
+ * modules can be loaded explicitly with load.
+ */
+
+/**
+ * information about a discovered or loaded plugin module
+ */
+struct pressio_plugin_module {
+  /** the path to the shared object */
+  std::string path;
+  /** the name of the plugin the module is loaded for, derived from its file name */
+  std::string name;
+  /** true if the module was loaded */
+  bool loaded = false;
+  /** the time to load the module and run its static initializers in seconds */
+  double load_seconds = 0;
+  /** the plugins the module registered as "registry:name", for example "compressor:zfp" */
+  std::vector<std::string> provides;
+  /** the error from loading the module, if any */
+  std::string error;
+};
+
+/**
+ * discovers and loads plugin modules.  All functions are thread safe.
+ */
+class pressio_plugin_loader {
+  public:
+  /**
+   * \returns the directories searched for modules.  By default, the colon separated directories in the
+   * LIBPRESSIO_PLUGIN_PATH environment variable
+   */
+  std::vector<std::string> search_path() const;
+
+  /**
+   * sets the directories searched for modules and discards modules discovered but not yet loaded
+   * \param[in] directories the directories to search
+   */
+  void set_search_path(std::vector<std::string> const& directories);
+
+  /**
+   * loads a module unless it has already been loaded
+   *
+   * \param[in] path the path to the shared object
+   * \param[out] error_msg if non-null, set to the error if the module could not be loaded
+   * \returns 0 on success, non-zero on failure
+   */
+  int load(std::string const& path, std::string* error_msg = nullptr);
+
+  /**
+   * loads the module discovered on the search path for the plugin called name, if any
+   * \param[in] name the name of the plugin
+   * \returns true if a module was loaded
+   */
+  bool load_for(std::string const& name);
+
+  /**
+   * \returns the modules discovered on the search path or loaded explicitly
+   */
+  std::vector<pressio_plugin_module> modules() const;
+
+  private:
+  void scan();
+
+  mutable std::recursive_mutex lock;
+  bool scanned = false;
+  bool has_search_path = false;
+  std::vector<std::string> directories;
+  std::map<std::string, pressio_plugin_module> by_path;
+  std::map<std::string, std::string> path_for_name;
+};
+
+/**
+ * \returns the plugin loader used by the registries in libpressio
+ */
+pressio_plugin_loader& plugin_loader();
+
+#endif /* end of include guard: LIBPRESSIO_PLUGIN_LOADER_H */
@@ -4,19 +4,79 @@
  */
 #ifndef LIBPRESSIO_PRESSIO_IMPL_H
 #define LIBPRESSIO_PRESSIO_IMPL_H
+#include <atomic>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <functional>
+#include <iterator>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include "compressor.h"
 #include "metrics.h"
 #include "io.h"
+#include "startup.h"
 #include "std_compat/language.h"
 
 /**
  * a type that registers constructor functions
+ *
+ * Registrations are collected into an immutable, hash-indexed snapshot which is published the first
+ * time the registry is read.  Lookups only load the current snapshot, so any number of threads may call
+ * build, find, and contains concurrently with each other and with registrations.  A registration after
+ * the first lookup publishes a new snapshot; earlier snapshots are retained for the lifetime of the
+ * registry so iterators into them remain valid.
  */
 template <class T>
 struct pressio_registry {
+  /** the type of the factory functions */
+  using factory_type = std::function<T()>;
+
+  /**
+   * an immutable view of the registered factories
+   */
+  class snapshot {
+    public:
+    /** the sorted map type used for iteration */
+    using map_type = std::map<std::string, factory_type>;
+
+    /**
+     * \param[in] factories the factories to index
+     */
+    explicit snapshot(map_type factories): factories(std::move(factories)) {
+      index.reserve(this->factories.size());
+      for (auto it = this->factories.cbegin(); it != this->factories.cend(); ++it) {
+        index.emplace(it->first, it);
+      }
+    }
+
+    /**
+     * \param[in] key the key to search for
+     * \returns an iterator to the entry if it is found; else end()
+     */
+    typename map_type::const_iterator find(std::string const& key) const {
+      auto it = index.find(key);
+      return (it == index.end()) ? factories.end() : it->second;
+    }
+    /** \returns a begin iterator over the registered factories in sorted order */
+    typename map_type::const_iterator begin() const { return factories.begin(); }
+    /** \returns an end iterator over the registered factories */
+    typename map_type::const_iterator end() const { return factories.end(); }
+    /** \returns the number of registered factories */
+    size_t size() const { return factories.size(); }
+
+    private:
+    friend struct pressio_registry;
+    map_type factories;
+    std::unordered_map<std::string, typename map_type::const_iterator> index;
+  };
+
+  pressio_registry()=default;
+  pressio_registry(pressio_registry const&)=delete;
+  pressio_registry& operator=(pressio_registry const&)=delete;
+
   /**
    * construct a element of the registered type
    *
@@ -24,9 +84,9 @@ struct pressio_registry {
    * \returns the result of the factory function
    */
   T build(std::string const& name) const {
-    auto factory = factories.find(name);
-    if ( factory != factories.end()) {
-      return factory->second();
+    auto factory = lookup(name);
+    if ( factory.second != factory.first->end()) {
+      return factory.second->second();
     } else {
       return nullptr;
     }
@@ -40,11 +100,154 @@ struct pressio_registry {
    */
   template <class Name, class Factory>
   void regsiter_factory(Name&& name, Factory&& factory) {
-    factories.emplace(std::forward<Name>(name), std::forward<Factory>(factory));
+    std::lock_guard<std::mutex> guard(lock);
+    pending.emplace(std::forward<Name>(name), std::forward<Factory>(factory));
+    if(published.load(std::memory_order_relaxed) != nullptr) publish();
+  }
+
+  /**
+   * iterates over one snapshot of the registered factories.  The end iterator returned from end()
+   * matches the end of whichever snapshot an iterator refers to, so begin() and end() remain
+   * consistent even if a registration publishes a new snapshot between the two calls.
+   */
+  class const_iterator {
+    public:
+    /** the iterator category */
+    using iterator_category = std::forward_iterator_tag;
+    /** the type iterated over */
+    using value_type = typename snapshot::map_type::value_type;
+    /** the difference type */
+    using difference_type = std::ptrdiff_t;
+    /** the pointer type */
+    using pointer = value_type const*;
+    /** the reference type */
+    using reference = value_type const&;
+
+    /** constructs an end iterator */
+    const_iterator()=default;
+    /**
+     * \param[in] factories the snapshot to iterate over
+     * \param[in] it the position in the snapshot
+     */
+    const_iterator(snapshot const* factories, typename snapshot::map_type::const_iterator it):
+      factories(factories), it(it) {}
+
+    /** \returns the current entry */
+    reference operator*() const { return *it; }
+    /** \returns the current entry */
+    pointer operator->() const { return &*it; }
+    /** advances to the next entry */
+    const_iterator& operator++() { ++it; return *this; }
+    /** advances to the next entry */
+    const_iterator operator++(int) { const_iterator tmp = *this; ++it; return tmp; }
+    /**
+     * \param[in] rhs the iterator to compare to
+     * \returns true if both iterators are at an end, or at the same entry of the same snapshot
+     */
+    bool operator==(const_iterator const& rhs) const {
+      if(at_end() || rhs.at_end()) return at_end() && rhs.at_end();
+      return factories == rhs.factories && it == rhs.it;
+    }
+    /**
+     * \param[in] rhs the iterator to compare to
+     * \returns the negation of operator==
+     */
+    bool operator!=(const_iterator const& rhs) const { return !(*this == rhs); }
+
+    private:
+    bool at_end() const { return factories == nullptr || it == factories->end(); }
+    snapshot const* factories = nullptr;
+    typename snapshot::map_type::const_iterator it;
+  };
+
+  /**
+   * builds the plugin registered at name once and makes later calls to build return clones of
+   * it rather than calling its factory function.  This avoids repeating expensive initialization
+   * done in the constructor.  The prototype is only ever cloned, so concurrent builds are safe
+   * as long as the clone function of the plugin does not modify the plugin being cloned.
+   *
+   * \param[in] name the name of the plugin to build from a prototype
+   * \returns true if a prototype was built; false if name is not registered, its factory failed, or
+   * the clone function of the plugin returns a type that cannot be converted to T, as for io plugins
+   * whose clone returns a shared_ptr while the registry holds a unique_ptr
+   */
+  bool use_prototype(std::string const& name) {
+    using clone_type = decltype(std::declval<typename T::element_type&>().clone());
+    return use_prototype(name, std::is_constructible<T, clone_type>{});
+  }
+
+  /**
+   * sets a function that is called when a name that is not registered is looked up.  It may register
+   * the name, for example by loading a plugin module, and returns true if the lookup should be retried.
+   * It is called without any locks held.
+   *
+   * \param[in] fallback the function to call
+   */
+  void set_fallback(std::function<bool(std::string const&)> fallback) {
+    std::lock_guard<std::mutex> guard(lock);
+    this->fallback = std::move(fallback);
+  }
+
+  /**
+   * publishes the registrations made so far.  Lookups do this on first use, so calling it is only
+   * needed to control when the cost is paid.
+   */
+  void freeze() const {
+    current();
+  }
+
+  /**
+   * \returns the current snapshot of the registered factories
+   */
+  snapshot const& current() const {
+    auto factories = published.load(std::memory_order_acquire);
+    if(factories == nullptr) {
+      std::lock_guard<std::mutex> guard(lock);
+      factories = published.load(std::memory_order_relaxed);
+      if(factories == nullptr) factories = publish();
+    }
+    return *factories;
   }
 
   private:
-  std::map<std::string, std::function<T()>> factories;
+  bool use_prototype(std::string const&, std::false_type) {
+    return false;
+  }
+
+  bool use_prototype(std::string const& name, std::true_type) {
+    factory_type make;
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      auto factory = pending.find(name);
+      if(factory == pending.end()) return false;
+      make = factory->second;
+    }
+
+    //the factory is called without the lock because meta-plugins build their children from this registry
+    std::shared_ptr<typename T::element_type> prototype(make());
+    if(!prototype) return false;
+
+    std::lock_guard<std::mutex> guard(lock);
+    auto factory = pending.find(name);
+    if(factory == pending.end()) return false;
+    factory->second = [prototype]() -> T { return T(prototype->clone()); };
+    publish();
+    return true;
+  }
+
+  /** requires lock to be held */
+  snapshot const* publish() const {
+    retained.emplace_back(new snapshot(pending));
+    snapshot const* factories = retained.back().get();
+    published.store(factories, std::memory_order_release);
+    return factories;
+  }
+
+  mutable std::mutex lock;
+  std::function<bool(std::string const&)> fallback;
+  typename snapshot::map_type pending;
+  mutable std::vector<std::unique_ptr<const snapshot>> retained;
+  mutable std::atomic<const snapshot*> published{nullptr};
 
   public:
   /** the value type the registry constructs*/
@@ -54,13 +257,16 @@ struct pressio_registry {
   /** the const reference type the registry constructs*/
   using const_reference = T const;
   /**
-   * \returns an begin iterator over the registered types
+   * \returns an begin iterator over the registered types in the current snapshot
    */
-  auto begin() const -> decltype(factories.begin()) { return std::begin(factories); }
+  const_iterator begin() const {
+    snapshot const& factories = current();
+    return const_iterator(&factories, factories.begin());
+  }
   /**
-   * \returns an end iterator over the registered types
+   * \returns an end iterator over the registered types, which matches the end of any snapshot
    */
-  auto end() const -> decltype(factories.end()) { return std::end(factories); }
+  const_iterator end() const { return const_iterator(); }
 
   /**
    * checks if the name is registered
@@ -69,7 +275,8 @@ struct pressio_registry {
    * \returns true if present
    */
   bool contains(std::string const& key) const {
-    return factories.find(key) != factories.end();
+    auto factory = lookup(key);
+    return factory.second != factory.first->end();
   }
 
   /**
@@ -78,18 +285,30 @@ struct pressio_registry {
    * \param[in] key the key to search for
    * \returns an iterator if the entry is found; else end()
    */
-  auto find(std::string const& key) const -> decltype(factories.find(key)) {
-    return factories.find(key);
+  const_iterator find(std::string const& key) const {
+    auto found = lookup(key);
+    return const_iterator(found.first, found.second);
   }
 
+  private:
   /**
-   * checks if the name is registered
-   *
-   * \param[in] key the key to search for
-   * \returns an iterator if the entry is found; else end()
+   * \returns the snapshot searched and the result of the search, consulting the fallback on a miss
    */
-  auto find(std::string const& key) -> decltype(factories.find(key)) {
-    return factories.find(key);
+  std::pair<snapshot const*, typename snapshot::map_type::const_iterator> lookup(std::string const& key) const {
+    snapshot const* factories = &current();
+    auto it = factories->find(key);
+    if(it != factories->end()) return {factories, it};
+
+    std::function<bool(std::string const&)> on_missing;
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      on_missing = fallback;
+    }
+    if(on_missing && on_missing(key)) {
+      factories = &current();
+      it = factories->find(key);
+    }
+    return {factories, it};
   }
 
 };
@@ -109,6 +328,7 @@ class pressio_register{
    */
   template <class RegistryType, class NameType, class Factory>
   pressio_register(pressio_registry<RegistryType>& registry, NameType&& name, Factory&& factory) {
+    pressio_startup_timer timer(std::string("register:") + name);
     registry.regsiter_factory(name, factory);
   }
 };
@@ -0,0 +1,53 @@
+#ifndef LIBPRESSIO_STARTUP_H
+#define LIBPRESSIO_STARTUP_H
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * \file
+ * \brief C++ interface to record the cost of static registrations and library initialization
+ *
+ * The wall time of every event is always recorded.  Reading the resident set size costs a system call,
+ * so memory is only recorded when the LIBPRESSIO_PROFILE_STARTUP environment variable is set; otherwise
+ * the memory of each event is reported as 0.
+ */
+
+/**
+ * the cost of one registration or library initialization
+ */
+struct pressio_startup_event {
+  /** what was done, for example "register:sz" or "init:SZ_Init" */
+  std::string name;
+  /** the wall time spent in seconds */
+  double seconds;
+  /** the change in the resident set size in bytes */
+  int64_t rss_bytes;
+};
+
+/**
+ * records the time and memory between its construction and destruction as a startup event
+ */
+class pressio_startup_timer {
+  public:
+  /**
+   * \param[in] name the name of the event
+   */
+  explicit pressio_startup_timer(std::string name);
+  ~pressio_startup_timer();
+  pressio_startup_timer(pressio_startup_timer const&)=delete;
+  pressio_startup_timer& operator=(pressio_startup_timer const&)=delete;
+
+  private:
+  std::string name;
+  int64_t rss_begin;
+  std::chrono::steady_clock::time_point begin;
+};
+
+/**
+ * \returns the startup events recorded so far in the order they finished
+ */
+std::vector<pressio_startup_event> pressio_startup_events();
+
+#endif /* end of include guard: LIBPRESSIO_STARTUP_H */
@@ -86,6 +86,34 @@ int pressio_io_check_options(struct pressio_io* io, struct pressio_options const
  */
 struct pressio_data* pressio_io_read(struct pressio_io* io, struct pressio_data* data);
 
+/** reads a subset of a pressio_data buffer from some persistent storage
+ *
+ * The result is equivalent to pressio_data_select(pressio_io_read(io, data), start, stride, count, block)
+ * but io modules which support it read only the selected elements from storage.
+ *
+ * \param[in] io the object to preform the read
+ * \param[in] data data object describing the type and dimensions of the full dataset, or nullptr to determine them from the file if supported by the plugin.
+ *  Data passed to this call should be considered "moved" in a c++11 sense.
+ * \param[in] num_dims the number of dimensions of the dataset and the length of start, stride, count, and block
+ * \param[in] start the coordinate to start at; must have the same dimension as data or null.
+ *            if null is chosen the zero vector of size N is used.
+ * \param[in] stride how many elements from the first element in each block to skip in each directions before the next block
+ *            if null is chosen the one vector of size N is used.
+ * \param[in] count how many blocks to read in each direction.
+ *            if null is chosen the one vector of size N is used.
+ * \param[in] block the dimentions of each block to read
+ *            if null is chosen the one vector of size N is used.
+ * \returns nullptr on failures, non-null on success
+ * \see pressio_data_select for the semantics of the selection
+ */
+struct pressio_data* pressio_io_read_region(struct pressio_io* io,
+    struct pressio_data* data,
+    size_t num_dims,
+    const size_t* start,
+    const size_t* stride,
+    const size_t* count,
+    const size_t* block);
+
 /** write a pressio_data buffer from some persistent storage
  * \param[in] io the object to preform the write
  * \param[in] data data object to write
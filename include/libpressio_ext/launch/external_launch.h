@@ -12,8 +12,10 @@
 #include "libpressio_ext/cpp/configurable.h"
 #include "libpressio_ext/cpp/errorable.h"
 #include "libpressio_ext/cpp/pressio.h"
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 /**
  * error codes for extern_proc_results
@@ -28,7 +30,9 @@ enum extern_proc_error_codes {
   /** there was a failure to exec the process */
   exec_error=3,
   /** there was a failure parsing the format */
-  format_error=4
+  format_error=4,
+  /** the process exceeded its timeout and was killed */
+  timeout_error=5
 };
 
 /**
@@ -43,6 +47,14 @@ struct extern_proc_results {
   int return_code = 0; 
   /** used to report errors with run_command */
   int error_code = success;
+  /** true if the process was stopped because it exceeded its timeout */
+  bool timed_out = false;
+  /** user CPU time of the process in seconds, if reported by the launch method */
+  double user_time = 0;
+  /** system CPU time of the process in seconds, if reported by the launch method */
+  double system_time = 0;
+  /** maximum resident set size of the process in kilobytes, if reported by the launch method */
+  uint64_t max_rss = 0;
 };
 
 /**
@@ -58,6 +70,43 @@ struct libpressio_launch_plugin: public pressio_configurable, public pressio_err
    */
   virtual extern_proc_results launch(std::vector<std::string> const& args) const =0;
 
+  /**
+   * called by launch_async as each process completes
+   *
+   * \param[in] index the index of the job in the jobs passed to launch_async
+   * \param[in] results the results of running the job
+   */
+  using launch_callback = std::function<void(size_t index, extern_proc_results&& results)>;
+
+  /**
+   * launch several processes, running up to max_concurrency of them at a time, and report the results of
+   * each as it completes.  on_complete is never called concurrently, and all calls complete before
+   * launch_async returns.
+   *
+   * The default implementation calls launch from up to max_concurrency threads, each using its own clone of
+   * the plugin.
+   *
+   * \param[in] jobs the arguments for each process
+   * \param[in] max_concurrency the maximum number of processes to run at a time
+   * \param[in] on_complete called with the results of each process
+   */
+  virtual void launch_async(std::vector<std::vector<std::string>> const& jobs, size_t max_concurrency, launch_callback const& on_complete) const;
+
+  /**
+   * launch several processes, running up to max_concurrency of them at a time
+   *
+   * \param[in] jobs the arguments for each process
+   * \param[in] max_concurrency the maximum number of processes to run at a time
+   * \returns the results of each process in the same order as jobs
+   */
+  std::vector<extern_proc_results> launch_many(std::vector<std::vector<std::string>> const& jobs, size_t max_concurrency) const {
+    std::vector<extern_proc_results> results(jobs.size());
+    launch_async(jobs, max_concurrency, [&results](size_t index, extern_proc_results&& result) {
+        results[index] = std::move(result);
+    });
+    return results;
+  }
+
   pressio_options get_documentation() const final {
     pressio_options opts;
     opts.copy_from(get_documentation_impl());
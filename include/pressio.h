@@ -12,6 +12,7 @@ extern "C" {
 struct pressio;
 struct pressio_compressor;
 struct pressio_metrics;
+struct pressio_options;
 
 /**
  * gets a reference to a new instance of libpressio; initializes the library if necessary
@@ -84,6 +85,29 @@ const char* pressio_supported_compressors();
  * \returns a string containing all the metrics supported by this version separated by a space
  */
 const char* pressio_supported_metrics();
+/**
+ * loads a shared object that registers additional plugins.  Modules named libpressio_plugin_\<name\>.so in
+ * the colon separated directories of the LIBPRESSIO_PLUGIN_PATH environment variable are loaded
+ * automatically the first time a plugin called \<name\> is requested.
+ *
+ * \param[in] library optional argument, if loading fails the error message is stored in the library object
+ * \param[in] path the path to the shared object
+ * \returns 0 on success, non-zero on failure
+ */
+int pressio_load_plugin(struct pressio* library, const char* path);
+/**
+ * reports the cost of the static registrations and library initializations performed so far.
+ * The report contains:
+ *
+ * + startup:names -- the name of each event, for example register:sz or init:SZ_Init
+ * + startup:seconds -- a double pressio_data with the wall time of each event
+ * + startup:rss_bytes -- an int64 pressio_data with the change in resident memory of each event;
+ *   only recorded when the LIBPRESSIO_PROFILE_STARTUP environment variable is set
+ * + startup:total_seconds -- the sum of startup:seconds
+ *
+ * \returns a pressio_options that needs to be freed with pressio_options_free
+ */
+struct pressio_options* pressio_startup_report();
 /**
  * \returns the major version of the library
  */
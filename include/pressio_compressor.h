@@ -13,6 +13,7 @@ extern "C" {
 struct pressio_compressor;
 struct pressio_data;
 struct pressio_options;
+struct pressio_io;
 
 /*!
  * \param[in] compressor deallocates a reference to a compressor.
@@ -318,6 +319,43 @@ int pressio_compressor_decompress_many(struct pressio_compressor* compressor,
     struct pressio_data * out[], size_t num_outputs
     );
 
+/**
+ * compress data that may be too large to fit in memory by reading it in slabs from an io plugin
+ * and writing each compressed slab to another io plugin as it is produced.
+ *
+ * \param[in] compressor the compressor object that will perform compression
+ * \param[in] input the io object to read slabs of the input from
+ * \param[in] input_template a pressio_data object with the dtype and dimensions of the complete input
+ * \param[in] output the io object to write each compressed slab to
+ * \param[in] slab_size the extent of each slab in the slowest varying dimension
+ * \param[in] window the maximum number of slabs held in memory at once
+ * \returns 0 if successful, non-zero if there is an error.  On error, an error message is set in pressio_compressor_error_msg.
+ *
+ * \see libpressio_compressor_plugin::compress_stream for the format of the output
+ */
+int pressio_compressor_compress_stream(struct pressio_compressor* compressor,
+    struct pressio_io* input, struct pressio_data const* input_template,
+    struct pressio_io* output, size_t slab_size, size_t window
+    );
+
+/**
+ * decompress a stream written by pressio_compressor_compress_stream, writing each decompressed slab to
+ * an io plugin as it is produced.
+ *
+ * \param[in] compressor the compressor object that will perform decompression; it must have the same prefix as the one that compressed the stream
+ * \param[in] input the io object to read the stream from; each read must return the next bytes of the stream
+ * \param[in] output the io object to write each decompressed slab to
+ * \param[in] window the maximum number of slabs held in memory at once
+ * \param[out] output_template if not NULL, an existing pressio_data object that is set to an empty buffer with the dtype and dimensions of the complete input
+ * \returns 0 if successful, non-zero if there is an error.  On error, an error message is set in pressio_compressor_error_msg.
+ *
+ * \see libpressio_compressor_plugin::decompress_stream for details
+ */
+int pressio_compressor_decompress_stream(struct pressio_compressor* compressor,
+    struct pressio_io* input, struct pressio_io* output, size_t window,
+    struct pressio_data* output_template
+    );
+
 #endif
 
 #ifdef __cplusplus
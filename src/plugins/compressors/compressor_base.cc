@@ -22,6 +22,16 @@ libpressio_compressor_plugin::~libpressio_compressor_plugin()=default;
 
 
 namespace {
+  /**
+   * bumps the generation once the configuration is finished changing so that results cached
+   * while it was changing are not reused
+   */
+  struct generation_guard {
+    explicit generation_guard(pressio_configurable& configurable): configurable(configurable) {}
+    ~generation_guard() { configurable.bump_generation(); }
+    pressio_configurable& configurable;
+  };
+
   std::set<std::string> get_keys(struct pressio_options const& options, std::string const& prefix) {
     std::set<std::string> keys;
     for (auto const& option : options) {
@@ -66,36 +76,47 @@ int libpressio_compressor_plugin::check_options(struct pressio_options const& op
 struct pressio_options libpressio_compressor_plugin::get_configuration() const {
   if(metrics_plugin)
     metrics_plugin->begin_get_configuration();
-  auto ret = get_configuration_impl();
-  if(metrics_plugin) { 
-    ret.copy_from(metrics_plugin->get_configuration());
+  auto ret = configuration_cache.get([this]{
+    auto ret = get_configuration_impl();
+    if(metrics_plugin) {
+      ret.copy_from(metrics_plugin->get_configuration());
+    }
+    return ret;
+  });
+  if(metrics_plugin)
     metrics_plugin->end_get_configuration(ret);
-  }
   return ret;
 }
 
 struct pressio_options libpressio_compressor_plugin::get_documentation() const {
   if(metrics_plugin)
     metrics_plugin->begin_get_documentation();
-  auto ret = get_documentation_impl();
-  set(ret, "pressio:thread_safe", "level of thread safety provided by the compressor");
-  set(ret, "pressio:stability", "level of stablity provided by the compressor; see the README for libpressio");
-  if(metrics_plugin) { 
-    ret.copy_from(metrics_plugin->get_documentation());
-    set_meta_docs(ret, get_metrics_key_name(), "metrics to collect when using the compressor", metrics_plugin);
+  auto ret = documentation_cache.get([this]{
+    auto ret = get_documentation_impl();
+    set(ret, "pressio:thread_safe", "level of thread safety provided by the compressor");
+    set(ret, "pressio:stability", "level of stablity provided by the compressor; see the README for libpressio");
+    if(metrics_plugin) {
+      ret.copy_from(metrics_plugin->get_documentation());
+      set_meta_docs(ret, get_metrics_key_name(), "metrics to collect when using the compressor", metrics_plugin);
+    }
+    return ret;
+  });
+  if(metrics_plugin)
     metrics_plugin->end_get_documentation(ret);
-  }
   return ret;
 }
 
 struct pressio_options libpressio_compressor_plugin::get_options() const {
   if(metrics_plugin)
     metrics_plugin->begin_get_options();
-  pressio_options opts;
-  set_meta(opts, get_metrics_key_name(), metrics_id, metrics_plugin);
-  set(opts, "metrics:errors_fatal", metrics_errors_fatal);
-  set(opts, "metrics:copy_compressor_results", metrics_copy_impl_results);
-  opts.copy_from(get_options_impl());
+  auto opts = options_cache.get([this]{
+    pressio_options opts;
+    set_meta(opts, get_metrics_key_name(), metrics_id, metrics_plugin);
+    set(opts, "metrics:errors_fatal", metrics_errors_fatal);
+    set(opts, "metrics:copy_compressor_results", metrics_copy_impl_results);
+    opts.copy_from(get_options_impl());
+    return opts;
+  });
   if(metrics_plugin)
     metrics_plugin->end_get_options(&opts);
   return opts;
@@ -103,6 +124,7 @@ struct pressio_options libpressio_compressor_plugin::get_options() const {
 
 int libpressio_compressor_plugin::set_options(struct pressio_options const& options) {
   clear_error();
+  options_change_scope changed(*this, options);
   if(metrics_plugin) {
     if(metrics_plugin->begin_set_options(options) != 0 && metrics_errors_fatal) {
       set_error(metrics_plugin->error_code(), metrics_plugin->error_msg());
@@ -112,7 +134,7 @@ int libpressio_compressor_plugin::set_options(struct pressio_options const& opti
   get_meta(options, get_metrics_key_name(), metrics_plugins(), metrics_id, metrics_plugin);
   get(options, "metrics:errors_fatal", &metrics_errors_fatal);
   get(options, "metrics:copy_compressor_results", &metrics_copy_impl_results);
-  auto ret = set_options_impl(options);
+  auto ret = changed.finish(set_options_impl(options));
   if(metrics_plugin) {
     if(metrics_plugin->end_set_options(options, ret) != 0 && metrics_errors_fatal) {
       set_error(metrics_plugin->error_code(), metrics_plugin->error_msg());
@@ -170,6 +192,7 @@ struct pressio_metrics libpressio_compressor_plugin::get_metrics() const {
 }
 
 void libpressio_compressor_plugin::set_metrics(pressio_metrics& plugin) {
+  generation_guard changed(*this);
   metrics_plugin = plugin;
   if(plugin) {
     metrics_id = metrics_plugin->prefix();
@@ -187,6 +210,7 @@ struct pressio_options libpressio_compressor_plugin::get_metrics_options() const
 
 int libpressio_compressor_plugin::set_metrics_options(struct pressio_options const& options) {
   clear_error();
+  generation_guard changed(*this);
   return metrics_plugin->set_options(options);
 }
 
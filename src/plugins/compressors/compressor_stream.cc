@@ -0,0 +1,449 @@
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "libpressio_ext/cpp/compressor.h"
+#include "libpressio_ext/cpp/data.h"
+#include "libpressio_ext/cpp/io.h"
+#include "libpressio_ext/cpp/options.h"
+#include "std_compat/memory.h"
+
+namespace {
+  /**
+   * hands slabs from one stage of the stream to the next in order
+   */
+  class slab_queue {
+    public:
+    void push(pressio_data&& data) {
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        if(aborted) return;
+        slabs.emplace_back(std::move(data));
+      }
+      ready.notify_one();
+    }
+
+    /**
+     * \returns false once the queue is closed and drained, or aborted
+     */
+    bool pop(pressio_data& data) {
+      std::unique_lock<std::mutex> guard(lock);
+      ready.wait(guard, [this]{ return aborted || closed || !slabs.empty(); });
+      if(aborted || slabs.empty()) return false;
+      data = std::move(slabs.front());
+      slabs.pop_front();
+      return true;
+    }
+
+    /** no more slabs will be pushed */
+    void close() {
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        closed = true;
+      }
+      ready.notify_all();
+    }
+
+    /** discard any remaining slabs */
+    void abort() {
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        aborted = true;
+        slabs.clear();
+      }
+      ready.notify_all();
+    }
+
+    private:
+    std::mutex lock;
+    std::condition_variable ready;
+    std::deque<pressio_data> slabs;
+    bool closed = false;
+    bool aborted = false;
+  };
+
+  /**
+   * limits the number of slabs between being read and being written
+   */
+  class window_slots {
+    public:
+    explicit window_slots(size_t window): available(window) {}
+
+    /**
+     * \returns false if the stream was aborted while waiting
+     */
+    bool acquire() {
+      std::unique_lock<std::mutex> guard(lock);
+      released.wait(guard, [this]{ return aborted || available > 0; });
+      if(aborted) return false;
+      --available;
+      return true;
+    }
+
+    void release() {
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        ++available;
+      }
+      released.notify_one();
+    }
+
+    void abort() {
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        aborted = true;
+      }
+      released.notify_all();
+    }
+
+    private:
+    std::mutex lock;
+    std::condition_variable released;
+    size_t available;
+    bool aborted = false;
+  };
+
+  const char stream_magic[8] = {'P','R','E','S','S','I','O','S'};
+  const uint32_t stream_version = 1;
+
+  /**
+   * the fixed size beginning of a stream; the rest of the header follows it
+   */
+  struct stream_prefix {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+  };
+
+  /**
+   * describes the complete input of a stream
+   */
+  struct stream_header {
+    pressio_dtype dtype;
+    std::vector<size_t> dims;
+    uint64_t slab_size;
+    std::string compressor_id;
+
+    uint64_t num_slabs() const {
+      return (dims.back() + slab_size - 1) / slab_size;
+    }
+
+    std::vector<size_t> slab_dims(uint64_t i) const {
+      auto ret = dims;
+      ret.back() = std::min<size_t>(slab_size, dims.back() - i * slab_size);
+      return ret;
+    }
+
+    /**
+     * \returns the largest compressed frame accepted for a slab; compressors may expand incompressible
+     * data, but a frame larger than this is taken to be corrupt rather than allocated
+     */
+    uint64_t max_frame_size() const {
+      uint64_t slab_bytes = pressio_dtype_size(dtype) * std::min<uint64_t>(slab_size, dims.back());
+      for (size_t i = 0; i + 1 < dims.size(); ++i) {
+        slab_bytes *= dims[i];
+      }
+      return 2 * slab_bytes + max_frame_overhead;
+    }
+
+    static const uint64_t max_frame_overhead = 1 << 20;
+  };
+
+  /**
+   * \returns true if the io plugin reads or writes a path, which it reopens on each call, rather than
+   * continuing from the position of a file descriptor or file pointer
+   */
+  bool uses_path(libpressio_io_plugin const& io) {
+    std::string path;
+    return io.get_options().get("io:path", &path) == pressio_options_key_set;
+  }
+
+  template <class T>
+  void append(std::string& buffer, T const& value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  template <class T>
+  bool consume(const char*& pos, const char* end, T& value) {
+    if(static_cast<size_t>(end - pos) < sizeof(T)) return false;
+    memcpy(&value, pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+  }
+
+  pressio_data encode_header(stream_header const& header) {
+    std::string rest;
+    append<int32_t>(rest, header.dtype);
+    append<uint64_t>(rest, header.dims.size());
+    for (auto dim : header.dims) {
+      append<uint64_t>(rest, dim);
+    }
+    append<uint64_t>(rest, header.slab_size);
+    append<uint64_t>(rest, header.compressor_id.size());
+    rest.append(header.compressor_id);
+
+    stream_prefix prefix{};
+    memcpy(prefix.magic, stream_magic, sizeof(stream_magic));
+    prefix.version = stream_version;
+    prefix.header_size = static_cast<uint32_t>(rest.size());
+    auto encoded = pressio_data::owning(pressio_byte_dtype, {sizeof(prefix) + rest.size()});
+    memcpy(encoded.data(), &prefix, sizeof(prefix));
+    memcpy(static_cast<char*>(encoded.data()) + sizeof(prefix), rest.data(), rest.size());
+    return encoded;
+  }
+
+  /**
+   * reads exactly size bytes from the next position of input
+   */
+  std::unique_ptr<pressio_data> read_bytes(libpressio_io_plugin& input, size_t size) {
+    auto buffer = pressio_data::empty(pressio_byte_dtype, {size});
+    return std::unique_ptr<pressio_data>(input.read(&buffer));
+  }
+
+  /**
+   * \returns an empty string on success or a description of the problem
+   */
+  std::string decode_header(libpressio_io_plugin& input, stream_header& header) {
+    stream_prefix prefix;
+    auto prefix_data = read_bytes(input, sizeof(prefix));
+    if(!prefix_data || prefix_data->size_in_bytes() != sizeof(prefix)) {
+      return std::string("failed to read the stream header: ") + input.error_msg();
+    }
+    memcpy(&prefix, prefix_data->data(), sizeof(prefix));
+    if(memcmp(prefix.magic, stream_magic, sizeof(stream_magic)) != 0) {
+      return "not a compressed stream";
+    }
+    if(prefix.version != stream_version) {
+      return "unsupported stream version " + std::to_string(prefix.version);
+    }
+    auto rest = read_bytes(input, prefix.header_size);
+    if(!rest || rest->size_in_bytes() != prefix.header_size) {
+      return std::string("failed to read the stream header: ") + input.error_msg();
+    }
+    const char* pos = static_cast<const char*>(rest->data());
+    const char* end = pos + prefix.header_size;
+    int32_t dtype;
+    uint64_t ndims, id_size;
+    if(!consume(pos, end, dtype) || !consume(pos, end, ndims) || ndims == 0 ||
+        ndims > static_cast<uint64_t>(end - pos) / sizeof(uint64_t)) {
+      return "corrupt stream header";
+    }
+    header.dtype = static_cast<pressio_dtype>(dtype);
+    if(pressio_dtype_size(header.dtype) <= 0) {
+      return "corrupt stream header";
+    }
+    //the dimensions must describe a buffer whose frames can be bounded without overflow
+    uint64_t max_elements = (std::numeric_limits<uint64_t>::max() - stream_header::max_frame_overhead) / 2 /
+      pressio_dtype_size(header.dtype);
+    header.dims.resize(ndims);
+    for (auto& dim : header.dims) {
+      uint64_t tmp;
+      consume(pos, end, tmp);
+      if(tmp > max_elements) {
+        return "corrupt stream header";
+      }
+      if(tmp != 0) max_elements /= tmp;
+      dim = tmp;
+    }
+    if(!consume(pos, end, header.slab_size) || header.slab_size == 0 || !consume(pos, end, id_size) ||
+        id_size != static_cast<uint64_t>(end - pos)) {
+      return "corrupt stream header";
+    }
+    header.compressor_id.assign(pos, id_size);
+    return "";
+  }
+}
+
+int libpressio_compressor_plugin::compress_stream(libpressio_io_plugin& input, pressio_data const& input_template,
+    libpressio_io_plugin& output, size_t slab_size, size_t window) {
+  clear_error();
+  const std::vector<size_t> dims = input_template.dimensions();
+  if(dims.empty()) {
+    return set_error(1, "the input template must have dimensions");
+  }
+  if(slab_size == 0 || window == 0) {
+    return set_error(1, "the slab size and window must be non-zero");
+  }
+  if(uses_path(output)) {
+    return set_error(1, "streams must be written through io:file_descriptor or io:file_pointer, not io:path");
+  }
+  const pressio_dtype dtype = input_template.dtype();
+  const stream_header header{dtype, dims, slab_size, prefix()};
+  const size_t num_slabs = header.num_slabs();
+  auto encoded_header = encode_header(header);
+  if(output.write(&encoded_header)) {
+    return set_error(output.error_code(), std::string("failed to write the stream header: ") + output.error_msg());
+  }
+
+  slab_queue to_compress, to_write;
+  window_slots slots(window);
+  std::mutex error_lock;
+  int stream_error = 0;
+  std::string stream_msg;
+  auto fail = [&](int code, std::string const& msg) {
+    {
+      std::lock_guard<std::mutex> guard(error_lock);
+      if(stream_error == 0) {
+        stream_error = (code) ? code : 1;
+        stream_msg = msg;
+      }
+    }
+    slots.abort();
+    to_compress.abort();
+    to_write.abort();
+  };
+
+  std::thread reader([&]{
+    std::vector<size_t> start(dims.size(), 0), stride(dims.size(), 1), count(dims), block(dims.size(), 1);
+    for (size_t i = 0; i < num_slabs; ++i) {
+      if(!slots.acquire()) break;
+      start.back() = i * slab_size;
+      count.back() = std::min(slab_size, dims.back() - start.back());
+      auto full = pressio_data::empty(dtype, dims);
+      std::unique_ptr<pressio_data> slab(input.read_region(&full, start, stride, count, block));
+      if(!slab) {
+        fail(input.error_code(), "failed to read slab " + std::to_string(i) + ": " + input.error_msg());
+        break;
+      }
+      to_compress.push(std::move(*slab));
+    }
+    to_compress.close();
+  });
+
+  std::thread writer([&]{
+    pressio_data compressed;
+    while(to_write.pop(compressed)) {
+      const uint64_t compressed_size = compressed.size_in_bytes();
+      auto frame = pressio_data::owning(pressio_byte_dtype, {sizeof(uint64_t) + compressed_size});
+      auto frame_ptr = static_cast<unsigned char*>(frame.data());
+      memcpy(frame_ptr, &compressed_size, sizeof(uint64_t));
+      memcpy(frame_ptr + sizeof(uint64_t), compressed.data(), compressed_size);
+      compressed = pressio_data();
+      if(output.write(&frame)) {
+        fail(output.error_code(), std::string("failed to write slab: ") + output.error_msg());
+        break;
+      }
+      slots.release();
+    }
+  });
+
+  pressio_data slab;
+  while(to_compress.pop(slab)) {
+    auto compressed = pressio_data::empty(pressio_byte_dtype, {});
+    if(compress(&slab, &compressed)) {
+      fail(error_code(), error_msg());
+      break;
+    }
+    slab = pressio_data();
+    to_write.push(std::move(compressed));
+  }
+  to_write.close();
+
+  reader.join();
+  writer.join();
+  if(stream_error) {
+    return set_error(stream_error, stream_msg);
+  }
+  return 0;
+}
+
+int libpressio_compressor_plugin::decompress_stream(libpressio_io_plugin& input, libpressio_io_plugin& output,
+    size_t window, pressio_data* output_template) {
+  clear_error();
+  if(window == 0) {
+    return set_error(1, "the window must be non-zero");
+  }
+  if(uses_path(input) || uses_path(output)) {
+    return set_error(1, "streams must be read and written through io:file_descriptor or io:file_pointer, not io:path");
+  }
+  stream_header header;
+  auto header_error = decode_header(input, header);
+  if(!header_error.empty()) {
+    return set_error(1, header_error);
+  }
+  if(header.compressor_id != prefix()) {
+    return set_error(1, "the stream was compressed with " + header.compressor_id + " not " + prefix());
+  }
+  if(output_template) {
+    *output_template = pressio_data::empty(header.dtype, header.dims);
+  }
+  const uint64_t num_slabs = header.num_slabs();
+  const uint64_t max_frame_size = header.max_frame_size();
+
+  slab_queue to_decompress, to_write;
+  window_slots slots(window);
+  std::mutex error_lock;
+  int stream_error = 0;
+  std::string stream_msg;
+  auto fail = [&](int code, std::string const& msg) {
+    {
+      std::lock_guard<std::mutex> guard(error_lock);
+      if(stream_error == 0) {
+        stream_error = (code) ? code : 1;
+        stream_msg = msg;
+      }
+    }
+    slots.abort();
+    to_decompress.abort();
+    to_write.abort();
+  };
+
+  std::thread reader([&]{
+    for (uint64_t i = 0; i < num_slabs; ++i) {
+      if(!slots.acquire()) break;
+      uint64_t compressed_size;
+      auto size_data = read_bytes(input, sizeof(compressed_size));
+      std::unique_ptr<pressio_data> frame;
+      if(size_data && size_data->size_in_bytes() == sizeof(compressed_size)) {
+        memcpy(&compressed_size, size_data->data(), sizeof(compressed_size));
+        if(compressed_size > max_frame_size) {
+          fail(1, "slab " + std::to_string(i) + " is larger than the stream header allows");
+          break;
+        }
+        frame = read_bytes(input, compressed_size);
+      }
+      if(!frame || frame->size_in_bytes() != compressed_size) {
+        fail(input.error_code(), "failed to read slab " + std::to_string(i) + ": " + input.error_msg());
+        break;
+      }
+      to_decompress.push(std::move(*frame));
+    }
+    to_decompress.close();
+  });
+
+  std::thread writer([&]{
+    pressio_data slab;
+    while(to_write.pop(slab)) {
+      if(output.write(&slab)) {
+        fail(output.error_code(), std::string("failed to write slab: ") + output.error_msg());
+        break;
+      }
+      slab = pressio_data();
+      slots.release();
+    }
+  });
+
+  pressio_data compressed;
+  for (uint64_t i = 0; to_decompress.pop(compressed); ++i) {
+    auto slab = pressio_data::empty(header.dtype, header.slab_dims(i));
+    if(decompress(&compressed, &slab)) {
+      fail(error_code(), error_msg());
+      break;
+    }
+    compressed = pressio_data();
+    to_write.push(std::move(slab));
+  }
+  to_write.close();
+
+  reader.join();
+  writer.join();
+  if(stream_error) {
+    return set_error(stream_error, stream_msg);
+  }
+  return 0;
+}
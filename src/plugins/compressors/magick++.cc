@@ -28,7 +28,10 @@ std::mutex magick_init_lock;
  */
 class magick_init {
   public:
-    magick_init() { Magick::InitializeMagick(NULL); }
+    magick_init() {
+      pressio_startup_timer timer("init:InitializeMagick");
+      Magick::InitializeMagick(NULL);
+    }
     ~magick_init() { Magick::TerminateMagick();}
   static std::shared_ptr<magick_init> get_library() {
     std::lock_guard<std::mutex> guard(magick_init_lock);
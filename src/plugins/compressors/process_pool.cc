@@ -0,0 +1,572 @@
+#include "std_compat/memory.h"
+#include "libpressio_ext/cpp/compressor.h"
+#include "libpressio_ext/cpp/data.h"
+#include "libpressio_ext/cpp/options.h"
+#include "libpressio_ext/cpp/pressio.h"
+#include "libpressio_ext/cpp/binary.h"
+#include "pressio_compressor.h"
+#include "pressio_data.h"
+#include "pressio_options.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+namespace {
+  enum class pool_op: int32_t {
+    compress = 0,
+    decompress = 1
+  };
+
+  /**
+   * creates a shared memory object with a name unique to this process
+   *
+   * \param[out] name the name of the object
+   * \returns a file descriptor to the object or -1 on failure
+   */
+  int create_shm(std::string& name) {
+    static std::atomic<uint64_t> counter{0};
+    name = "/pressiopool" + std::to_string(getpid()) + "_" + std::to_string(counter++);
+    return shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  }
+
+  /**
+   * copies the contents of data into a new shared memory object
+   *
+   * \param[in] data the data to copy
+   * \param[out] name the name of the object
+   * \returns 0 on success
+   */
+  int write_shm(pressio_data const& data, std::string& name) {
+    int fd = create_shm(name);
+    if(fd == -1) return -1;
+    const size_t size = data.size_in_bytes();
+    int ret = 0;
+    if(ftruncate(fd, size) == -1) {
+      ret = -1;
+    } else if(size > 0) {
+      void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      if(ptr == MAP_FAILED) {
+        ret = -1;
+      } else {
+        memcpy(ptr, data.data(), size);
+        munmap(ptr, size);
+      }
+    }
+    close(fd);
+    if(ret) shm_unlink(name.c_str());
+    return ret;
+  }
+
+  void munmap_deleter(void* data, void* metadata) {
+    munmap(data, reinterpret_cast<uintptr_t>(metadata));
+  }
+
+  /**
+   * maps the shared memory object name as the contents of data described by descriptor
+   *
+   * \param[in] name the name of the object
+   * \param[in] descriptor an empty pressio_data with the type and dimensions of the data
+   * \param[in] prot the protection of the mapping
+   * \param[out] data the mapped data which unmaps the object when freed
+   * \returns 0 on success
+   */
+  int map_shm(std::string const& name, pressio_data const& descriptor, int prot, pressio_data& data) {
+    int fd = shm_open(name.c_str(), (prot & PROT_WRITE) ? O_RDWR : O_RDONLY, 0);
+    if(fd == -1) return -1;
+    const size_t size = descriptor.size_in_bytes();
+    if(size == 0) {
+      close(fd);
+      data = pressio_data::owning(descriptor.dtype(), descriptor.dimensions());
+      return 0;
+    }
+    void* ptr = mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+    close(fd);
+    if(ptr == MAP_FAILED) return -1;
+    data = pressio_data::move(descriptor.dtype(), ptr, descriptor.dimensions(), munmap_deleter,
+        reinterpret_cast<void*>(static_cast<uintptr_t>(size)));
+    return 0;
+  }
+
+  bool write_all(int fd, const void* buffer, size_t size) {
+    const char* ptr = static_cast<const char*>(buffer);
+    while(size > 0) {
+      //MSG_NOSIGNAL reports a peer that exited as an error instead of raising SIGPIPE
+      ssize_t written = send(fd, ptr, size, MSG_NOSIGNAL);
+      if(written == -1) {
+        if(errno == EINTR) continue;
+        return false;
+      }
+      ptr += written;
+      size -= written;
+    }
+    return true;
+  }
+
+  bool read_all(int fd, void* buffer, size_t size) {
+    char* ptr = static_cast<char*>(buffer);
+    while(size > 0) {
+      ssize_t nread = recv(fd, ptr, size, 0);
+      if(nread == -1) {
+        if(errno == EINTR) continue;
+        return false;
+      }
+      if(nread == 0) return false;
+      ptr += nread;
+      size -= nread;
+    }
+    return true;
+  }
+
+  /**
+   * sends options as a message prefixed with its length
+   */
+  bool send_message(int fd, pressio_options const& message) {
+    pressio_data encoded = options_to_binary(message);
+    uint64_t size = encoded.size_in_bytes();
+    return write_all(fd, &size, sizeof(size)) && write_all(fd, encoded.data(), size);
+  }
+
+  /**
+   * receives a message sent by send_message
+   */
+  bool recv_message(int fd, pressio_options& message) {
+    uint64_t size;
+    if(!read_all(fd, &size, sizeof(size))) return false;
+    std::string buffer(size, '\0');
+    if(!read_all(fd, &buffer[0], size)) return false;
+    try {
+      message = options_from_binary(buffer.data(), buffer.size());
+    } catch(std::exception const&) {
+      return false;
+    }
+    return true;
+  }
+
+  std::string key(const char* kind, size_t i, const char* field = nullptr) {
+    std::string ret = std::string(kind) + ":" + std::to_string(i);
+    if(field) ret += std::string(":") + field;
+    return ret;
+  }
+
+  /**
+   * serves jobs sent over fd with the compressor inherited from the parent until fd is closed
+   */
+  [[noreturn]] void worker_main(int fd, pressio_compressor& compressor) {
+    pressio_options request;
+    while(recv_message(fd, request)) {
+      pressio_options reply;
+      int32_t op = 0;
+      uint64_t ninputs = 0, noutputs = 0;
+      request.get("op", &op);
+      request.get("ninputs", &ninputs);
+      request.get("noutputs", &noutputs);
+
+      std::vector<pressio_data> inputs(ninputs), outputs(noutputs);
+      int status = 0;
+      std::string msg;
+      for (size_t i = 0; i < ninputs && status == 0; ++i) {
+        pressio_data descriptor;
+        std::string name;
+        request.get(key("inputs", i), &descriptor);
+        request.get(key("inputs", i, "shm"), &name);
+        if(map_shm(name, descriptor, PROT_READ, inputs[i])) {
+          status = -1;
+          msg = "failed to map input " + name + ": " + strerror(errno);
+        }
+      }
+      for (size_t i = 0; i < noutputs; ++i) {
+        request.get(key("outputs", i), &outputs[i]);
+      }
+
+      if(status == 0) {
+        std::vector<const pressio_data*> input_ptrs;
+        std::vector<pressio_data*> output_ptrs;
+        for (auto const& input : inputs) input_ptrs.push_back(&input);
+        for (auto& output : outputs) output_ptrs.push_back(&output);
+        if(static_cast<pool_op>(op) == pool_op::compress) {
+          status = compressor->compress_many(input_ptrs.data(), input_ptrs.data() + input_ptrs.size(),
+              output_ptrs.data(), output_ptrs.data() + output_ptrs.size());
+        } else {
+          status = compressor->decompress_many(input_ptrs.data(), input_ptrs.data() + input_ptrs.size(),
+              output_ptrs.data(), output_ptrs.data() + output_ptrs.size());
+        }
+        if(status) {
+          msg = compressor->error_msg();
+        }
+      }
+      inputs.clear();
+
+      for (size_t i = 0; i < noutputs && status == 0; ++i) {
+        std::string name;
+        if(write_shm(outputs[i], name)) {
+          status = -1;
+          msg = std::string("failed to share output: ") + strerror(errno);
+          break;
+        }
+        reply.set(key("outputs", i), pressio_data::empty(outputs[i].dtype(), outputs[i].dimensions()));
+        reply.set(key("outputs", i, "shm"), name);
+      }
+
+      for (auto const& metric : compressor->get_metrics_results()) {
+        reply.set("metrics:" + metric.first, metric.second);
+      }
+      reply.set("status", static_cast<int32_t>(status));
+      reply.set("msg", msg);
+      if(!send_message(fd, reply)) break;
+    }
+    _exit(0);
+  }
+
+  /**
+   * a forked process hosting its own instance of the child compressor
+   */
+  struct pool_worker {
+    pid_t pid = -1;
+    int fd = -1;
+  };
+}
+
+class process_pool_compressor_plugin : public libpressio_compressor_plugin {
+public:
+  process_pool_compressor_plugin()=default;
+  process_pool_compressor_plugin(process_pool_compressor_plugin const& rhs):
+    libpressio_compressor_plugin(rhs),
+    compressor(rhs.compressor),
+    compressor_id(rhs.compressor_id),
+    nprocs(rhs.nprocs),
+    group_size(rhs.group_size)
+  {}
+  process_pool_compressor_plugin& operator=(process_pool_compressor_plugin const&)=delete;
+  ~process_pool_compressor_plugin() {
+    stop_workers();
+  }
+
+  struct pressio_options get_options_impl() const override
+  {
+    struct pressio_options options;
+    set_meta(options, "process_pool:compressor", compressor_id, compressor);
+    set(options, "process_pool:nprocs", nprocs);
+    set(options, "process_pool:group_size", group_size);
+    return options;
+  }
+
+  struct pressio_options get_configuration_impl() const override
+  {
+    struct pressio_options options;
+    options.copy_from(compressor->get_configuration());
+    set(options, "pressio:thread_safe", static_cast<int32_t>(pressio_thread_safety_multiple));
+    set(options, "pressio:stability", "experimental");
+    return options;
+  }
+
+  struct pressio_options get_documentation_impl() const override
+  {
+    struct pressio_options options;
+    set_meta_docs(options, "process_pool:compressor", "the child compressor to use", compressor);
+    set(options, "pressio:description", R"(Compresses multiple buffers in parallel in a pool of forked processes
+
+    Each process hosts its own copy of the child compressor, so compressors that are not thread safe because of
+    global state still run in parallel.  Each group of process_pool:group_size consecutive buffers is sent to a process through POSIX shared memory.
+    The processes are forked when first needed and replaced when the options change, so the compressor must not be
+    used from another thread while it compresses.  Metrics results are those of the last group.)");
+    set(options, "process_pool:nprocs", R"(number of processes to use for compression)");
+    set(options, "process_pool:group_size", R"(number of consecutive buffers passed together to one call of the child compressor;
+    the last group holds the remaining buffers when their number is not a multiple of the group size)");
+    return options;
+  }
+
+
+  int set_options_impl(struct pressio_options const& options) override
+  {
+    get_meta(options, "process_pool:compressor", compressor_plugins(), compressor_id, compressor);
+    auto tmp_group_size = group_size;
+    if (get(options, "process_pool:group_size", &tmp_group_size) == pressio_options_key_set) {
+      if(tmp_group_size >= 1) {
+        group_size = tmp_group_size;
+      } else {
+        return set_error(1, "invalid group size");
+      }
+    }
+    auto tmp_nprocs = nprocs;
+    if (get(options, "process_pool:nprocs", &tmp_nprocs) == pressio_options_key_set) {
+      if(tmp_nprocs >= 1) {
+        nprocs = tmp_nprocs;
+      } else {
+        return set_error(1, "invalid process count");
+      }
+    }
+    //the workers hold a copy of the old configuration
+    stop_workers();
+    return 0;
+  }
+
+  int compress_impl(const pressio_data* input,
+                    struct pressio_data* output) override
+  {
+    compat::span<const pressio_data*> inputs(&input, 1);
+    compat::span<pressio_data*> outputs(&output, 1);
+    return compress_many_impl(inputs, outputs);
+  }
+
+  int decompress_impl(const pressio_data* input,
+                      struct pressio_data* output) override
+  {
+    compat::span<const pressio_data*> inputs(&input, 1);
+    compat::span<pressio_data*> outputs(&output, 1);
+    return decompress_many_impl(inputs, outputs);
+  }
+
+  int compress_many_impl(compat::span<const pressio_data* const> const& inputs, compat::span<pressio_data*> & outputs) override {
+    return common_many_impl(inputs, outputs, pool_op::compress);
+  }
+
+  int decompress_many_impl(compat::span<const pressio_data* const> const& inputs, compat::span<pressio_data* >& outputs) override {
+    return common_many_impl(inputs, outputs, pool_op::decompress);
+  }
+
+
+  int major_version() const override { return 0; }
+  int minor_version() const override { return 0; }
+  int patch_version() const override { return 1; }
+
+  const char* version() const override { return "0.0.1"; }
+
+  const char* prefix() const override { return "process_pool"; }
+
+  void set_name_impl(std::string const& name) override {
+    compressor->set_name(name + "/" + compressor->prefix());
+  }
+
+  pressio_options get_metrics_results_impl() const override {
+    if(metrics_results.size() == 0) {
+      return compressor->get_metrics_results();
+    }
+    return metrics_results;
+  }
+
+  std::shared_ptr<libpressio_compressor_plugin> clone() override
+  {
+    return compat::make_unique<process_pool_compressor_plugin>(*this);
+  }
+
+private:
+  /**
+   * a group of buffers sent to a worker
+   */
+  struct pool_job {
+    std::vector<pressio_data const*> inputs;
+    std::vector<pressio_data*> outputs;
+    std::vector<std::string> input_shm;
+  };
+
+  int common_many_impl(compat::span<const pressio_data* const> const& inputs, compat::span<pressio_data*> & outputs, pool_op op)
+  {
+    if(inputs.size() != outputs.size()) {
+      return set_error(1, "the number of inputs and outputs must be equal");
+    }
+    if(int ec = start_workers()) {
+      return ec;
+    }
+
+    std::vector<pool_job> jobs;
+    //the last group is shorter when the number of buffers is not a multiple of the group size
+    for (size_t i = 0; i < inputs.size(); i += group_size) {
+      const size_t group_end = std::min<size_t>(i + group_size, inputs.size());
+      jobs.push_back(pool_job{
+          std::vector<pressio_data const*>(inputs.begin() + i, inputs.begin() + group_end),
+          std::vector<pressio_data*>(outputs.begin() + i, outputs.begin() + group_end),
+          {}});
+    }
+
+    int status = 0;
+    size_t next = 0, finished = 0;
+    //index of the job each worker is running or -1
+    std::vector<int64_t> assigned(workers.size(), -1);
+    while(finished < jobs.size()) {
+      for (size_t w = 0; w < workers.size() && next < jobs.size() && status == 0; ++w) {
+        if(assigned[w] != -1) continue;
+        if(send_job(workers[w], op, jobs[next])) {
+          assigned[w] = static_cast<int64_t>(next++);
+        } else {
+          release_job(jobs[next]);
+          status = set_error(2, "failed to send a job to process " + std::to_string(workers[w].pid));
+          stop_worker(workers[w]);
+          //nothing remaining will be run, account for it as finished
+          finished += jobs.size() - next;
+          next = jobs.size();
+        }
+      }
+
+      std::vector<pollfd> pollfds;
+      std::vector<size_t> polled;
+      for (size_t w = 0; w < workers.size(); ++w) {
+        if(assigned[w] != -1) {
+          pollfds.push_back(pollfd{workers[w].fd, POLLIN, 0});
+          polled.push_back(w);
+        }
+      }
+      if(pollfds.empty()) break;
+      if(poll(pollfds.data(), pollfds.size(), -1) == -1) {
+        if(errno == EINTR) continue;
+        status = set_error(2, std::string("failed to wait for the processes: ") + strerror(errno));
+        break;
+      }
+
+      for (size_t p = 0; p < pollfds.size(); ++p) {
+        if(!pollfds[p].revents) continue;
+        const size_t w = polled[p];
+        auto& job = jobs[assigned[w]];
+        int job_status = receive_job(workers[w], job);
+        release_job(job);
+        assigned[w] = -1;
+        ++finished;
+        if(job_status && status == 0) {
+          status = job_status;
+          //stop handing out work after the first failure
+          finished += jobs.size() - next;
+          next = jobs.size();
+        }
+      }
+    }
+
+    for (size_t w = 0; w < workers.size(); ++w) {
+      if(assigned[w] != -1) release_job(jobs[assigned[w]]);
+    }
+    return status;
+  }
+
+  bool send_job(pool_worker const& worker, pool_op op, pool_job& job) {
+    pressio_options request;
+    request.set("op", static_cast<int32_t>(op));
+    request.set("ninputs", static_cast<uint64_t>(job.inputs.size()));
+    request.set("noutputs", static_cast<uint64_t>(job.outputs.size()));
+    for (size_t i = 0; i < job.inputs.size(); ++i) {
+      std::string name;
+      if(write_shm(*job.inputs[i], name)) return false;
+      job.input_shm.push_back(name);
+      request.set(key("inputs", i), pressio_data::empty(job.inputs[i]->dtype(), job.inputs[i]->dimensions()));
+      request.set(key("inputs", i, "shm"), name);
+    }
+    for (size_t i = 0; i < job.outputs.size(); ++i) {
+      request.set(key("outputs", i), pressio_data::empty(job.outputs[i]->dtype(), job.outputs[i]->dimensions()));
+    }
+    return send_message(worker.fd, request);
+  }
+
+  int receive_job(pool_worker& worker, pool_job& job) {
+    pressio_options reply;
+    if(!recv_message(worker.fd, reply)) {
+      const pid_t pid = worker.pid;
+      stop_worker(worker);
+      return set_error(2, "process " + std::to_string(pid) + " exited while running a job");
+    }
+
+    int32_t status = 0;
+    std::string msg;
+    reply.get("status", &status);
+    reply.get("msg", &msg);
+
+    metrics_results.clear();
+    const std::string metrics_prefix = "metrics:";
+    for (auto const& item : reply) {
+      if(item.first.compare(0, metrics_prefix.size(), metrics_prefix) == 0) {
+        metrics_results.set(item.first.substr(metrics_prefix.size()), item.second);
+      }
+    }
+
+    for (size_t i = 0; i < job.outputs.size(); ++i) {
+      pressio_data descriptor;
+      std::string name;
+      if(reply.get(key("outputs", i, "shm"), &name) != pressio_options_key_set) continue;
+      reply.get(key("outputs", i), &descriptor);
+      int ec = map_shm(name, descriptor, PROT_READ | PROT_WRITE, *job.outputs[i]);
+      shm_unlink(name.c_str());
+      if(ec && status == 0) {
+        status = -1;
+        msg = "failed to map output " + name + ": " + strerror(errno);
+      }
+    }
+
+    if(status) {
+      return set_error(status, msg);
+    }
+    return 0;
+  }
+
+  static void release_job(pool_job& job) {
+    for (auto const& name : job.input_shm) {
+      shm_unlink(name.c_str());
+    }
+    job.input_shm.clear();
+  }
+
+  int start_workers() {
+    workers.resize(nprocs);
+    for (auto& worker : workers) {
+      if(worker.pid != -1) continue;
+      int fds[2];
+      if(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) == -1) {
+        return set_error(2, std::string("failed to create socket: ") + strerror(errno));
+      }
+      pid_t pid = fork();
+      switch(pid) {
+        case -1:
+          close(fds[0]);
+          close(fds[1]);
+          return set_error(2, std::string("failed to fork: ") + strerror(errno));
+        case 0:
+          //in the worker, close the connections to the parent's other workers
+          close(fds[0]);
+          for (auto const& other : workers) {
+            if(other.fd != -1) close(other.fd);
+          }
+          worker_main(fds[1], compressor);
+        default:
+          close(fds[1]);
+          worker.pid = pid;
+          worker.fd = fds[0];
+      }
+    }
+    return 0;
+  }
+
+  static void stop_worker(pool_worker& worker) {
+    if(worker.pid == -1) return;
+    //the worker exits once it reads the end of its input
+    close(worker.fd);
+    int status;
+    while(waitpid(worker.pid, &status, 0) == -1 && errno == EINTR);
+    worker.pid = -1;
+    worker.fd = -1;
+  }
+
+  void stop_workers() {
+    for (auto& worker : workers) {
+      stop_worker(worker);
+    }
+    workers.clear();
+  }
+
+  pressio_compressor compressor = compressor_plugins().build("noop");
+  std::string compressor_id = "noop";
+  uint32_t nprocs = 1;
+  uint64_t group_size = 1;
+  std::vector<pool_worker> workers;
+  pressio_options metrics_results;
+};
+
+static pressio_register compressor_process_pool_plugin(compressor_plugins(), "process_pool", []() {
+  return compat::make_unique<process_pool_compressor_plugin>();
+});
@@ -1,3 +1,4 @@
+#include <atomic>
 #include <algorithm>
 #include <iterator>
 #include <memory>
@@ -12,6 +13,7 @@
 #include "libpressio_ext/cpp/data.h"
 #include "libpressio_ext/cpp/compressor.h"
 #include "libpressio_ext/cpp/pressio.h"
+#include "libpressio_ext/cpp/startup.h"
 #include "libpressio_ext/cpp/options.h"
 #include "std_compat/std_compat.h"
 #include "pressio_data.h"
@@ -58,7 +60,15 @@ class sz_plugin: public libpressio_compressor_plugin {
     std::stringstream ss;
     ss << sz_plugin::major_version() << "." << sz_plugin::minor_version() << "." << sz_plugin::patch_version() << "." << revision_version();
     sz_version = ss.str();
-    SZ_Init(NULL);
+    //every instance initializes SZ, but only the first initialization is a startup cost
+    static std::atomic<bool> first_init{true};
+    if(first_init.exchange(false)) {
+      pressio_startup_timer timer("init:SZ_Init");
+      SZ_Init(NULL);
+    } else {
+      SZ_Init(NULL);
+    }
+    track_option_changes();
   };
   ~sz_plugin() {
     SZ_Finalize();
@@ -115,7 +125,8 @@ class sz_plugin: public libpressio_compressor_plugin {
     set(options, "sz:abs_err_bound", "the absolute error bound ");
     set(options, "sz:accelerate_pw_rel_compression", "trade compression ratio for a faster pw_rel compression");
     set(options, "sz:app", "access a application specific mode of SZ");
-    set(options, "sz:config_file", "filepath passed to SZ_Init()");
+    set(options, "sz:config_file", R"(filepath passed to SZ_Init(); the file is only read when the path differs from
+      the one in use, so setting the same path again keeps parameters changed since it was read)");
     set(options, "sz:config_struct", "structure passed to SZ_Init_Params()" );
     set(options, "sz:data_type", "an internal option to control compression");
     set(options, "sz:error_bound_mode", "integer code used to determine error bound mode");
@@ -151,7 +162,8 @@ class sz_plugin: public libpressio_compressor_plugin {
 
   struct pressio_options get_options_impl() const override {
     struct pressio_options options;
-    set_type(options, "sz:config_file", pressio_option_charptr_type);
+    if(config_file.empty()) set_type(options, "sz:config_file", pressio_option_charptr_type);
+    else set(options, "sz:config_file", config_file);
     set_type(options, "sz:config_struct", pressio_option_userptr_type);
 #if PRESSIO_SZ_VERSION_GREATEREQ(2,1,9,0)
     set(options, "sz:protect_value_range", confparams_cpr->protectValueRange);
@@ -197,13 +209,18 @@ class sz_plugin: public libpressio_compressor_plugin {
   int set_options_impl(struct pressio_options const& options) override {
 
     struct sz_params* sz_param;
-    std::string config_file;
-    if(get(options, "sz:config_file", &config_file) == pressio_options_key_set) {
-      SZ_Finalize();
-      SZ_Init(config_file.c_str());
+    std::string new_config_file;
+    if(get(options, "sz:config_file", &new_config_file) == pressio_options_key_set) {
+      //re-reading the configuration file resets every parameter, so only do it when it changes
+      if(option_changed("sz:config_file")) {
+        SZ_Finalize();
+        SZ_Init(new_config_file.c_str());
+        config_file = std::move(new_config_file);
+      }
     } else if (get(options, "sz:config_struct", (void**)&sz_param) == pressio_options_key_set) {
       SZ_Finalize();
       SZ_Init_Params(sz_param);
+      config_file.clear();
     }
 
 #if PRESSIO_SZ_VERSION_GREATEREQ(2,1,9,0)
@@ -396,6 +413,7 @@ class sz_plugin: public libpressio_compressor_plugin {
   }
   std::string sz_version;
   std::string app = "SZ";
+  std::string config_file;
   void* user_params = nullptr;
 #if PRESSIO_SZ_VERSION_GREATEREQ(2,1,11,1)
   pressio_data exafel_peaks_segs;
@@ -0,0 +1,407 @@
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "pressio_data.h"
+#include "pressio_compressor.h"
+#include "libpressio_ext/cpp/pressio.h"
+#include "libpressio_ext/cpp/options.h"
+#include "libpressio_ext/cpp/data.h"
+#include "libpressio_ext/cpp/io.h"
+#include "std_compat/memory.h"
+#include "pressio_posix.h"
+
+/*
+ * a container file is a sequence of records, one per call to write:
+ *
+ *   [field bytes][index entry][footer]
+ *
+ * the footer has a fixed size and records the size of the index entry before it, and the index entry
+ * records the offset of the field bytes before it.  The start of the field bytes is the end of the
+ * previous record, so the whole index can be recovered by walking backwards from the end of the file.
+ * Existing bytes are never modified, so appending a field never invalidates earlier fields.
+ *
+ * like the numpy and posix plugins, integers are stored in the native byte order
+ */
+namespace container {
+  const char magic[8] = {'P','R','E','S','S','I','O','C'};
+  const uint32_t format_version = 1;
+
+  struct footer {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t entry_size;
+  };
+
+  struct entry {
+    uint64_t offset;
+    uint64_t size;
+    int32_t dtype;
+    std::vector<size_t> dims;
+    std::string compressor_id;
+    std::string compressor_config;
+  };
+
+  struct mapping {
+    void* base;
+    size_t length;
+  };
+
+  void unmap(void*, void* metadata_ptr) {
+    auto metadata = reinterpret_cast<mapping*>(metadata_ptr);
+    munmap(metadata->base, metadata->length);
+    delete metadata;
+  }
+
+  class encoder {
+    public:
+    template <class T>
+    void put(T const& value) {
+      buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    void put(std::string const& value) {
+      put<uint64_t>(value.size());
+      buffer.append(value);
+    }
+    std::string buffer;
+  };
+
+  class decoder {
+    public:
+    decoder(const char* begin, const char* end): pos(begin), end(end) {}
+
+    template <class T>
+    bool get(T& value) {
+      if(static_cast<size_t>(end - pos) < sizeof(T)) return false;
+      memcpy(&value, pos, sizeof(T));
+      pos += sizeof(T);
+      return true;
+    }
+    bool get(std::string& value) {
+      uint64_t size;
+      if(!get(size) || static_cast<uint64_t>(end - pos) < size) return false;
+      value.assign(pos, size);
+      pos += size;
+      return true;
+    }
+    bool done() const { return pos == end; }
+
+    private:
+    const char* pos;
+    const char* end;
+  };
+
+  std::string encode(std::string const& name, entry const& e) {
+    encoder enc;
+    enc.put(name);
+    enc.put(e.offset);
+    enc.put(e.size);
+    enc.put(e.dtype);
+    enc.put<uint64_t>(e.dims.size());
+    for (auto dim : e.dims) {
+      enc.put<uint64_t>(dim);
+    }
+    enc.put(e.compressor_id);
+    enc.put(e.compressor_config);
+
+    footer f{};
+    memcpy(f.magic, magic, sizeof(magic));
+    f.version = format_version;
+    f.entry_size = enc.buffer.size();
+    enc.put(f);
+    return std::move(enc.buffer);
+  }
+
+  bool decode(const char* begin, const char* end, std::string& name, entry& e) {
+    decoder dec(begin, end);
+    uint64_t ndims;
+    if(!dec.get(name) || !dec.get(e.offset) || !dec.get(e.size) || !dec.get(e.dtype) || !dec.get(ndims)) {
+      return false;
+    }
+    if(ndims > static_cast<uint64_t>(end - begin) / sizeof(uint64_t)) return false;
+    e.dims.resize(ndims);
+    for (auto& dim : e.dims) {
+      uint64_t tmp;
+      if(!dec.get(tmp)) return false;
+      dim = tmp;
+    }
+    return dec.get(e.compressor_id) && dec.get(e.compressor_config) && dec.done();
+  }
+
+  bool pread_all(int fd, void* buffer, size_t size, uint64_t offset) {
+    char* ptr = static_cast<char*>(buffer);
+    while(size > 0) {
+      ssize_t n = pread(fd, ptr, size, offset);
+      if(n == -1 && errno == EINTR) continue;
+      if(n <= 0) return false;
+      ptr += n; size -= n; offset += n;
+    }
+    return true;
+  }
+
+  bool pwrite_all(int fd, const void* buffer, size_t size, uint64_t offset) {
+    const char* ptr = static_cast<const char*>(buffer);
+    while(size > 0) {
+      ssize_t n = pwrite(fd, ptr, size, offset);
+      if(n == -1 && errno == EINTR) continue;
+      if(n <= 0) return false;
+      ptr += n; size -= n; offset += n;
+    }
+    return true;
+  }
+}
+
+struct container_io : public libpressio_io_plugin {
+  virtual struct pressio_data* read_impl(struct pressio_data* data) override {
+    if(!path) {
+      set_error(1, "io:path is required");
+      return nullptr;
+    }
+    int fd = open(path->c_str(), O_RDONLY);
+    if(fd == -1) {
+      set_error(2, errno_to_error() + " " + *path);
+      return nullptr;
+    }
+    pressio_data* ret = nullptr;
+    if(update_index(fd) == 0) {
+      auto it = index.find(field);
+      if(it == index.end()) {
+        set_error(4, "field not found: " + field);
+      } else {
+        ret = map_field(fd, it->second, data);
+      }
+    }
+    close(fd);
+    return ret;
+  }
+
+  virtual int write_impl(struct pressio_data const* data) override{
+    if(!path) {
+      return set_error(1, "io:path is required");
+    }
+    int fd = open(path->c_str(), O_RDWR | O_CREAT, 0644);
+    if(fd == -1) {
+      return set_error(2, errno_to_error() + " " + *path);
+    }
+    int rc = update_index(fd);
+    if(rc == 0) {
+      container::entry e;
+      e.offset = indexed_size;
+      e.size = data->size_in_bytes();
+      e.dtype = (dtype) ? *dtype : data->dtype();
+      e.dims = (dims) ? *dims : data->dimensions();
+      e.compressor_id = compressor_id;
+      e.compressor_config = compressor_config;
+      const std::string record = container::encode(field, e);
+
+      if(!container::pwrite_all(fd, data->data(), e.size, e.offset) ||
+         !container::pwrite_all(fd, record.data(), record.size(), e.offset + e.size)) {
+        rc = set_error(2, errno_to_error() + " " + *path);
+      } else {
+        index[field] = std::move(e);
+        indexed_size += data->size_in_bytes() + record.size();
+      }
+    }
+    close(fd);
+    return rc;
+  }
+
+  virtual struct pressio_options get_configuration_impl() const override{
+    pressio_options opts;
+    set(opts, "pressio:thread_safe",  static_cast<int32_t>(pressio_thread_safety_single));
+    set(opts, "pressio:stability", "experimental");
+    return opts;
+  }
+
+  virtual int set_options_impl(struct pressio_options const& options) override{
+    std::string tmp_path;
+    if(get(options, "io:path", &tmp_path) == pressio_options_key_set) {
+      path = tmp_path;
+    }
+    get(options, "container:field", &field);
+    get(options, "container:compressor_id", &compressor_id);
+    get(options, "container:compressor_config", &compressor_config);
+    int32_t tmp_dtype;
+    if(get(options, "container:dtype", &tmp_dtype) == pressio_options_key_set) {
+      dtype = static_cast<pressio_dtype>(tmp_dtype);
+    }
+    pressio_data tmp_dims;
+    if(get(options, "container:dims", &tmp_dims) == pressio_options_key_set) {
+      dims = tmp_dims.to_vector<size_t>();
+    }
+    return 0;
+  }
+
+  virtual struct pressio_options get_options_impl() const override{
+    pressio_options opts;
+    if(path) set(opts, "io:path", *path);
+    else set_type(opts, "io:path", pressio_option_charptr_type);
+    set(opts, "container:field", field);
+    set(opts, "container:compressor_id", compressor_id);
+    set(opts, "container:compressor_config", compressor_config);
+    if(dtype) set(opts, "container:dtype", static_cast<int32_t>(*dtype));
+    else set_type(opts, "container:dtype", pressio_option_int32_type);
+    if(dims) set(opts, "container:dims", pressio_data(dims->begin(), dims->end()));
+    else set_type(opts, "container:dims", pressio_option_data_type);
+    if(last_read) {
+      set(opts, "container:read_compressor_id", last_read->compressor_id);
+      set(opts, "container:read_compressor_config", last_read->compressor_config);
+      set(opts, "container:read_dtype", last_read->dtype);
+      set(opts, "container:read_dims", pressio_data(last_read->dims.begin(), last_read->dims.end()));
+    } else {
+      set_type(opts, "container:read_compressor_id", pressio_option_charptr_type);
+      set_type(opts, "container:read_compressor_config", pressio_option_charptr_type);
+      set_type(opts, "container:read_dtype", pressio_option_int32_type);
+      set_type(opts, "container:read_dims", pressio_option_data_type);
+    }
+    return opts;
+  }
+
+  virtual struct pressio_options get_documentation_impl() const override{
+    pressio_options opts;
+    set(opts, "pressio:description", R"(stores many named fields in a single self-describing file.
+
+    each write appends the buffer as the field container:field followed by an index entry recording its
+    offset, size, dtype, dimensions, and the compressor used to produce it.  reads map only the requested field.
+    If container:compressor_id is set, the field is returned as a byte buffer holding the compressed stream;
+    otherwise it is returned with the recorded dtype and dimensions.  After a read, the container:read_*
+    options report the metadata recorded for the field that was read; reads do not change the options used
+    for writes.  container:compressor_id, container:compressor_config, container:dtype, and container:dims apply
+    to every write until they are set again.)");
+    set(opts, "io:path", "path to the container file on disk");
+    set(opts, "container:field", "the name of the field to read or write");
+    set(opts, "container:compressor_id", "the id of the compressor used to produce the field, empty if the field is not compressed");
+    set(opts, "container:compressor_config", "the configuration of the compressor used to produce the field, typically from pressio_options_to_json");
+    set(opts, "container:dtype", "the dtype of the decompressed field; defaults to the dtype of the buffer written");
+    set(opts, "container:dims", "the dimensions of the decompressed field; defaults to the dimensions of the buffer written");
+    set(opts, "container:read_compressor_id", "the compressor id recorded for the field last read");
+    set(opts, "container:read_compressor_config", "the compressor configuration recorded for the field last read");
+    set(opts, "container:read_dtype", "the dtype recorded for the field last read");
+    set(opts, "container:read_dims", "the dimensions recorded for the field last read");
+    return opts;
+  }
+
+  int patch_version() const override{
+    return 1;
+  }
+  virtual const char* version() const override{
+    return "0.0.1";
+  }
+  const char* prefix() const override {
+    return "container";
+  }
+
+  std::shared_ptr<libpressio_io_plugin> clone() override {
+    return compat::make_unique<container_io>(*this);
+  }
+
+  private:
+  /**
+   * brings the in-memory index up to date with the file, reading only the records appended
+   * since the file was last indexed
+   */
+  int update_index(int fd) {
+    struct stat statbuf = {};
+    if(fstat(fd, &statbuf) == -1) {
+      return set_error(2, errno_to_error());
+    }
+    const uint64_t file_size = static_cast<uint64_t>(statbuf.st_size);
+    if(*path != indexed_path || statbuf.st_ino != indexed_inode || file_size < indexed_size) {
+      index.clear();
+      indexed_path = *path;
+      indexed_inode = statbuf.st_ino;
+      indexed_size = 0;
+    }
+
+    //records are visited newest first, so the first one seen for each name wins
+    std::unordered_map<std::string, container::entry> newer;
+    uint64_t pos = file_size;
+    std::vector<char> buffer;
+    while(pos > indexed_size) {
+      container::footer f;
+      if(pos - indexed_size < sizeof(f) || !container::pread_all(fd, &f, sizeof(f), pos - sizeof(f)) ||
+          memcmp(f.magic, container::magic, sizeof(container::magic)) != 0) {
+        return set_error(3, "not a container file: " + *path);
+      }
+      if(f.version != container::format_version) {
+        return set_error(3, "unsupported container version: " + std::to_string(f.version));
+      }
+      const uint64_t entry_end = pos - sizeof(f);
+      if(f.entry_size > entry_end - indexed_size) {
+        return set_error(3, "corrupt container index: " + *path);
+      }
+      const uint64_t data_end = entry_end - f.entry_size;
+      buffer.resize(f.entry_size);
+      std::string name;
+      container::entry e;
+      if(!container::pread_all(fd, buffer.data(), buffer.size(), data_end) ||
+          !container::decode(buffer.data(), buffer.data() + buffer.size(), name, e) ||
+          e.offset < indexed_size || e.offset > data_end || e.size != data_end - e.offset) {
+        return set_error(3, "corrupt container index: " + *path);
+      }
+      pos = e.offset;
+      newer.emplace(std::move(name), std::move(e));
+    }
+
+    for (auto& field_entry : newer) {
+      index[field_entry.first] = std::move(field_entry.second);
+    }
+    indexed_size = file_size;
+    return 0;
+  }
+
+  pressio_data* map_field(int fd, container::entry const& e, pressio_data const* data) {
+    last_read = e;
+
+    pressio_dtype out_dtype;
+    std::vector<size_t> out_dims;
+    if(data != nullptr && data->num_dimensions() != 0 && data->size_in_bytes() == e.size) {
+      out_dtype = data->dtype();
+      out_dims = data->dimensions();
+    } else if (e.compressor_id.empty()) {
+      out_dtype = static_cast<pressio_dtype>(e.dtype);
+      out_dims = e.dims;
+    } else {
+      out_dtype = pressio_byte_dtype;
+      out_dims = {e.size};
+    }
+    if(e.size == 0) {
+      return new pressio_data(pressio_data::owning(out_dtype, out_dims));
+    }
+
+    //mappings must start on a page boundary
+    const uint64_t page_size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    const uint64_t map_offset = e.offset - (e.offset % page_size);
+    auto metadata = compat::make_unique<container::mapping>();
+    metadata->length = e.size + (e.offset - map_offset);
+    //a private writable mapping is copy-on-write, so callers may modify the buffer without changing the file
+    metadata->base = mmap(nullptr, metadata->length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, map_offset);
+    if(metadata->base == MAP_FAILED) {
+      set_error(5, "mapping failed: " + errno_to_error());
+      return nullptr;
+    }
+    void* field_ptr = static_cast<char*>(metadata->base) + (e.offset - map_offset);
+    return new pressio_data(pressio_data::move(out_dtype, field_ptr, out_dims, container::unmap, metadata.release()));
+  }
+
+  compat::optional<std::string> path;
+  std::string field = "data";
+  std::string compressor_id;
+  std::string compressor_config;
+  compat::optional<pressio_dtype> dtype;
+  compat::optional<std::vector<size_t>> dims;
+  compat::optional<container::entry> last_read;
+
+  std::unordered_map<std::string, container::entry> index;
+  std::string indexed_path;
+  ino_t indexed_inode = 0;
+  uint64_t indexed_size = 0;
+};
+
+static pressio_register io_container_plugin(io_plugins(), "container", [](){ return compat::make_unique<container_io>(); });
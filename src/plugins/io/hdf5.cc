@@ -13,6 +13,7 @@
 #endif
 
 #include "pressio_posix.h"
+#include <algorithm>
 #include <cstring>
 #include <sys/types.h>
 #include <unistd.h>
@@ -20,6 +21,7 @@
 #include <pressio_data.h>
 #include <cassert>
 #include <vector>
+#include <memory>
 #include <string>
 #include <pressio_compressor.h>
 #include <std_compat/std_compat.h>
@@ -158,6 +160,14 @@ pressio_io_data_path_h5write(struct pressio_data const* data, const char* file_n
 
 struct hdf5_io: public libpressio_io_plugin {
   virtual struct pressio_data* read_impl(struct pressio_data* buffer) override {
+    return read_hyperslab(buffer, file_start, file_count, file_stride, file_block);
+  }
+
+  virtual struct pressio_data* read_region_impl(struct pressio_data*,
+      std::vector<size_t> const& start,
+      std::vector<size_t> const& stride,
+      std::vector<size_t> const& count,
+      std::vector<size_t> const& block) override {
     cleanup cleanup_facl;
     hid_t fapl_plist = H5P_DEFAULT;
 #if defined(H5_HAVE_PARALLEL) && H5_HAVE_PARALLEL
@@ -188,44 +198,28 @@ struct hdf5_io: public libpressio_io_plugin {
       return nullptr;
     }
     auto cleanup_dataspace = make_cleanup([&]{ H5Sclose(filespace); });
-    int ndims = H5Sget_simple_extent_ndims(filespace);
-    std::vector<hsize_t> read_file_extent(ndims);
-    H5Sget_simple_extent_dims(filespace, read_file_extent.data(), nullptr);
-
-
-    if(should_prepare_read()) {
-      if(not prepare_filespace(filespace)) {
+    const int ndims = H5Sget_simple_extent_ndims(filespace);
+    std::vector<hsize_t> file_extent_read(ndims);
+    H5Sget_simple_extent_dims(filespace, file_extent_read.data(), nullptr);
+
+    //the dimensions of what read returns, the configured hyperslab or the whole dataset
+    const bool configured = should_prepare(file_start, file_count, file_stride, file_block);
+    auto configured_or = [](std::vector<hsize_t> const& v, int i, hsize_t fallback) {
+      return v.empty() ? fallback : v[i];
+    };
+    for (auto const* v : {&file_start, &file_count, &file_stride, &file_block}) {
+      if(configured && !v->empty() && v->size() != static_cast<size_t>(ndims)) {
         set_error(6, "invalid hyperslab selection");
         return nullptr;
       }
     }
-
-    //convert to size_t from hsize_t
-    std::vector<size_t> pressio_size(ndims);
-    switch(H5Sget_select_type(filespace)) {
-      case H5S_SEL_HYPERSLABS:
-        if(H5Sis_regular_hyperslab(filespace) > 0) {
-          std::vector<hsize_t> start(ndims), count(ndims), stride(ndims), block(ndims);
-          H5Sget_regular_hyperslab(filespace,
-              start.data(), stride.data(), count.data(), block.data());
-          for (int i = 0; i < ndims; ++i) {
-            pressio_size[i] = count[i] * block[i];
-          }
-        } else {
-          //TODO support non regular hyperslabs
-          set_error(7, "non-regular hyperslabs are not supported");
-          return nullptr;
-        }
-        break;
-      case H5S_SEL_ALL:
-        //when the selection is all points, use the extents
-        H5Sget_simple_extent_dims(filespace, read_file_extent.data(), nullptr);
-        std::copy(std::begin(read_file_extent), std::end(read_file_extent), std::begin(pressio_size));
-        break;
-      default:
-        set_error(8, "other selection types are not supported");
-        return nullptr;
-
+    std::vector<size_t> read_dims(ndims);
+    for (int i = 0; i < ndims; ++i) {
+      read_dims[i] = (configured) ? configured_or(file_count, i, 1) * configured_or(file_block, i, 1) : file_extent_read[i];
+    }
+    if(not pressio_region_valid(read_dims, start, stride, count, block)) {
+      set_error(6, "invalid hyperslab selection");
+      return nullptr;
     }
 
     hid_t type = H5Dget_type(dataset);
@@ -234,46 +228,82 @@ struct hdf5_io: public libpressio_io_plugin {
       return nullptr;
     }
     auto cleanup_type = make_cleanup([&]{ H5Tclose(type);}) ;
+    auto dtype = h5t_to_pressio(type);
+    if(!dtype) {
+      set_error(5, "unknown datatype");
+      return nullptr;
+    }
 
-    {
-      auto dtype = h5t_to_pressio(type);
-      if(dtype) {
-        pressio_data* ret;
-        if(buffer == nullptr) {
-          ret = pressio_data_new_owning(*dtype, pressio_size.size(), pressio_size.data());
-        } else {
-          ret = pressio_data_new_empty(pressio_byte_dtype, 0, nullptr);
-          *ret = std::move(*buffer);
+    hid_t dxpl_plist = H5P_DEFAULT;
+    cleanup dxpl_cleanup;
+#if defined(H5_HAVE_PARALLEL) && H5_HAVE_PARALLEL
+    if(use_parallel) {
+      dxpl_plist = H5Pcreate(H5P_DATASET_XFER);
+      dxpl_cleanup = make_cleanup([&]{ H5Pclose(dxpl_plist);});
+      H5Pset_dxpl_mpio(dxpl_plist, H5FD_MPIO_COLLECTIVE);
+    }
+#endif
+
+    //like any pressio_data, the region indexes what read returns with the first dimension fastest while
+    //HDF5 stores the last dimension fastest, so the region is generally not a hyperslab of the file.
+    //Instead each selected element is converted to its coordinates in the file and HDF5 reads only
+    //those points, in batches to bound the memory used for the coordinates
+    std::vector<size_t> region_dims(ndims);
+    for (int i = 0; i < ndims; ++i) {
+      region_dims[i] = count[i] * block[i];
+    }
+    std::unique_ptr<pressio_data> ret(new pressio_data(pressio_data::owning(*dtype, region_dims)));
+    const size_t total = ret->num_elements();
+    const size_t element_size = pressio_dtype_size(*dtype);
+    const size_t batch_size = 1 << 16;
+    std::vector<hsize_t> coords;
+    std::vector<size_t> index(ndims, 0), point(ndims);
+    for (size_t done = 0; done < total;) {
+      const size_t points = std::min(batch_size, total - done);
+      coords.resize(points * ndims);
+      for (size_t p = 0; p < points; ++p) {
+        //the linear position in what read returns of the next element of the region
+        size_t linear = 0, step = 1;
+        for (int i = 0; i < ndims; ++i) {
+          linear += (start[i] + (index[i] / block[i]) * stride[i] + (index[i] % block[i])) * step;
+          step *= read_dims[i];
         }
-        auto ptr = pressio_data_ptr(ret, nullptr);
-        std::vector<hsize_t> memextents(std::begin(pressio_size), std::end(pressio_size));
-        hid_t memspace = H5Screate_simple(ndims,  memextents.data(), nullptr);
-        if(memspace < 0) {
-          set_error(9, "failed to create memspace");
-          return nullptr;
+        //its position in HDF5 order, then in the file
+        for (int i = ndims - 1; i >= 0; --i) {
+          point[i] = linear % read_dims[i];
+          linear /= read_dims[i];
         }
-        auto memspace_cleanup = make_cleanup([&]{ H5Sclose(memspace); });
-
-        hid_t dxpl_plist = H5P_DEFAULT;
-        cleanup dxpl_cleanup;
-#if defined(H5_HAVE_PARALLEL) && H5_HAVE_PARALLEL
-        if(use_parallel) {
-          hid_t dxpl_plist = H5Pcreate(H5P_DATASET_XFER);
-          dxpl_cleanup = make_cleanup([&]{ H5Pclose(dxpl_plist);});
-          H5Pset_dxpl_mpio(dxpl_plist, H5FD_MPIO_COLLECTIVE);
+        for (int i = 0; i < ndims; ++i) {
+          hsize_t coord = point[i];
+          if(configured) {
+            const hsize_t point_block = configured_or(file_block, i, 1);
+            coord = configured_or(file_start, i, 0) + (coord / point_block) * configured_or(file_stride, i, 1) + coord % point_block;
+          }
+          coords[p * ndims + i] = coord;
         }
-#endif
-        if(H5Dread(dataset, type, memspace, filespace, dxpl_plist, ptr) < 0) {
-          set_error(10, "read failed");
-          return nullptr;
+        for (int i = 0; i < ndims && ++index[i] == region_dims[i]; ++i) {
+          index[i] = 0;
         }
+      }
 
-        return ret;
-      } else {
-        set_error(5, "unknown datatype");
+      if(H5Sselect_elements(filespace, H5S_SELECT_SET, points, coords.data()) < 0) {
+        set_error(6, "invalid hyperslab selection");
         return nullptr;
       }
+      const hsize_t memextent = points;
+      hid_t memspace = H5Screate_simple(1, &memextent, nullptr);
+      if(memspace < 0) {
+        set_error(9, "failed to create memspace");
+        return nullptr;
+      }
+      auto memspace_cleanup = make_cleanup([&]{ H5Sclose(memspace); });
+      if(H5Dread(dataset, type, memspace, filespace, dxpl_plist, static_cast<char*>(ret->data()) + done * element_size) < 0) {
+        set_error(10, "read failed");
+        return nullptr;
+      }
+      done += points;
     }
+    return ret.release();
   }
 
   virtual int write_impl(struct pressio_data const* data) override{
@@ -360,8 +390,8 @@ struct hdf5_io: public libpressio_io_plugin {
       return set_error(5, "failed to get file dataspace");
     }
     auto cleanup_filespace = make_cleanup([&]{H5Sclose(filespace);});
-    if(should_prepare_write()) {
-      if(not prepare_filespace(filespace)) {
+    if(should_prepare(file_start, file_count, file_stride, file_block)) {
+      if(not prepare_filespace(filespace, file_start, file_count, file_stride, file_block)) {
         return set_error(6, "invalid hyperslab selection");
       }
     }
@@ -495,39 +525,165 @@ struct hdf5_io: public libpressio_io_plugin {
 
   private:
 
-  bool should_prepare_read() const {
-    if(file_start.empty() && file_block.empty() && file_count.empty() && file_stride.empty()) return false;
-    else return true;
+  struct pressio_data* read_hyperslab(struct pressio_data* buffer,
+      std::vector<hsize_t> const& start,
+      std::vector<hsize_t> const& count,
+      std::vector<hsize_t> const& stride,
+      std::vector<hsize_t> const& block) {
+    cleanup cleanup_facl;
+    hid_t fapl_plist = H5P_DEFAULT;
+#if defined(H5_HAVE_PARALLEL) && H5_HAVE_PARALLEL
+    if(use_parallel) {
+      fapl_plist = H5Pcreate(H5P_FILE_ACCESS);
+      MPI_Info info = MPI_INFO_NULL;
+      H5Pset_fapl_mpio(fapl_plist, comm, info);
+      cleanup_facl = make_cleanup([&]{H5Pclose(fapl_plist);});
+    }
+#endif
+    hid_t file = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, fapl_plist);
+    if(file < 0) {
+      set_error(1, "failed to open file " + filename);
+      return nullptr;
+    }
+    auto cleanup_file = make_cleanup([&]{ H5Fclose(file); });
+
+    hid_t dataset = H5Dopen2(file, dataset_name.c_str(), H5P_DEFAULT);
+    if(dataset < 0) {
+      set_error(2, "failed to open dataset" + dataset_name);
+      return nullptr;
+    }
+    auto cleanup_dataset = make_cleanup([&]{ H5Dclose(dataset); });
+
+    hid_t filespace = H5Dget_space(dataset);
+    if(filespace < 0) {
+      set_error(3, "failed to get dataspace from file");
+      return nullptr;
+    }
+    auto cleanup_dataspace = make_cleanup([&]{ H5Sclose(filespace); });
+    int ndims = H5Sget_simple_extent_ndims(filespace);
+    std::vector<hsize_t> read_file_extent(ndims);
+    H5Sget_simple_extent_dims(filespace, read_file_extent.data(), nullptr);
+
+
+    if(should_prepare(start, count, stride, block)) {
+      if(not prepare_filespace(filespace, start, count, stride, block)) {
+        set_error(6, "invalid hyperslab selection");
+        return nullptr;
+      }
+    }
+
+    //convert to size_t from hsize_t
+    std::vector<size_t> pressio_size(ndims);
+    switch(H5Sget_select_type(filespace)) {
+      case H5S_SEL_HYPERSLABS:
+        if(H5Sis_regular_hyperslab(filespace) > 0) {
+          std::vector<hsize_t> start(ndims), count(ndims), stride(ndims), block(ndims);
+          H5Sget_regular_hyperslab(filespace,
+              start.data(), stride.data(), count.data(), block.data());
+          for (int i = 0; i < ndims; ++i) {
+            pressio_size[i] = count[i] * block[i];
+          }
+        } else {
+          //TODO support non regular hyperslabs
+          set_error(7, "non-regular hyperslabs are not supported");
+          return nullptr;
+        }
+        break;
+      case H5S_SEL_ALL:
+        //when the selection is all points, use the extents
+        H5Sget_simple_extent_dims(filespace, read_file_extent.data(), nullptr);
+        std::copy(std::begin(read_file_extent), std::end(read_file_extent), std::begin(pressio_size));
+        break;
+      default:
+        set_error(8, "other selection types are not supported");
+        return nullptr;
+
+    }
+
+    hid_t type = H5Dget_type(dataset);
+    if(type < 0) {
+      set_error(4, "failed to get datatype");
+      return nullptr;
+    }
+    auto cleanup_type = make_cleanup([&]{ H5Tclose(type);}) ;
+
+    {
+      auto dtype = h5t_to_pressio(type);
+      if(dtype) {
+        pressio_data* ret;
+        if(buffer == nullptr) {
+          ret = pressio_data_new_owning(*dtype, pressio_size.size(), pressio_size.data());
+        } else {
+          ret = pressio_data_new_empty(pressio_byte_dtype, 0, nullptr);
+          *ret = std::move(*buffer);
+        }
+        auto ptr = pressio_data_ptr(ret, nullptr);
+        std::vector<hsize_t> memextents(std::begin(pressio_size), std::end(pressio_size));
+        hid_t memspace = H5Screate_simple(ndims,  memextents.data(), nullptr);
+        if(memspace < 0) {
+          set_error(9, "failed to create memspace");
+          return nullptr;
+        }
+        auto memspace_cleanup = make_cleanup([&]{ H5Sclose(memspace); });
+
+        hid_t dxpl_plist = H5P_DEFAULT;
+        cleanup dxpl_cleanup;
+#if defined(H5_HAVE_PARALLEL) && H5_HAVE_PARALLEL
+        if(use_parallel) {
+          hid_t dxpl_plist = H5Pcreate(H5P_DATASET_XFER);
+          dxpl_cleanup = make_cleanup([&]{ H5Pclose(dxpl_plist);});
+          H5Pset_dxpl_mpio(dxpl_plist, H5FD_MPIO_COLLECTIVE);
+        }
+#endif
+        if(H5Dread(dataset, type, memspace, filespace, dxpl_plist, ptr) < 0) {
+          set_error(10, "read failed");
+          return nullptr;
+        }
+
+        return ret;
+      } else {
+        set_error(5, "unknown datatype");
+        return nullptr;
+      }
+    }
   }
-  bool should_prepare_write() const {
-    if(file_start.empty() && file_block.empty() && file_count.empty() && file_stride.empty()) return false;
+
+  static bool should_prepare(std::vector<hsize_t> const& start,
+      std::vector<hsize_t> const& count,
+      std::vector<hsize_t> const& stride,
+      std::vector<hsize_t> const& block) {
+    if(start.empty() && block.empty() && count.empty() && stride.empty()) return false;
     else return true;
   }
-  bool prepare_filespace(hid_t filespace) const {
+  static bool prepare_filespace(hid_t filespace,
+      std::vector<hsize_t> const& start,
+      std::vector<hsize_t> const& count,
+      std::vector<hsize_t> const& stride,
+      std::vector<hsize_t> const& block) {
       const int ndims = H5Sget_simple_extent_ndims(filespace);
 
       std::vector<hsize_t> read_start;
-      if(file_start.empty()) {
+      if(start.empty()) {
         read_start = std::vector<hsize_t>(ndims, 0);
       } else {
-        read_start = file_start;
+        read_start = start;
       }
 
       std::vector<hsize_t> read_count;
-      if(file_count.empty()) {
+      if(count.empty()) {
         read_count = std::vector<hsize_t>(ndims, 1);
       } else {
-        read_count = file_count;
+        read_count = count;
       }
 
       hsize_t const* read_block = nullptr;
-      if(!file_block.empty()) {
-        read_block = file_block.data();
+      if(!block.empty()) {
+        read_block = block.data();
       }
 
       hsize_t const* read_stride = nullptr;
-      if(!file_stride.empty()) {
-        read_stride = file_stride.data();
+      if(!stride.empty()) {
+        read_stride = stride.data();
       }
 
       H5Sselect_hyperslab(
@@ -3,6 +3,7 @@
 #include <libpressio_ext/cpp/pressio.h>
 #include <libpressio_ext/cpp/options.h>
 #include <libpressio_ext/cpp/io.h>
+#include <libpressio_ext/cpp/data.h>
 
 pressio_registry<std::unique_ptr<libpressio_io_plugin>>& io_plugins() {
   static pressio_registry<std::unique_ptr<libpressio_io_plugin>> registry;
@@ -38,6 +39,26 @@ int pressio_io_check_options(struct pressio_io* io, struct pressio_options const
 struct pressio_data* pressio_io_read(struct pressio_io* io, struct pressio_data* data) {
   return (*io)->read(data);
 }
+struct pressio_data* pressio_io_read_region(struct pressio_io* io,
+    struct pressio_data* data,
+    size_t num_dims,
+    const size_t* start,
+    const size_t* stride,
+    const size_t* count,
+    const size_t* block) {
+  std::vector<size_t> ones(num_dims, 1);
+  std::vector<size_t> zeros(num_dims, 0);
+  if(start == nullptr) start = zeros.data();
+  if(stride == nullptr) stride = ones.data();
+  if(count == nullptr) count = ones.data();
+  if(block == nullptr) block = ones.data();
+  return (*io)->read_region(data,
+      std::vector<size_t>(start, start+num_dims),
+      std::vector<size_t>(stride, stride+num_dims),
+      std::vector<size_t>(count, count+num_dims),
+      std::vector<size_t>(block, block+num_dims)
+      );
+}
 int pressio_io_write(struct pressio_io* io, struct pressio_data const* data) {
   return (*io)->write(data);
 }
@@ -86,6 +107,14 @@ struct pressio_data* libpressio_io_plugin::read(struct pressio_data* data) {
   clear_error();
   return read_impl(data);
 }
+struct pressio_data* libpressio_io_plugin::read_region(struct pressio_data* data,
+    std::vector<size_t> const& start,
+    std::vector<size_t> const& stride,
+    std::vector<size_t> const& count,
+    std::vector<size_t> const& block) {
+  clear_error();
+  return read_region_impl(data, start, stride, count, block);
+}
 int libpressio_io_plugin::write(struct pressio_data const* data) {
   clear_error();
   return write_impl(data);
@@ -96,7 +125,8 @@ int libpressio_io_plugin::check_options(struct pressio_options const& options) {
 }
 int libpressio_io_plugin::set_options(struct pressio_options const& options) {
   clear_error();
-  return set_options_impl(options);
+  options_change_scope changed(*this, options);
+  return changed.finish(set_options_impl(options));
 }
 struct pressio_options libpressio_io_plugin::get_documentation() const {
   pressio_options opts;
@@ -111,6 +141,20 @@ struct pressio_options libpressio_io_plugin::get_configuration() const {
 struct pressio_options libpressio_io_plugin::get_options() const {
   return get_options_impl();
 }
+struct pressio_data* libpressio_io_plugin::read_region_impl(struct pressio_data* data,
+    std::vector<size_t> const& start,
+    std::vector<size_t> const& stride,
+    std::vector<size_t> const& count,
+    std::vector<size_t> const& block) {
+  std::unique_ptr<pressio_data> full(read_impl(data));
+  if(!full) return nullptr;
+  auto selected = full->select(start, stride, count, block);
+  if(!selected.has_data()) {
+    set_error(1, "invalid region selection");
+    return nullptr;
+  }
+  return new pressio_data(std::move(selected));
+}
 int libpressio_io_plugin::check_options_impl(struct pressio_options const&) {
   return 0;
 }
@@ -0,0 +1,305 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "pressio_data.h"
+#include "pressio_compressor.h"
+#include "libpressio_ext/cpp/pressio.h"
+#include "libpressio_ext/cpp/options.h"
+#include "libpressio_ext/cpp/data.h"
+#include "libpressio_ext/cpp/io.h"
+#include "std_compat/memory.h"
+
+namespace many_files {
+  /**
+   * the outcome of reading a single file
+   */
+  struct read_result {
+    pressio_data* data;
+    int error_code;
+    std::string error_msg;
+  };
+
+  /**
+   * reads a sequence of files on background threads, keeping at most depth files
+   * read ahead of the consumer so that reading overlaps with whatever the consumer does
+   * with each buffer (i.e. compression)
+   */
+  class read_queue {
+    public:
+    read_queue(std::vector<pressio_io>&& workers, std::vector<std::string> const& paths,
+        compat::optional<pressio_data> const& dims_template, size_t depth):
+      paths(paths), dims_template(dims_template), depth(depth)
+    {
+      for (auto& worker : workers) {
+        threads.emplace_back([this](pressio_io worker){ this->work(worker); }, std::move(worker));
+      }
+    }
+    read_queue(read_queue const&)=delete;
+    read_queue& operator=(read_queue const&)=delete;
+
+    ~read_queue() {
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        stop = true;
+      }
+      space_available.notify_all();
+      for (auto& thread : threads) {
+        thread.join();
+      }
+      for (auto& result : done) {
+        pressio_data_free(result.second.data);
+      }
+    }
+
+    /**
+     * \returns the result for the next file in the sequence, waiting for it to be read if needed
+     */
+    read_result next() {
+      std::unique_lock<std::mutex> guard(lock);
+      if(next_to_consume >= paths.size()) {
+        return read_result{nullptr, 1, "no more files to read"};
+      }
+      read_ready.wait(guard, [this]{ return done.find(next_to_consume) != done.end(); });
+      auto it = done.find(next_to_consume);
+      read_result result = std::move(it->second);
+      done.erase(it);
+      ++next_to_consume;
+      guard.unlock();
+      space_available.notify_all();
+      return result;
+    }
+
+    private:
+    void work(pressio_io& worker) {
+      while(true) {
+        size_t idx;
+        {
+          std::unique_lock<std::mutex> guard(lock);
+          space_available.wait(guard, [this]{
+              return stop || next_to_issue >= paths.size() || next_to_issue < next_to_consume + depth;
+          });
+          if(stop || next_to_issue >= paths.size()) return;
+          idx = next_to_issue++;
+        }
+
+        worker->set_options({{"io:path", paths[idx]}});
+        pressio_data* data = nullptr;
+        if(dims_template) {
+          auto dims = pressio_data::empty(dims_template->dtype(), dims_template->dimensions());
+          data = worker->read(&dims);
+        } else {
+          data = worker->read(nullptr);
+        }
+
+        {
+          std::lock_guard<std::mutex> guard(lock);
+          done.emplace(idx, read_result{data, worker->error_code(), worker->error_msg()});
+        }
+        read_ready.notify_all();
+      }
+    }
+
+    std::vector<std::string> const paths;
+    compat::optional<pressio_data> const dims_template;
+    size_t const depth;
+
+    std::mutex lock;
+    std::condition_variable space_available, read_ready;
+    size_t next_to_issue = 0;
+    size_t next_to_consume = 0;
+    bool stop = false;
+    std::map<size_t, read_result> done;
+    std::vector<std::thread> threads;
+  };
+}
+
+struct many_files_io : public libpressio_io_plugin {
+  many_files_io()=default;
+  many_files_io(many_files_io const& rhs):
+    libpressio_io_plugin(rhs),
+    impl_id(rhs.impl_id),
+    impl(rhs.impl),
+    paths(rhs.paths),
+    nthreads(rhs.nthreads),
+    queue_depth(rhs.queue_depth)
+  {}
+  many_files_io& operator=(many_files_io const&)=delete;
+
+  virtual struct pressio_data* read_impl(struct pressio_data* data) override {
+    if(!queue) {
+      compat::optional<pressio_data> dims_template;
+      if(data != nullptr && data->num_dimensions() != 0) {
+        dims_template = pressio_data::empty(data->dtype(), data->dimensions());
+      }
+      queue = compat::make_unique<many_files::read_queue>(make_workers(paths.size()), paths, dims_template, queue_depth);
+    }
+    auto result = queue->next();
+    if(result.data == nullptr) {
+      set_error(result.error_code, result.error_msg);
+    }
+    return result.data;
+  }
+
+  virtual int write_impl(struct pressio_data const* data) override{
+    //like read, write handles the paths one at a time in order
+    if(next_write >= paths.size()) {
+      return set_error(1, "no more files to write");
+    }
+    pressio_io worker(impl->clone());
+    worker->set_options({{"io:path", paths[next_write]}});
+    if(worker->write(data)) {
+      return set_error(worker->error_code(), paths[next_write] + ": " + worker->error_msg());
+    }
+    ++next_write;
+    return 0;
+  }
+
+  virtual int read_many_impl(compat::span<struct pressio_data*> const& data) override {
+    if(data.size() != paths.size()) {
+      return set_error(2, "the number of buffers must match the number of paths");
+    }
+    return for_each_file(data.size(), [&data](pressio_io& worker, size_t i) {
+        pressio_data* ret = worker->read(data[i]);
+        if(ret == nullptr) return (worker->error_code())? worker->error_code() : 1;
+        pressio_data_free(data[i]);
+        data[i] = ret;
+        return 0;
+    });
+  }
+
+  virtual int write_many_impl(compat::span<struct pressio_data const*> const& data) override {
+    if(data.size() != paths.size()) {
+      return set_error(2, "the number of buffers must match the number of paths");
+    }
+    return for_each_file(data.size(), [&data](pressio_io& worker, size_t i) {
+        return worker->write(data[i]);
+    });
+  }
+
+  virtual struct pressio_options get_configuration_impl() const override{
+    pressio_options opts;
+    set(opts, "pressio:stability", "experimental");
+    set(opts, "pressio:thread_safe",  static_cast<int32_t>(pressio_thread_safety_single));
+    return opts;
+  }
+
+  virtual int set_options_impl(struct pressio_options const& options) override{
+    get_meta(options, "many_files:io", io_plugins(), impl_id, impl);
+    get(options, "many_files:paths", &paths);
+    uint32_t tmp;
+    if(get(options, "many_files:nthreads", &tmp) == pressio_options_key_set) {
+      if(tmp < 1) return set_error(1, "invalid thread count");
+      nthreads = tmp;
+    }
+    if(get(options, "many_files:queue_depth", &tmp) == pressio_options_key_set) {
+      if(tmp < 1) return set_error(1, "invalid queue depth");
+      queue_depth = tmp;
+    }
+    //start the sequences of reads and writes over with the new configuration
+    queue.reset();
+    next_write = 0;
+    return 0;
+  }
+
+  virtual struct pressio_options get_options_impl() const override{
+    pressio_options opts;
+    set_meta(opts, "many_files:io", impl_id, impl);
+    set(opts, "many_files:paths", paths);
+    set(opts, "many_files:nthreads", nthreads);
+    set(opts, "many_files:queue_depth", queue_depth);
+    return opts;
+  }
+
+  virtual struct pressio_options get_documentation_impl() const override{
+    pressio_options opts;
+    set_meta_docs(opts, "many_files:io", "io module used to read or write each file", impl);
+    set(opts, "pressio:description", R"(reads or writes one buffer per file in parallel.
+
+    read_many and write_many process all of the paths at once using a pool of threads, each with its own clone of the child io module.
+    read returns the files one at a time in order while background threads read up to queue_depth files ahead;
+    if the first buffer passed to read has dimensions, they are used as the template for every file.
+    write likewise writes each buffer to the next path in order.  Setting options starts both sequences over.)");
+    set(opts, "many_files:paths", "the paths to read or write, one per buffer");
+    set(opts, "many_files:nthreads", "the number of threads used to read or write");
+    set(opts, "many_files:queue_depth", "the maximum number of files read ahead of calls to read");
+    return opts;
+  }
+
+  int patch_version() const override{
+    return 1;
+  }
+  virtual const char* version() const override{
+    return "0.0.1";
+  }
+  const char* prefix() const override {
+    return "many_files";
+  }
+
+  void set_name_impl(std::string const& new_name) override {
+    impl->set_name(new_name + "/" + impl->prefix());
+  }
+
+  std::shared_ptr<libpressio_io_plugin> clone() override {
+    return compat::make_unique<many_files_io>(*this);
+  }
+
+  private:
+  std::vector<pressio_io> make_workers(size_t num_files) const {
+    std::vector<pressio_io> workers;
+    const size_t num_workers = std::max<size_t>(1, std::min<size_t>(nthreads, num_files));
+    for (size_t i = 0; i < num_workers; ++i) {
+      workers.emplace_back(impl->clone());
+    }
+    return workers;
+  }
+
+  template <class Action>
+  int for_each_file(size_t num_files, Action&& action) {
+    auto workers = make_workers(num_files);
+    std::atomic<size_t> next_file{0};
+    std::mutex error_lock;
+    int status = 0;
+    std::string status_msg;
+
+    auto work = [&](pressio_io& worker) {
+      size_t i;
+      while((i = next_file++) < num_files) {
+        worker->set_options({{"io:path", paths[i]}});
+        int rc = action(worker, i);
+        if(rc) {
+          std::lock_guard<std::mutex> guard(error_lock);
+          if(status == 0) {
+            status = rc;
+            status_msg = paths[i] + ": " + worker->error_msg();
+          }
+        }
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < workers.size(); ++i) {
+      threads.emplace_back(work, std::ref(workers[i]));
+    }
+    work(workers.front());
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    if(status) return set_error(status, status_msg);
+    return 0;
+  }
+
+  std::string impl_id = "posix";
+  pressio_io impl = io_plugins().build("posix");
+  std::vector<std::string> paths;
+  uint32_t nthreads = 1;
+  uint32_t queue_depth = 2;
+  std::unique_ptr<many_files::read_queue> queue;
+  size_t next_write = 0;
+};
+
+static pressio_register io_many_files_plugin(io_plugins(), "many_files", [](){ return compat::make_unique<many_files_io>(); });
@@ -49,6 +49,24 @@ struct mmap_io : public libpressio_io_plugin {
     return nullptr;
   }
 
+  virtual struct pressio_data* read_region_impl(struct pressio_data* data,
+      std::vector<size_t> const& start,
+      std::vector<size_t> const& stride,
+      std::vector<size_t> const& count,
+      std::vector<size_t> const& block) override {
+    if(data == nullptr || data->num_dimensions() == 0) {
+      return libpressio_io_plugin::read_region_impl(data, start, stride, count, block);
+    }
+    if(not pressio_region_valid(data->dimensions(), start, stride, count, block)) {
+      set_error(6, "invalid region selection");
+      return nullptr;
+    }
+    //only the pages touched by the selection are faulted in from storage
+    std::unique_ptr<pressio_data> mapped(read_impl(data));
+    if(!mapped) return nullptr;
+    return new pressio_data(mapped->select(start, stride, count, block));
+  }
+
   virtual int write_impl(struct pressio_data const*) override{
     return set_error(1, "not implemented");
   }
@@ -3,6 +3,9 @@
 #include <fstream>
 #include <sstream>
 #include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
 #include "pressio_data.h"
 #include "pressio_compressor.h"
 #include "libpressio_ext/io/posix.h"
@@ -13,6 +16,8 @@
 #include "std_compat/memory.h"
 #include "std_compat/bit.h"
 #include "std_compat/string_view.h"
+#include "std_compat/functional.h"
+#include "pressio_posix.h"
 
 const size_t libpressio_numpy_max_v1_length = ~uint16_t{0};
 
@@ -278,6 +283,67 @@ struct numpy_io : public libpressio_io_plugin {
     }
   }
 
+  virtual struct pressio_data* read_region_impl(struct pressio_data*,
+      std::vector<size_t> const& start,
+      std::vector<size_t> const& stride,
+      std::vector<size_t> const& count,
+      std::vector<size_t> const& block) override {
+    //the type and dimensions come from the header, so only the header and the selection are read
+    std::ifstream infile(path, std::ios::binary);
+    if(not (infile.is_open() && infile.good())) {
+      throw std::runtime_error("read_data");
+    }
+    libpressio_npy_data np;
+    char preamble[12];
+    infile.read(preamble, 10);
+    np.major_version = static_cast<uint8_t>(preamble[6]);
+    np.minor_version = static_cast<uint8_t>(preamble[7]);
+    uint32_t header_len;
+    size_t current;
+    if(np.major_version == 1) {
+      uint16_t header_len_v1;
+      std::memcpy(&header_len_v1, preamble+8, 2);
+      header_len = header_len_v1;
+      current = 10;
+    } else if (np.major_version == 2) {
+      infile.read(preamble+10, 2);
+      std::memcpy(&header_len, preamble+8, 4);
+      current = 12;
+    } else {
+      throw std::runtime_error("unsupported major_version");
+    }
+    std::string header(header_len, '\0');
+    infile.read(&header[0], header_len);
+    if(!infile) {
+      set_error(1, "failed to read header");
+      return nullptr;
+    }
+    current += header_len;
+    parse_header(header, np);
+
+    if(not pressio_region_valid(np.dims, start, stride, count, block)) {
+      set_error(2, "invalid region selection");
+      return nullptr;
+    }
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd == -1) {
+      set_error(3, errno_to_error());
+      return nullptr;
+    }
+    std::vector<size_t> region_dims(count.size());
+    std::transform(std::begin(count), std::end(count), std::begin(block), std::begin(region_dims), compat::multiplies<>{});
+    auto ret = compat::make_unique<pressio_data>(pressio_data::owning(np.type, region_dims));
+    errno = 0;
+    bool ok = pressio_pread_region(fd, current, np.dims, start, stride, count, block, *ret);
+    if(not ok) {
+      if(errno != 0) set_error(3, errno_to_error());
+      else set_error(4, "file is truncated");
+    }
+    close(fd);
+    if(not ok) return nullptr;
+    return ret.release();
+  }
+
   virtual int write_impl(struct pressio_data const* data) override{
     std::ofstream ofs(path, std::ios::binary| std::ios::trunc | std::ios::out);
     return libpressio_write_np(ofs, data);
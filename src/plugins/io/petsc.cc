@@ -30,6 +30,7 @@ public:
   petsc_init() {
     PetscInitialized(&did_init);
     if (!did_init) {
+      pressio_startup_timer timer("init:PetscInitialize");
       PetscInitializeNoArguments();
     }
   }
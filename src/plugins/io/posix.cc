@@ -1,6 +1,8 @@
 #include <sys/stat.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <vector>
+#include <algorithm>
 #include <errno.h>
 #include "pressio_data.h"
 #include "pressio_compressor.h"
@@ -10,6 +12,7 @@
 #include "libpressio_ext/cpp/data.h"
 #include "libpressio_ext/cpp/io.h"
 #include "std_compat/memory.h"
+#include "std_compat/functional.h"
 #include "pressio_posix.h"
 
 
@@ -127,6 +130,59 @@ struct posix_io : public libpressio_io_plugin {
     return nullptr;
   }
 
+  virtual struct pressio_data* read_region_impl(struct pressio_data* data,
+      std::vector<size_t> const& start,
+      std::vector<size_t> const& stride,
+      std::vector<size_t> const& count,
+      std::vector<size_t> const& block) override {
+    //without dimensions there is no layout to compute offsets from
+    if(data == nullptr || data->num_dimensions() == 0) {
+      return libpressio_io_plugin::read_region_impl(data, start, stride, count, block);
+    }
+    if(not pressio_region_valid(data->dimensions(), start, stride, count, block)) {
+      set_error(4, "invalid region selection");
+      return nullptr;
+    }
+
+    errno = 0;
+    int region_fd;
+    off_t offset = 0;
+    bool close_fd = false;
+    if(path) {
+      region_fd = open(path->c_str(), O_RDONLY);
+      if(region_fd == -1) {
+        set_error(2, errno_to_error());
+        return nullptr;
+      }
+      close_fd = true;
+    } else if(file_ptr) {
+      region_fd = fileno(*file_ptr);
+      offset = ftello(*file_ptr);
+    } else if(fd) {
+      region_fd = *fd;
+      offset = lseek(*fd, 0, SEEK_CUR);
+    } else {
+      invalid_configuration();
+      return nullptr;
+    }
+    if(offset == -1) {
+      //not seekable (i.e. a pipe), read everything and select from it
+      return libpressio_io_plugin::read_region_impl(data, start, stride, count, block);
+    }
+
+    std::vector<size_t> region_dims(count.size());
+    std::transform(std::begin(count), std::end(count), std::begin(block), std::begin(region_dims), compat::multiplies<>{});
+    auto ret = compat::make_unique<pressio_data>(pressio_data::owning(data->dtype(), region_dims));
+    bool ok = pressio_pread_region(region_fd, static_cast<size_t>(offset), data->dimensions(), start, stride, count, block, *ret);
+    if(not ok) {
+      if(errno != 0) set_error(2, errno_to_error());
+      else set_error(3, "invalid dims");
+    }
+    if(close_fd) close(region_fd);
+    if(not ok) return nullptr;
+    return ret.release();
+  }
+
   virtual int write_impl(struct pressio_data const* data) override{
     errno = 0;
     if(path) {
@@ -0,0 +1,246 @@
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "pressio_data.h"
+#include "pressio_compressor.h"
+#include "libpressio_ext/cpp/pressio.h"
+#include "libpressio_ext/cpp/options.h"
+#include "libpressio_ext/cpp/data.h"
+#include "libpressio_ext/cpp/io.h"
+#include "std_compat/memory.h"
+
+namespace prefetch {
+  /**
+   * the outcome of a single read of the child io module
+   */
+  struct read_result {
+    pressio_data* data;
+    int error_code;
+    std::string error_msg;
+  };
+
+  /**
+   * issues reads of the child io module on a background thread, keeping up to depth
+   * results ready ahead of the consumer.  Buffers handed back by the consumer are
+   * reused for later reads so steady state reading does not allocate.
+   */
+  class read_ahead {
+    public:
+    read_ahead(pressio_io& impl, std::mutex& impl_lock, compat::optional<pressio_data> const& buffer_template, size_t depth):
+      impl(impl), impl_lock(impl_lock), buffer_template(buffer_template), depth(depth)
+    {
+      if(buffer_template) {
+        for (size_t i = 0; i < depth; ++i) {
+          spare.emplace_back(pressio_data::owning(buffer_template->dtype(), buffer_template->dimensions()));
+        }
+      }
+      thread = std::thread([this]{ this->work(); });
+    }
+    read_ahead(read_ahead const&)=delete;
+    read_ahead& operator=(read_ahead const&)=delete;
+
+    ~read_ahead() {
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        stop = true;
+      }
+      space_available.notify_all();
+      thread.join();
+      for (auto& result : ready) {
+        pressio_data_free(result.data);
+      }
+    }
+
+    /**
+     * \param[in] recycled a buffer from the consumer that may be reused for a later read
+     * \returns the oldest outstanding read, waiting for it to complete if needed
+     */
+    read_result next(pressio_data* recycled) {
+      std::unique_lock<std::mutex> guard(lock);
+      read_ready.wait(guard, [this]{ return !ready.empty(); });
+      if(ready.front().data == nullptr) {
+        //the child could not read any further; keep reporting the same failure
+        return ready.front();
+      }
+      read_result result = std::move(ready.front());
+      ready.pop_front();
+      if(recycled != nullptr && recycled->has_data() && buffer_template &&
+          recycled->size_in_bytes() == buffer_template->size_in_bytes()) {
+        spare.emplace_back(std::move(*recycled));
+      }
+      guard.unlock();
+      space_available.notify_one();
+      return result;
+    }
+
+    private:
+    void work() {
+      while(true) {
+        pressio_data buffer;
+        bool use_template = false;
+        {
+          std::unique_lock<std::mutex> guard(lock);
+          space_available.wait(guard, [this]{ return stop || (!finished && ready.size() < depth); });
+          if(stop || finished) return;
+          if(!spare.empty()) {
+            buffer = std::move(spare.back());
+            spare.pop_back();
+            use_template = true;
+          } else if(buffer_template) {
+            buffer = pressio_data::owning(buffer_template->dtype(), buffer_template->dimensions());
+            use_template = true;
+          }
+        }
+
+        read_result result;
+        {
+          std::lock_guard<std::mutex> guard(impl_lock);
+          result.data = impl->read((use_template) ? &buffer : nullptr);
+          result.error_code = impl->error_code();
+          result.error_msg = impl->error_msg();
+        }
+
+        {
+          std::lock_guard<std::mutex> guard(lock);
+          if(result.data == nullptr) finished = true;
+          ready.emplace_back(std::move(result));
+        }
+        read_ready.notify_all();
+      }
+    }
+
+    pressio_io& impl;
+    std::mutex& impl_lock;
+    compat::optional<pressio_data> const buffer_template;
+    size_t const depth;
+
+    std::mutex lock;
+    std::condition_variable space_available, read_ready;
+    std::deque<read_result> ready;
+    std::vector<pressio_data> spare;
+    bool stop = false;
+    bool finished = false;
+    std::thread thread;
+  };
+}
+
+struct prefetch_io : public libpressio_io_plugin {
+  prefetch_io()=default;
+  prefetch_io(prefetch_io const& rhs):
+    libpressio_io_plugin(rhs),
+    impl_id(rhs.impl_id),
+    impl(rhs.impl),
+    depth(rhs.depth)
+  {}
+  prefetch_io& operator=(prefetch_io const&)=delete;
+
+  virtual struct pressio_data* read_impl(struct pressio_data* data) override {
+    if(!queue) {
+      compat::optional<pressio_data> buffer_template;
+      if(data != nullptr && data->num_dimensions() != 0) {
+        buffer_template = pressio_data::empty(data->dtype(), data->dimensions());
+      }
+      queue = compat::make_unique<prefetch::read_ahead>(impl, impl_lock, buffer_template, depth);
+    }
+    auto result = queue->next(data);
+    if(result.data == nullptr) {
+      set_error(result.error_code ? result.error_code : 1, result.error_msg);
+    }
+    return result.data;
+  }
+
+  virtual int write_impl(struct pressio_data const* data) override{
+    std::lock_guard<std::mutex> guard(impl_lock);
+    int rc = impl->write(data);
+    if(rc) set_error(impl->error_code(), impl->error_msg());
+    return rc;
+  }
+
+  virtual struct pressio_options get_configuration_impl() const override{
+    pressio_options opts;
+    set(opts, "pressio:stability", "experimental");
+    set(opts, "pressio:thread_safe",  static_cast<int32_t>(pressio_thread_safety_single));
+    return opts;
+  }
+
+  virtual int set_options_impl(struct pressio_options const& options) override{
+    uint32_t new_depth = depth;
+    uint32_t tmp;
+    if(get(options, "prefetch:depth", &tmp) == pressio_options_key_set) {
+      if(tmp < 1) return set_error(1, "invalid prefetch depth");
+      new_depth = tmp;
+    }
+    if(!queue) {
+      get_meta(options, "prefetch:io", io_plugins(), impl_id, impl);
+      depth = new_depth;
+      return 0;
+    }
+
+    //configure a copy of the child so the reads ahead are kept unless the options change what it reads
+    std::unique_lock<std::mutex> guard(impl_lock);
+    std::string candidate_id = impl_id;
+    pressio_io candidate = impl;
+    get_meta(options, "prefetch:io", io_plugins(), candidate_id, candidate);
+    const bool changed = new_depth != depth || candidate_id != impl_id || !(candidate->get_options() == impl->get_options());
+    guard.unlock();
+    if(changed) {
+      //stop reading ahead before replacing the child; reads resume with the new configuration
+      queue.reset();
+      impl_id = std::move(candidate_id);
+      impl = std::move(candidate);
+      depth = new_depth;
+    }
+    return 0;
+  }
+
+  virtual struct pressio_options get_options_impl() const override{
+    std::lock_guard<std::mutex> guard(impl_lock);
+    pressio_options opts;
+    set_meta(opts, "prefetch:io", impl_id, impl);
+    set(opts, "prefetch:depth", depth);
+    return opts;
+  }
+
+  virtual struct pressio_options get_documentation_impl() const override{
+    pressio_options opts;
+    set_meta_docs(opts, "prefetch:io", "io module to read ahead from", impl);
+    set(opts, "pressio:description", R"(reads ahead from another io module on a background thread.
+
+    Each call to read returns the result of the oldest outstanding read of the child and issues another,
+    so reading the next buffer overlaps with whatever is done with the current one.  This is useful with
+    io modules that return a sequence of buffers from successive reads.  The dimensions of the first buffer
+    passed to read are used to preallocate the buffers read into, and buffers passed to later calls to read
+    are reused for later reads.)");
+    set(opts, "prefetch:depth", "the number of reads to keep outstanding");
+    return opts;
+  }
+
+  int patch_version() const override{
+    return 1;
+  }
+  virtual const char* version() const override{
+    return "0.0.1";
+  }
+  const char* prefix() const override {
+    return "prefetch";
+  }
+
+  void set_name_impl(std::string const& new_name) override {
+    impl->set_name(new_name + "/" + impl->prefix());
+  }
+
+  std::shared_ptr<libpressio_io_plugin> clone() override {
+    return compat::make_unique<prefetch_io>(*this);
+  }
+
+  private:
+  std::string impl_id = "posix";
+  pressio_io impl = io_plugins().build("posix");
+  uint32_t depth = 2;
+  mutable std::mutex impl_lock;
+  std::unique_ptr<prefetch::read_ahead> queue;
+};
+
+static pressio_register io_prefetch_plugin(io_plugins(), "prefetch", [](){ return compat::make_unique<prefetch_io>(); });
@@ -5,8 +5,10 @@
 
 struct select_io: public libpressio_io_plugin {
   struct pressio_data* read_impl(struct pressio_data* dims) override {
-    auto read_data = impl->read(dims);
-    auto selected_data = new pressio_data(read_data->select(start, stride, size, block));
+    auto selected_data = impl->read_region(dims, start, stride, size, block);
+    if(selected_data == nullptr) {
+      set_error(impl->error_code(), impl->error_msg());
+    }
     return selected_data;
   }
 
@@ -62,10 +64,10 @@ struct select_io: public libpressio_io_plugin {
   }
 
   int patch_version() const override{ 
-    return 1;
+    return 2;
   }
   const char* version() const override{
-    return "0.0.1";
+    return "0.0.2";
   }
 
   const char* prefix() const override {
@@ -1,161 +1,197 @@
 #include "libpressio_ext/launch/external_launch.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
 #include <memory>
-#include <sstream>
 #include <unistd.h>
+#include <fcntl.h>
 #include <iterator>
+#include <poll.h>
+#include <signal.h>
+#include <sys/resource.h>
 #include <sys/wait.h>
 #include <errno.h>
 #include "pressio_compressor.h"
 #include "std_compat/memory.h"
+#include "std_compat/utility.h"
 
-struct external_forkexec: public libpressio_launch_plugin {
-extern_proc_results launch(std::vector<std::string> const& full_command) const override {
-      extern_proc_results results;
-
-      //create the pipe for stdout
-      int stdout_pipe_fd[2];
-      if(int ec = pipe(stdout_pipe_fd)) {
-        results.return_code = ec;
-        results.error_code = pipe_error;
-        return results;
+namespace {
+  using forkexec_clock = std::chrono::steady_clock;
+
+  /**
+   * a process started by forkexec whose output is being collected
+   */
+  struct forkexec_child {
+    size_t index;
+    pid_t pid = -1;
+    int stdout_fd = -1;
+    int stderr_fd = -1;
+    /** the number of bytes of results.proc_stdout and results.proc_stderr that have been read */
+    size_t stdout_len = 0;
+    size_t stderr_len = 0;
+    /** when the next step of the timeout is taken */
+    forkexec_clock::time_point deadline;
+    /** the number of steps of the timeout already taken */
+    int timeout_steps = 0;
+    extern_proc_results results;
+  };
+
+  /**
+   * the size of the buffers initially allocated for the output of each child
+   */
+  constexpr size_t initial_output_size = 64 * 1024;
+
+  /**
+   * creates a pipe that is not inherited by other children started concurrently
+   */
+  int cloexec_pipe(int fds[2]) {
+    if(int ec = pipe(fds)) return ec;
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    //the parent's end never blocks so that one stream can be emptied without waiting on the other
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    return 0;
+  }
+
+  /**
+   * reads everything currently available from fd directly into output, growing it geometrically, and closes fd
+   * at the end of the stream
+   *
+   * \param[in,out] fd the file descriptor to read, set to -1 once closed
+   * \param[in,out] output the buffer, its size is its capacity while the child is running
+   * \param[in,out] len the number of bytes of output that hold data
+   */
+  void drain(int& fd, std::string& output, size_t& len) {
+    while(true) {
+      if(len == output.size()) {
+        output.resize(std::max(output.size() * 2, initial_output_size));
       }
+      ssize_t nread = read(fd, &output[len], output.size() - len);
+      if(nread > 0) {
+        len += nread;
+      } else if(nread == -1 && errno == EINTR) {
+        continue;
+      } else {
+        if(nread == 0 || errno != EAGAIN) {
+          close(fd);
+          fd = -1;
+        }
+        return;
+      }
+    }
+  }
 
-      //create the pipe for stderr
-      int stderr_pipe_fd[2];
-      if(int ec = pipe(stderr_pipe_fd)) {
-        results.return_code = ec;
-        results.error_code = pipe_error;
-        return results;
+  void close_outputs(forkexec_child& child) {
+    if(child.stdout_fd != -1) close(compat::exchange(child.stdout_fd, -1));
+    if(child.stderr_fd != -1) close(compat::exchange(child.stderr_fd, -1));
+  }
+
+  double seconds(timeval const& time) {
+    return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_usec) / 1e6;
+  }
+
+  forkexec_clock::duration to_duration(double seconds) {
+    return std::chrono::duration_cast<forkexec_clock::duration>(std::chrono::duration<double>(seconds));
+  }
+}
+
+struct external_forkexec: public libpressio_launch_plugin {
+  extern_proc_results launch(std::vector<std::string> const& full_command) const override {
+    extern_proc_results results;
+    launch_async({full_command}, 1, [&results](size_t, extern_proc_results&& result) {
+        results = std::move(result);
+    });
+    return results;
+  }
+
+  /**
+   * starts up to max_concurrency children at a time, and multiplexes reading their stdout and stderr
+   * with poll so that no child blocks on a full pipe while another is being read
+   */
+  void launch_async(std::vector<std::vector<std::string>> const& jobs, size_t max_concurrency, launch_callback const& on_complete) const override {
+    max_concurrency = std::max<size_t>(max_concurrency, 1);
+    std::vector<forkexec_child> running;
+    std::vector<pollfd> pollfds;
+    size_t next = 0;
+
+    while(next < jobs.size() || !running.empty()) {
+      while(running.size() < max_concurrency && next < jobs.size()) {
+        forkexec_child child;
+        child.index = next;
+        spawn(jobs[next++], child);
+        if(child.pid == -1) {
+          on_complete(child.index, std::move(child.results));
+        } else {
+          running.emplace_back(std::move(child));
+        }
       }
 
-      //run the program
-      int child = fork();
-      switch (child) {
-        case -1:
-          results.return_code = -1;
-          results.error_code = fork_error;
-          break;
-        case 0:
-          //in the child process
-          {
-          close(STDIN_FILENO);
-          close(stdout_pipe_fd[0]);
-          close(stderr_pipe_fd[0]);
-          dup2(stdout_pipe_fd[1], 1);
-          dup2(stderr_pipe_fd[1], 2);
-
-          int chdir_status = chdir(workdir.c_str());
-          if(chdir_status == -1) {
-            perror(" failed to change to the specified directory");
-            exit(-2);
+      //enforce the timeouts and find how long poll may wait before the next one
+      int poll_timeout = -1;
+      auto wait_at_most = [&poll_timeout](long long milliseconds) {
+        milliseconds = std::max<long long>(milliseconds, 0);
+        if(poll_timeout == -1 || milliseconds < poll_timeout) {
+          poll_timeout = static_cast<int>(std::min<long long>(milliseconds, std::numeric_limits<int>::max()));
+        }
+      };
+      const auto now = forkexec_clock::now();
+      for (auto& child : running) {
+        if(timeout > 0) {
+          if(now >= child.deadline) {
+            escalate(child, now);
           }
+          wait_at_most(std::chrono::duration_cast<std::chrono::milliseconds>(child.deadline - now).count() + 1);
+        }
+        if(child.stdout_fd == -1 && child.stderr_fd == -1) {
+          //the child closed its outputs without exiting; check on it periodically
+          wait_at_most(10);
+        }
+      }
 
-          std::vector<char*> args;
-          for(auto const& command: commands) {
-            args.push_back(const_cast<char*>(command.c_str()));
-          }
-          std::transform(std::begin(full_command), std::end(full_command),
-              std::back_inserter(args), [](std::string const& s){return const_cast<char*>(s.c_str());});
-          args.push_back(nullptr);
-          if(args.front() != nullptr) {
-            execvp(args.front(), args.data());
-            fprintf(stdout, "external:api=5");
-            perror("failed to exec process");
-            //exit if there was an error
-            fprintf(stderr, " %s\n", args.front());
-          } else {
-            fprintf(stdout, "external:api=5");
-            fprintf(stderr, "no process set");
-          }
-          exit(-1);
-          break;
-          }
-        default:
-          //in the parent process
-
-          //close the unused parts of pipes
-          close(stdout_pipe_fd[1]);
-          close(stderr_pipe_fd[1]);
-
-          int status = 0;
-          char buffer[2048];
-          std::ostringstream stdout_stream;
-          std::ostringstream stderr_stream;
-          bool stdout_closed = false, stderr_closed = false;
-
-          while(true) {
-            int ready, nfds = 0;
-            ssize_t nread;
-            fd_set readfds, writefds, exceptfds;
-
-            FD_ZERO(&readfds);
-            FD_ZERO(&writefds);
-            FD_ZERO(&exceptfds);
-            if(not stdout_closed) {
-              FD_SET(stdout_pipe_fd[0], &readfds);
-              nfds = std::max(stdout_pipe_fd[0], nfds);
-            }
-            if(not stderr_closed) {
-              FD_SET(stderr_pipe_fd[0], &readfds);
-              nfds = std::max(stderr_pipe_fd[0], nfds);
-            }
-
-            if(stdout_closed && stderr_closed) {
-              break;
-            }
-
-            ready = select(nfds+1, &readfds, &writefds, &exceptfds, nullptr);
-
-            if(ready == -1 && errno == EINTR) {
-              continue;
-            }
-
-            if(!stdout_closed && FD_ISSET(stdout_pipe_fd[0], &readfds)) {
-              nread = read(stdout_pipe_fd[0], buffer, sizeof buffer);
-              if(nread > 0) {
-                stdout_stream.write(buffer, nread);
-              } else if (nread == 0) {
-                stdout_closed = true;
-              }
-            }
-
-            if(!stderr_closed && FD_ISSET(stderr_pipe_fd[0], &readfds)) {
-              nread = read(stderr_pipe_fd[0], buffer, sizeof buffer);
-              if(nread > 0) {
-                stderr_stream.write(buffer, nread);
-              } else if(nread == 0)  {
-                stderr_closed = true;
-              }
-            }
+      pollfds.clear();
+      for (auto const& child : running) {
+        if(child.stdout_fd != -1) pollfds.push_back(pollfd{child.stdout_fd, POLLIN, 0});
+        if(child.stderr_fd != -1) pollfds.push_back(pollfd{child.stderr_fd, POLLIN, 0});
+      }
+      if(!pollfds.empty() || poll_timeout != -1) {
+        if(poll(pollfds.data(), pollfds.size(), poll_timeout) == -1) {
+          if(errno == EINTR) continue;
+          //poll itself failed; stop reading and collect whatever the children produced so far
+          for (auto& child : running) {
+            close_outputs(child);
           }
-
-          waitpid(child, &status, 0);
-          close(stdout_pipe_fd[0]);
-          close(stderr_pipe_fd[0]);
-//          do {
-//            //read the stdout[0]
-//            int nread;
-//            while((nread = read(stdout_pipe_fd[0], buffer, 2048)) > 0) {
-//              stdout_stream.write(buffer, nread);
-//            }
-//            
-//            //read the stderr[0]
-//            while((nread = read(stderr_pipe_fd[0], buffer, 2048)) > 0) {
-//              stderr_stream.write(buffer, nread);
-//            }
-//
-//            //wait for the child to complete
-//            waitpid(child, &status, 0);
-//          } while (not WIFEXITED(status));
-
-          results.proc_stdout = stdout_stream.str();
-          results.proc_stderr = stderr_stream.str();
-          results.return_code = WEXITSTATUS(status);
+          pollfds.clear();
+        }
+        size_t fd_idx = 0;
+        for (auto& child : running) {
+          if(child.stdout_fd != -1 && pollfds[fd_idx++].revents) drain(child.stdout_fd, child.results.proc_stdout, child.stdout_len);
+          if(child.stderr_fd != -1 && pollfds[fd_idx++].revents) drain(child.stderr_fd, child.results.proc_stderr, child.stderr_len);
+        }
       }
 
+      //reap the children that closed both of their pipes without blocking, so the pipes of the others keep draining
+      bool drained = true;
+      for (auto it = running.begin(); it != running.end();) {
+        const bool closed = it->stdout_fd == -1 && it->stderr_fd == -1;
+        if(closed && reap(*it, /*block*/ false)) {
+          on_complete(it->index, std::move(it->results));
+          it = running.erase(it);
+        } else {
+          drained = drained && closed;
+          ++it;
+        }
+      }
 
-      return results;
+      //once every pipe is drained and no other child can start, there is nothing to poll for until one exits
+      if(timeout <= 0 && drained && !running.empty() && (next == jobs.size() || running.size() >= max_concurrency)) {
+        reap(running.front(), /*block*/ true);
+        on_complete(running.front().index, std::move(running.front().results));
+        running.erase(running.begin());
+      }
     }
+  }
+
   const char* prefix() const override {
     return "forkexec";
   }
@@ -163,6 +199,8 @@ extern_proc_results launch(std::vector<std::string> const& full_command) const o
   int set_options(pressio_options const& options) override {
     get(options, "external:workdir", &workdir);
     get(options, "external:commands", &commands);
+    get(options, "external:timeout", &timeout);
+    get(options, "external:timeout_grace", &timeout_grace);
     return 0;
   }
 
@@ -178,6 +216,9 @@ extern_proc_results launch(std::vector<std::string> const& full_command) const o
     set(options, "pressio:description", "spawn the child process using fork+exec");
     set(options, "external:workdir", "working directory for the child process");
     set(options, "external:commands", "list of strings passed to exec");
+    set(options, "external:timeout", R"(seconds the child process may run before it is sent SIGTERM, 0 means forever.
+      If it has not exited timeout_grace seconds later it is sent SIGKILL)");
+    set(options, "external:timeout_grace", "seconds between each step of stopping a child process that timed out");
     return options;
   }
 
@@ -185,16 +226,159 @@ extern_proc_results launch(std::vector<std::string> const& full_command) const o
     pressio_options options;
     set(options, "external:workdir", workdir);
     set(options, "external:commands", commands);
+    set(options, "external:timeout", timeout);
+    set(options, "external:timeout_grace", timeout_grace);
     return options;
   }
 
-  
+
   std::unique_ptr<libpressio_launch_plugin> clone() const override {
     return compat::make_unique<external_forkexec>(*this);
   }
 
   std::string workdir=".";
   std::vector<std::string> commands;
+  double timeout = 0;
+  double timeout_grace = 1;
+
+  private:
+  /**
+   * takes the next step of stopping a child that timed out:  SIGTERM, then SIGKILL, then giving up on
+   * its outputs which may be held open by descendants that left its process group
+   */
+  void escalate(forkexec_child& child, forkexec_clock::time_point now) const {
+    child.results.timed_out = true;
+    child.results.error_code = timeout_error;
+    switch(child.timeout_steps++) {
+      case 0:
+        kill(-child.pid, SIGTERM);
+        break;
+      case 1:
+        kill(-child.pid, SIGKILL);
+        break;
+      default:
+        close_outputs(child);
+        break;
+    }
+    child.deadline = now + to_duration(timeout_grace);
+  }
+
+  /**
+   * collects the exit status and resource usage of a child whose outputs are closed
+   *
+   * \param[in] child the child to collect
+   * \param[in] block if true, wait for the child to exit
+   * \returns true if the child was collected
+   */
+  static bool reap(forkexec_child& child, bool block) {
+    int status = 0;
+    struct rusage usage;
+    pid_t ret;
+    while((ret = wait4(child.pid, &status, block ? 0 : WNOHANG, &usage)) == -1 && errno == EINTR);
+    if(ret == 0) return false;
+
+    child.results.proc_stdout.resize(child.stdout_len);
+    child.results.proc_stderr.resize(child.stderr_len);
+    if(ret == -1) {
+      child.results.return_code = -1;
+      return true;
+    }
+    if(WIFSIGNALED(status)) {
+      child.results.return_code = 128 + WTERMSIG(status);
+    } else {
+      child.results.return_code = WEXITSTATUS(status);
+    }
+    child.results.user_time = seconds(usage.ru_utime);
+    child.results.system_time = seconds(usage.ru_stime);
+    child.results.max_rss = static_cast<uint64_t>(usage.ru_maxrss);
+    return true;
+  }
+
+  /**
+   * starts a child process for full_command; on failure child.pid is -1 and child.results holds the error
+   */
+  void spawn(std::vector<std::string> const& full_command, forkexec_child& child) const {
+    //create the pipe for stdout
+    int stdout_pipe_fd[2];
+    if(int ec = cloexec_pipe(stdout_pipe_fd)) {
+      child.results.return_code = ec;
+      child.results.error_code = pipe_error;
+      return;
+    }
+
+    //create the pipe for stderr
+    int stderr_pipe_fd[2];
+    if(int ec = cloexec_pipe(stderr_pipe_fd)) {
+      close(stdout_pipe_fd[0]);
+      close(stdout_pipe_fd[1]);
+      child.results.return_code = ec;
+      child.results.error_code = pipe_error;
+      return;
+    }
+
+    //build the arguments before forking so that the child only calls async-signal-safe functions
+    std::vector<char*> args;
+    for(auto const& command: commands) {
+      args.push_back(const_cast<char*>(command.c_str()));
+    }
+    std::transform(std::begin(full_command), std::end(full_command),
+        std::back_inserter(args), [](std::string const& s){return const_cast<char*>(s.c_str());});
+    args.push_back(nullptr);
+
+    //run the program
+    pid_t pid = fork();
+    switch (pid) {
+      case -1:
+        close(stdout_pipe_fd[0]);
+        close(stdout_pipe_fd[1]);
+        close(stderr_pipe_fd[0]);
+        close(stderr_pipe_fd[1]);
+        child.results.return_code = -1;
+        child.results.error_code = fork_error;
+        return;
+      case 0:
+        //in the child process
+        {
+        if(timeout > 0) {
+          //so that a timeout also stops any processes the child starts
+          setpgid(0, 0);
+        }
+        close(STDIN_FILENO);
+        dup2(stdout_pipe_fd[1], 1);
+        dup2(stderr_pipe_fd[1], 2);
+
+        int chdir_status = chdir(workdir.c_str());
+        if(chdir_status == -1) {
+          perror(" failed to change to the specified directory");
+          _exit(-2);
+        }
+
+        if(args.front() != nullptr) {
+          execvp(args.front(), args.data());
+          fprintf(stdout, "external:api=5");
+          perror("failed to exec process");
+          //exit if there was an error
+          fprintf(stderr, " %s\n", args.front());
+        } else {
+          fprintf(stdout, "external:api=5");
+          fprintf(stderr, "no process set");
+        }
+        fflush(stdout);
+        _exit(-1);
+        }
+      default:
+        //in the parent process, close the unused parts of pipes
+        close(stdout_pipe_fd[1]);
+        close(stderr_pipe_fd[1]);
+        if(timeout > 0) {
+          setpgid(pid, pid);
+        }
+        child.pid = pid;
+        child.deadline = forkexec_clock::now() + to_duration(timeout);
+        child.stdout_fd = stdout_pipe_fd[0];
+        child.stderr_fd = stderr_pipe_fd[0];
+    }
+  }
 };
 
 static pressio_register launch_forkexec_plugin(launch_plugins(), "forkexec", [](){ return compat::make_unique<external_forkexec>();});
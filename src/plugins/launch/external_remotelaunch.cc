@@ -1,5 +1,12 @@
 #include "libpressio_ext/launch/external_launch.h"
+#include "libpressio_ext/cpp/startup.h"
+#include "libpressio_ext/cpp/binary.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <mutex>
+#include <stdexcept>
+#include <vector>
 #include "std_compat/memory.h"
 #include <nlohmann/json.hpp>
 #include "pressio_compressor.h"
@@ -15,6 +22,7 @@ static size_t write_to_std_string(char* txt, size_t size, size_t nelms, void* us
 static std::mutex libpressio_curl_init_lock;
 struct libpressio_external_curl_manager {
   libpressio_external_curl_manager() {
+    pressio_startup_timer timer("init:curl_global_init");
     curl_global_init(CURL_GLOBAL_ALL);
   }
   ~libpressio_external_curl_manager() {
@@ -37,73 +45,154 @@ struct libpressio_external_curl_manager {
 
 
 
+namespace {
+  /**
+   * the content type of requests and responses encoded with options_to_binary
+   */
+  const char binary_content_type[] = "application/x-pressio-options";
+
+  /**
+   * a curl multi handle and the easy handles used with it.  The multi handle keeps the connection
+   * cache, so connections stay open between launches and are shared by concurrent requests.
+   */
+  struct curl_pool {
+    curl_pool(): multi(curl_multi_init()) {}
+    curl_pool(curl_pool const&)=delete;
+    curl_pool& operator=(curl_pool const&)=delete;
+    ~curl_pool() {
+      for (auto handle : idle) {
+        curl_easy_cleanup(handle);
+      }
+      curl_multi_cleanup(multi);
+    }
+
+    CURL* acquire() {
+      if(idle.empty()) return curl_easy_init();
+      CURL* handle = idle.back();
+      idle.pop_back();
+      return handle;
+    }
+
+    void release(CURL* handle) {
+      idle.push_back(handle);
+    }
+
+    CURLM* multi;
+    std::vector<CURL*> idle;
+  };
+
+  /**
+   * one request in flight
+   */
+  struct remote_transfer {
+    size_t index = 0;
+    CURL* handle = nullptr;
+    std::string request;
+    std::string response;
+    char errbuf[CURL_ERROR_SIZE] = {0};
+  };
+}
+
 struct external_remote: public libpressio_launch_plugin {
   external_remote(std::shared_ptr<libpressio_external_curl_manager>&& curl_singleton):
     curl_singleton(curl_singleton) {}
+  external_remote(external_remote const& rhs):
+    libpressio_launch_plugin(rhs),
+    connection_string(rhs.connection_string),
+    request_format(rhs.request_format),
+    max_connections(rhs.max_connections),
+    curl_singleton(rhs.curl_singleton)
+  {}
+  external_remote& operator=(external_remote const&)=delete;
+
+  extern_proc_results launch(std::vector<std::string> const& full_command) const override {
+    extern_proc_results results;
+    launch_async({full_command}, 1, [&results](size_t, extern_proc_results&& result) {
+        results = std::move(result);
+    });
+    return results;
+  }
 
-extern_proc_results launch(std::vector<std::string> const& full_command) const override {
-      extern_proc_results results;
-      nlohmann::json request;
-      request["args"] = full_command;
-      std::string request_str = request.dump();
-      std::string response_str;
-      char errbuf[CURL_ERROR_SIZE] = {0};
-
-      CURLcode ret;
-      CURL *hnd;
-      curl_slist* headers = nullptr;
+  /**
+   * sends up to max_concurrency requests at a time over the pooled connections, multiplexing them over
+   * a single connection when the server supports HTTP/2
+   */
+  void launch_async(std::vector<std::vector<std::string>> const& jobs, size_t max_concurrency, launch_callback const& on_complete) const override {
+    std::lock_guard<std::mutex> guard(pool_lock);
+    if(!pool) {
+      pool = compat::make_unique<curl_pool>();
+      curl_multi_setopt(pool->multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    }
+    curl_multi_setopt(pool->multi, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(max_connections));
+    max_concurrency = std::max<size_t>(max_concurrency, 1);
+
+    curl_slist* headers = nullptr;
+    if(request_format == "binary") {
+      headers = curl_slist_append(headers, (std::string("Content-Type: ") + binary_content_type).c_str());
+      headers = curl_slist_append(headers, (std::string("Accept: ") + binary_content_type + ", application/json").c_str());
+    } else {
       headers = curl_slist_append(headers, "Content-Type: application/json");
-      hnd = curl_easy_init();
-      curl_easy_setopt(hnd, CURLOPT_BUFFERSIZE, 102400L);
-      curl_easy_setopt(hnd, CURLOPT_URL, connection_string.c_str());
-      curl_easy_setopt(hnd, CURLOPT_NOPROGRESS, 1L);
-      curl_easy_setopt(hnd, CURLOPT_USERAGENT, "curl/7.72.0");
-      curl_easy_setopt(hnd, CURLOPT_MAXREDIRS, 50L);
-      curl_easy_setopt(hnd, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
-      curl_easy_setopt(hnd, CURLOPT_TCP_KEEPALIVE, 1L);
-      curl_easy_setopt(hnd, CURLOPT_POST, 1L);
-      curl_easy_setopt(hnd, CURLOPT_POSTFIELDS, request_str.c_str());
-      curl_easy_setopt(hnd, CURLOPT_POSTFIELDSIZE, request_str.size());
-      curl_easy_setopt(hnd, CURLOPT_WRITEFUNCTION, &write_to_std_string);
-      curl_easy_setopt(hnd, CURLOPT_WRITEDATA, &response_str);
-      curl_easy_setopt(hnd, CURLOPT_HTTPHEADER, headers);
-      curl_easy_setopt(hnd, CURLOPT_ERRORBUFFER, errbuf);
-
-      ret = curl_easy_perform(hnd);
-
-      if(ret != CURLE_OK) {
-        results.error_code = ret;
-        if(strlen(errbuf)) {
-          results.proc_stderr = std::string(errbuf);
-        } else {
-          results.proc_stderr = curl_easy_strerror(ret);
-        }
-      } else {
-        try {
-          nlohmann::json response = nlohmann::json::parse(response_str);
-          results.proc_stdout = response["stdout"].get<std::string>();
-          results.proc_stderr = response["stderr"].get<std::string>();
-          results.return_code = response["return_code"].get<int>();
-        } catch(nlohmann::json::exception const& e) {
-          results.proc_stdout = "";
-          results.proc_stderr = response_str + "\n\n" +  e.what();
-          results.error_code = -1;
+    }
+
+    std::vector<remote_transfer> transfers(jobs.size());
+    size_t next = 0, active = 0;
+    auto complete = [&](remote_transfer& transfer, CURLcode code) {
+      on_complete(transfer.index, finish(transfer, code));
+      if(transfer.handle) pool->release(transfer.handle);
+      std::string().swap(transfer.response);
+      --active;
+    };
+
+    while(next < jobs.size() || active > 0) {
+      while(active < max_concurrency && next < jobs.size()) {
+        auto& transfer = transfers[next];
+        transfer.index = next;
+        transfer.request = encode_request(jobs[next++]);
+        transfer.handle = pool->acquire();
+        ++active;
+        configure(transfer, headers);
+        CURLMcode added = transfer.handle ? curl_multi_add_handle(pool->multi, transfer.handle) : CURLM_OUT_OF_MEMORY;
+        if(added != CURLM_OK) {
+          snprintf(transfer.errbuf, sizeof transfer.errbuf, "%s", curl_multi_strerror(added));
+          complete(transfer, CURLE_FAILED_INIT);
         }
       }
+      if(active == 0) continue;
 
-      curl_easy_cleanup(hnd);
-      curl_slist_free_all(headers);
-      hnd = NULL;
+      int still_running = 0;
+      curl_multi_perform(pool->multi, &still_running);
+      int remaining = 0;
+      while(CURLMsg* msg = curl_multi_info_read(pool->multi, &remaining)) {
+        if(msg->msg != CURLMSG_DONE) continue;
+        CURL* handle = msg->easy_handle;
+        CURLcode code = msg->data.result;
+        remote_transfer* transfer = nullptr;
+        curl_easy_getinfo(handle, CURLINFO_PRIVATE, &transfer);
+        curl_multi_remove_handle(pool->multi, handle);
+        complete(*transfer, code);
+      }
+      if(still_running) {
+        curl_multi_wait(pool->multi, nullptr, 0, 1000, nullptr);
+      }
+    }
 
+    curl_slist_free_all(headers);
+  }
 
-      return results;
-    }
   const char* prefix() const override {
     return "remote";
   }
 
   int set_options(pressio_options const& options) override {
     get(options, "external:connection_string", &connection_string);
+    std::string new_format;
+    if(get(options, "external:request_format", &new_format) == pressio_options_key_set) {
+      if(new_format != "json" && new_format != "binary") {
+        return set_error(1, "unknown request format " + new_format);
+      }
+      request_format = std::move(new_format);
+    }
+    get(options, "external:max_connections", &max_connections);
     return 0;
   }
 
@@ -116,14 +205,23 @@ extern_proc_results launch(std::vector<std::string> const& full_command) const o
 
   pressio_options get_documentation_impl() const override {
     pressio_options options;
-    set(options, "pressio:description", "request metrics from a remote server");
+    set(options, "pressio:description", R"(request metrics from a remote server.
+
+    Connections are kept open between requests, and concurrent requests are multiplexed over them when the
+    server supports HTTP/2.)");
     set(options, "external:connection_string", "curl connection string");
+    set(options, "external:request_format", R"(how requests are encoded: "json" sends {"args": [...]}, "binary" sends
+    options with the key "args" encoded with pressio_options_to_binary.  Either way the server may respond with
+    JSON or with options encoded in binary and the content type application/x-pressio-options)");
+    set(options, "external:max_connections", "the maximum number of connections to the server, 0 means no limit");
     return options;
   }
 
   pressio_options get_options() const override {
     pressio_options options;
     set(options, "external:connection_string", connection_string);
+    set(options, "external:request_format", request_format);
+    set(options, "external:max_connections", max_connections);
     return options;
   }
 
@@ -132,7 +230,91 @@ extern_proc_results launch(std::vector<std::string> const& full_command) const o
   }
 
   std::string connection_string;
+  std::string request_format = "json";
+  uint32_t max_connections = 0;
   std::shared_ptr<libpressio_external_curl_manager> curl_singleton;
+
+  private:
+  std::string encode_request(std::vector<std::string> const& full_command) const {
+    if(request_format == "binary") {
+      pressio_options request;
+      request.set("args", full_command);
+      auto encoded = options_to_binary(request);
+      return std::string(static_cast<const char*>(encoded.data()), encoded.size_in_bytes());
+    }
+    nlohmann::json request;
+    request["args"] = full_command;
+    return request.dump();
+  }
+
+  void configure(remote_transfer& transfer, curl_slist* headers) const {
+    CURL* hnd = transfer.handle;
+    if(!hnd) return;
+    curl_easy_setopt(hnd, CURLOPT_PRIVATE, &transfer);
+    curl_easy_setopt(hnd, CURLOPT_BUFFERSIZE, 102400L);
+    curl_easy_setopt(hnd, CURLOPT_URL, connection_string.c_str());
+    curl_easy_setopt(hnd, CURLOPT_NOPROGRESS, 1L);
+    curl_easy_setopt(hnd, CURLOPT_USERAGENT, "curl/7.72.0");
+    curl_easy_setopt(hnd, CURLOPT_MAXREDIRS, 50L);
+    curl_easy_setopt(hnd, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+    curl_easy_setopt(hnd, CURLOPT_PIPEWAIT, 1L);
+    curl_easy_setopt(hnd, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(hnd, CURLOPT_POST, 1L);
+    curl_easy_setopt(hnd, CURLOPT_POSTFIELDS, transfer.request.data());
+    curl_easy_setopt(hnd, CURLOPT_POSTFIELDSIZE, static_cast<long>(transfer.request.size()));
+    curl_easy_setopt(hnd, CURLOPT_WRITEFUNCTION, &write_to_std_string);
+    curl_easy_setopt(hnd, CURLOPT_WRITEDATA, &transfer.response);
+    curl_easy_setopt(hnd, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(hnd, CURLOPT_ERRORBUFFER, transfer.errbuf);
+  }
+
+  static extern_proc_results finish(remote_transfer& transfer, CURLcode ret) {
+    extern_proc_results results;
+    if(ret != CURLE_OK) {
+      results.error_code = ret;
+      if(strlen(transfer.errbuf)) {
+        results.proc_stderr = std::string(transfer.errbuf);
+      } else {
+        results.proc_stderr = curl_easy_strerror(ret);
+      }
+      return results;
+    }
+
+    char* content_type = nullptr;
+    curl_easy_getinfo(transfer.handle, CURLINFO_CONTENT_TYPE, &content_type);
+    if(content_type && strncmp(content_type, binary_content_type, sizeof(binary_content_type) - 1) == 0) {
+      try {
+        auto response = options_from_binary(transfer.response.data(), transfer.response.size());
+        int32_t return_code = 0;
+        if(response.get("stdout", &results.proc_stdout) != pressio_options_key_set ||
+           response.get("stderr", &results.proc_stderr) != pressio_options_key_set ||
+           response.get("return_code", &return_code) != pressio_options_key_set) {
+          throw std::runtime_error("missing stdout, stderr, or return_code");
+        }
+        results.return_code = return_code;
+      } catch(std::exception const& e) {
+        results.proc_stdout = "";
+        results.proc_stderr = std::string("invalid binary response: ") + e.what();
+        results.error_code = -1;
+      }
+      return results;
+    }
+
+    try {
+      nlohmann::json response = nlohmann::json::parse(transfer.response);
+      results.proc_stdout = response["stdout"].get<std::string>();
+      results.proc_stderr = response["stderr"].get<std::string>();
+      results.return_code = response["return_code"].get<int>();
+    } catch(nlohmann::json::exception const& e) {
+      results.proc_stdout = "";
+      results.proc_stderr = transfer.response + "\n\n" +  e.what();
+      results.error_code = -1;
+    }
+    return results;
+  }
+
+  mutable std::mutex pool_lock;
+  mutable std::unique_ptr<curl_pool> pool;
 };
 
 static pressio_register launch_spawn_plugin(launch_plugins(), "remote", [](){
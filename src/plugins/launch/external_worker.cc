@@ -0,0 +1,396 @@
+#include "libpressio_ext/launch/external_launch.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <signal.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <errno.h>
+#include "pressio_compressor.h"
+#include "std_compat/memory.h"
+
+namespace {
+  /**
+   * a worker process spawned once and sent one job at a time over a UNIX socket connected to its
+   * standard input and output
+   */
+  class worker_process {
+    public:
+    worker_process()=default;
+    worker_process(worker_process const&)=delete;
+    worker_process& operator=(worker_process const&)=delete;
+    ~worker_process() {
+      stop();
+    }
+
+    /**
+     * \returns true if the worker was started and has not exited
+     */
+    bool running() {
+      if(pid <= 0) return false;
+      int status;
+      if(waitpid(pid, &status, WNOHANG) == pid) {
+        pid = -1;
+        close(fd);
+        fd = -1;
+        return false;
+      }
+      return true;
+    }
+
+    /**
+     * starts the worker
+     * \returns an extern_proc_error_codes value
+     */
+    int start(std::vector<std::string> const& commands, std::string const& workdir) {
+      int fds[2];
+      if(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) == -1) {
+        return pipe_error;
+      }
+
+      //build the arguments before forking; other threads may be starting workers concurrently, so
+      //allocating in the child could deadlock on a lock held by another thread at the fork
+      std::vector<char*> args;
+      for (auto const& command : commands) {
+        args.push_back(const_cast<char*>(command.c_str()));
+      }
+      args.push_back(nullptr);
+
+      pid_t child = fork();
+      switch(child) {
+        case -1:
+          close(fds[0]);
+          close(fds[1]);
+          return fork_error;
+        case 0:
+          {
+            //in the child process, dup2 clears SOCK_CLOEXEC on the copies
+            dup2(fds[1], STDIN_FILENO);
+            dup2(fds[1], STDOUT_FILENO);
+            if(chdir(workdir.c_str()) == -1) {
+              perror("failed to change to the specified directory");
+              _exit(-2);
+            }
+            if(args.front() != nullptr) {
+              execvp(args.front(), args.data());
+              perror("failed to exec worker");
+            } else {
+              fprintf(stderr, "no process set\n");
+            }
+            _exit(-1);
+          }
+        default:
+          close(fds[1]);
+          fd = fds[0];
+          pid = child;
+          return success;
+      }
+    }
+
+    /**
+     * closes the connection to the worker which exits once it reads the end of its input; if it
+     * does not exit within a second it is killed
+     */
+    void stop() {
+      if(pid <= 0) return;
+      close(fd);
+      fd = -1;
+      int status;
+      for (int i = 0; i < 100; ++i) {
+        if(waitpid(pid, &status, WNOHANG) != 0) {
+          pid = -1;
+          return;
+        }
+        usleep(10000);
+      }
+      kill(pid, SIGKILL);
+      waitpid(pid, &status, 0);
+      pid = -1;
+    }
+
+    /**
+     * sends a job to the worker and waits for its response
+     *
+     * \param[in] args the arguments of the job
+     * \param[in] timeout the maximum number of seconds to wait for the response, or 0 to wait forever
+     * \param[out] results the output of the job
+     * \returns false if the worker could not be reached or did not respond with a valid response
+     */
+    bool run_job(std::vector<std::string> const& args, double timeout, extern_proc_results& results) {
+      std::ostringstream request;
+      request << args.size() << '\n';
+      for (auto const& arg : args) {
+        request << arg.size() << ' ' << arg << '\n';
+      }
+      if(!write_all(request.str())) return false;
+
+      deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(timeout));
+      has_deadline = timeout > 0;
+
+      std::string header;
+      if(!read_line(header)) return false;
+      std::istringstream header_stream(header);
+      int return_code;
+      size_t stdout_len, stderr_len;
+      if(!(header_stream >> return_code >> stdout_len >> stderr_len)) return false;
+
+      std::string proc_stdout(stdout_len, '\0'), proc_stderr(stderr_len, '\0');
+      if(!read_all(&proc_stdout[0], stdout_len) || !read_all(&proc_stderr[0], stderr_len)) return false;
+      results.proc_stdout = std::move(proc_stdout);
+      results.proc_stderr = std::move(proc_stderr);
+      results.return_code = return_code;
+      results.error_code = success;
+      return true;
+    }
+
+    private:
+    bool write_all(std::string const& buffer) {
+      const char* ptr = buffer.data();
+      size_t remaining = buffer.size();
+      while(remaining > 0) {
+        //MSG_NOSIGNAL reports a worker that exited as an error instead of raising SIGPIPE
+        ssize_t written = send(fd, ptr, remaining, MSG_NOSIGNAL);
+        if(written == -1) {
+          if(errno == EINTR) continue;
+          return false;
+        }
+        ptr += written;
+        remaining -= written;
+      }
+      return true;
+    }
+
+    bool wait_readable() {
+      if(!has_deadline) return true;
+      while(true) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if(remaining.count() <= 0) return false;
+        pollfd pfd{fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, static_cast<int>(remaining.count()));
+        if(ready == -1 && errno == EINTR) continue;
+        return ready > 0;
+      }
+    }
+
+    bool read_all(char* ptr, size_t remaining) {
+      while(remaining > 0) {
+        if(!wait_readable()) return false;
+        ssize_t nread = recv(fd, ptr, remaining, 0);
+        if(nread == -1) {
+          if(errno == EINTR) continue;
+          return false;
+        }
+        if(nread == 0) return false;
+        ptr += nread;
+        remaining -= nread;
+      }
+      return true;
+    }
+
+    bool read_line(std::string& line) {
+      char c;
+      line.clear();
+      while(read_all(&c, 1)) {
+        if(c == '\n') return true;
+        line.push_back(c);
+      }
+      return false;
+    }
+
+    pid_t pid = -1;
+    int fd = -1;
+    bool has_deadline = false;
+    std::chrono::steady_clock::time_point deadline;
+  };
+}
+
+struct external_worker: public libpressio_launch_plugin {
+  external_worker()=default;
+  external_worker(external_worker const& rhs):
+    libpressio_launch_plugin(rhs),
+    workdir(rhs.workdir),
+    commands(rhs.commands),
+    max_jobs(rhs.max_jobs),
+    max_restarts(rhs.max_restarts),
+    timeout(rhs.timeout)
+  {}
+  external_worker& operator=(external_worker const&)=delete;
+
+  extern_proc_results launch(std::vector<std::string> const& full_command) const override {
+    worker_slot& slot = *acquire_slots(1).front();
+    std::lock_guard<std::mutex> guard(slot.lock);
+    return run_job(slot, full_command);
+  }
+
+  /**
+   * runs the jobs on up to max_concurrency workers which are kept running for later calls
+   */
+  void launch_async(std::vector<std::vector<std::string>> const& jobs, size_t max_concurrency,
+      launch_callback const& on_complete) const override {
+    const size_t nworkers = std::min(std::max<size_t>(max_concurrency, 1), jobs.size());
+    if(nworkers == 0) return;
+    auto slots = acquire_slots(nworkers);
+
+    std::atomic<size_t> next{0};
+    std::mutex callback_lock;
+    auto run_jobs = [&](worker_slot& slot) {
+      std::unique_lock<std::mutex> slot_guard(slot.lock);
+      for (size_t i; (i = next++) < jobs.size();) {
+        auto results = run_job(slot, jobs[i]);
+        std::lock_guard<std::mutex> guard(callback_lock);
+        on_complete(i, std::move(results));
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < nworkers; ++i) {
+      threads.emplace_back(run_jobs, std::ref(*slots[i]));
+    }
+    run_jobs(*slots.front());
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  const char* prefix() const override {
+    return "worker";
+  }
+
+  int set_options(pressio_options const& options) override {
+    //hold every worker so that no job runs while the configuration changes
+    std::lock_guard<std::mutex> guard(pool_lock);
+    std::vector<std::unique_lock<std::mutex>> slot_guards;
+    for (auto const& slot : slots) {
+      slot_guards.emplace_back(slot->lock);
+    }
+    auto old_workdir = workdir;
+    auto old_commands = commands;
+    get(options, "external:workdir", &workdir);
+    get(options, "external:commands", &commands);
+    get(options, "external:worker_max_jobs", &max_jobs);
+    get(options, "external:worker_max_restarts", &max_restarts);
+    get(options, "external:worker_timeout", &timeout);
+    if(old_workdir != workdir || old_commands != commands) {
+      for (auto const& slot : slots) {
+        slot->worker.stop();
+      }
+    }
+    return 0;
+  }
+
+  struct pressio_options get_configuration() const override {
+    struct pressio_options options;
+    set(options, "pressio:thread_safe", static_cast<int32_t>(pressio_thread_safety_multiple));
+    set(options, "pressio:stability", "experimental");
+    return options;
+  }
+
+  pressio_options get_documentation_impl() const override {
+    pressio_options options;
+    set(options, "pressio:description", R"(spawn the child process once and send it each launch as a job.
+
+    The worker is started from external:commands with its standard input and output connected to a socket.
+    For each launch it reads a line with the number of arguments followed by one line per argument of the form
+    "<length in bytes> <argument>", and replies with a line "<return code> <stdout length> <stderr length>"
+    followed by the bytes of what would have been its standard output and standard error.  A worker that
+    exits, times out, or replies with something else is restarted and sent the job again.  Batches launched with
+    a max_concurrency greater than one run on that many workers, which are also kept running for later launches.)");
+    set(options, "external:workdir", "working directory for the worker process");
+    set(options, "external:commands", "list of strings passed to exec to start the worker");
+    set(options, "external:worker_max_jobs", "restart the worker after this many jobs, 0 means never");
+    set(options, "external:worker_max_restarts", "the number of times a job is retried with a new worker if the worker fails");
+    set(options, "external:worker_timeout", "seconds to wait for the response to a job before restarting the worker, 0 means forever");
+    return options;
+  }
+
+  pressio_options get_options() const override {
+    pressio_options options;
+    set(options, "external:workdir", workdir);
+    set(options, "external:commands", commands);
+    set(options, "external:worker_max_jobs", max_jobs);
+    set(options, "external:worker_max_restarts", max_restarts);
+    set(options, "external:worker_timeout", timeout);
+    return options;
+  }
+
+  std::unique_ptr<libpressio_launch_plugin> clone() const override {
+    return compat::make_unique<external_worker>(*this);
+  }
+
+  std::string workdir=".";
+  std::vector<std::string> commands;
+  uint64_t max_jobs = 0;
+  uint32_t max_restarts = 1;
+  double timeout = 0;
+
+  private:
+  /**
+   * one persistent worker and the number of jobs it has run
+   */
+  struct worker_slot {
+    std::mutex lock;
+    worker_process worker;
+    uint64_t jobs = 0;
+  };
+
+  /**
+   * \param[in] n the number of workers needed
+   * \returns the first n worker slots, creating any that do not exist yet
+   */
+  std::vector<worker_slot*> acquire_slots(size_t n) const {
+    std::lock_guard<std::mutex> guard(pool_lock);
+    while(slots.size() < n) {
+      slots.emplace_back(compat::make_unique<worker_slot>());
+    }
+    std::vector<worker_slot*> acquired;
+    for (size_t i = 0; i < n; ++i) {
+      acquired.push_back(slots[i].get());
+    }
+    return acquired;
+  }
+
+  /**
+   * runs one job on the worker of slot, restarting it as needed;  requires slot.lock to be held
+   */
+  extern_proc_results run_job(worker_slot& slot, std::vector<std::string> const& full_command) const {
+    extern_proc_results results;
+    for (uint32_t attempt = 0; attempt <= max_restarts; ++attempt) {
+      if(!slot.worker.running()) {
+        if(int ec = slot.worker.start(commands, workdir)) {
+          results.return_code = -1;
+          results.error_code = ec;
+          return results;
+        }
+        slot.jobs = 0;
+      }
+      if(slot.worker.run_job(full_command, timeout, results)) {
+        if(max_jobs != 0 && ++slot.jobs >= max_jobs) {
+          slot.worker.stop();
+        }
+        return results;
+      }
+      //the worker exited, hung, or replied with garbage; replace it and retry the job
+      slot.worker.stop();
+    }
+    results.return_code = -1;
+    results.error_code = exec_error;
+    results.proc_stderr = "the worker process failed to respond";
+    return results;
+  }
+
+  /** guards slots; taken before any slot lock when both are held */
+  mutable std::mutex pool_lock;
+  /** workers are only ever added so pointers to them stay valid */
+  mutable std::vector<std::unique_ptr<worker_slot>> slots;
+};
+
+static pressio_register launch_worker_plugin(launch_plugins(), "worker", [](){ return compat::make_unique<external_worker>();});
@@ -0,0 +1,37 @@
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include "libpressio_ext/launch/external_launch.h"
+
+void libpressio_launch_plugin::launch_async(std::vector<std::vector<std::string>> const& jobs, size_t max_concurrency,
+    launch_callback const& on_complete) const {
+  std::atomic<size_t> next{0};
+  std::mutex callback_lock;
+  auto run_jobs = [&](libpressio_launch_plugin const& launcher) {
+    for (size_t i; (i = next++) < jobs.size();) {
+      auto results = launcher.launch(jobs[i]);
+      std::lock_guard<std::mutex> guard(callback_lock);
+      on_complete(i, std::move(results));
+    }
+  };
+
+  const size_t nthreads = std::min(std::max<size_t>(max_concurrency, 1), jobs.size());
+  if(nthreads <= 1) {
+    run_jobs(*this);
+    return;
+  }
+
+  //launch plugins are only required to be safe to use concurrently from different objects
+  std::vector<std::unique_ptr<libpressio_launch_plugin>> launchers;
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < nthreads; ++i) {
+    launchers.emplace_back(clone());
+  }
+  for (auto& launcher : launchers) {
+    threads.emplace_back(run_jobs, std::cref(*launcher));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
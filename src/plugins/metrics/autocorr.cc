@@ -131,7 +131,7 @@ class autocorr_plugin : public libpressio_metrics_plugin {
       return 0;
     }
 
-    int set_options(pressio_options const& opts) override {
+    int set_options_impl(pressio_options const& opts) override {
       get(opts, "autocorr:autocorr_lags", &autocorr_lags);
       return 0;
     }
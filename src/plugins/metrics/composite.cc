@@ -161,7 +161,7 @@ class composite_plugin : public libpressio_metrics_plugin {
     return metrics_options;
   }
 
-  int set_options(pressio_options const& options) override {
+  int set_options_impl(pressio_options const& options) override {
     int rc = 0;
     get(options, "composite:names", &names);
     get_meta_many(options, "composite:plugins", metrics_plugins(), plugins_ids, plugins);
@@ -68,7 +68,7 @@ class diff_pdf_plugin : public libpressio_metrics_plugin {
       return 0;
     }
 
-    int set_options(pressio_options const& opts) override {
+    int set_options_impl(pressio_options const& opts) override {
       get(opts, "diff_pdf:intervals", &pdf_intervals);
       return 0;
     }
@@ -1,4 +1,5 @@
 #include <cstdlib>
+#include <cstring>
 #include <string>
 #include <vector>
 #include <utility>
@@ -6,6 +7,11 @@
 #include <unistd.h>
 #include <chrono>
 #include <iterator>
+#include <atomic>
+#include <algorithm>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include "pressio_data.h"
 #include "pressio_options.h"
 #include "pressio_compressor.h"
@@ -15,6 +21,7 @@
 #include "libpressio_ext/cpp/options.h"
 #include "libpressio_ext/cpp/pressio.h"
 #include "libpressio_ext/cpp/io.h"
+#include "libpressio_ext/cpp/binary.h"
 #include "std_compat/memory.h"
 #include "std_compat/language.h"
 
@@ -22,12 +29,65 @@
 #include "pressio_version.h"
 
 #if LIBPRESSIO_HAS_JSON
-#include <nlohmann/json.hpp>
 #include "libpressio_ext/cpp/json.h"
 #endif
 
 
 
+namespace {
+  /**
+   * where the data for one field is handed to the external process
+   */
+  struct external_field {
+    std::string input_path;
+    std::string decompressed_path;
+    /** names of the shared memory objects, empty when temporary files are used */
+    std::string input_shm;
+    std::string decompressed_shm;
+  };
+
+  /**
+   * creates a shared memory object with a name unique to this process
+   *
+   * \param[in] kind used to build the name
+   * \param[in] prefix prepended to the name;  shared memory names cannot contain directories, so only
+   * the part after the last '/' is used
+   * \param[in] suffix appended to the name
+   * \param[out] name the name of the object
+   * \returns a file descriptor to the object or -1 on failure
+   */
+  int create_shm(const char* kind, std::string const& prefix, std::string const& suffix, std::string& name) {
+    static std::atomic<uint64_t> counter{0};
+    const auto slash = prefix.find_last_of('/');
+    const std::string base = (slash == std::string::npos) ? prefix : prefix.substr(slash + 1);
+    name = "/" + base + ".pressio" + kind + std::to_string(getpid()) + "_" + std::to_string(counter++) + suffix;
+    return shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  }
+
+  /**
+   * \returns true if shared memory objects appear as files under /dev/shm, so the path passed with
+   * --input can refer to them
+   */
+  bool has_dev_shm() {
+    static const bool exists = access("/dev/shm", W_OK) == 0;
+    return exists;
+  }
+
+  /**
+   * copies the raw contents of data into the shared memory object fd
+   * \returns 0 on success
+   */
+  int write_shm(int fd, pressio_data const* data) {
+    const size_t size = data->size_in_bytes();
+    if(ftruncate(fd, size) == -1) return -1;
+    if(size == 0) return 0;
+    void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(ptr == MAP_FAILED) return -1;
+    memcpy(ptr, data->data(), size);
+    return munmap(ptr, size);
+  }
+}
+
 pressio_registry<std::unique_ptr<libpressio_launch_plugin>>& launch_plugins() {
   static pressio_registry<std::unique_ptr<libpressio_launch_plugin>> registry;
   return registry;
@@ -96,7 +156,12 @@ class external_metric_plugin : public libpressio_metrics_plugin {
       set(opt, "external:stderr", "the stderr from the external process, used for error reporting");
       set(opt, "external:return_code", "the return code from the external process if it was launched");
       set(opt, "external:error_code", "error code, indicates problems with launching processes");
+      set(opt, "external:error_msg", "a description of why the output of the external process could not be parsed");
       set(opt, "external:runtime", "runtime of the external request, in seconds");
+      set(opt, "external:user_time", "user CPU time of the external process in seconds, if reported by the launch method");
+      set(opt, "external:system_time", "system CPU time of the external process in seconds, if reported by the launch method");
+      set(opt, "external:max_rss", "maximum resident set size of the external process in kilobytes, if reported by the launch method");
+      set(opt, "external:timed_out", "1 if the external process was stopped because it exceeded external:timeout");
       set(opt, "external:command", "the command to use passed as a single string");
       set(opt, "external:suffix", "suffix to use in generated temporary file names");
       set(opt, "external:prefix", "prefix to use in generated temporary file names");
@@ -106,6 +171,16 @@ class external_metric_plugin : public libpressio_metrics_plugin {
       set(opt, "external:use_many", "use the begin_many/end_many versions for launching the job when there is only one buffer");
       set(opt, "external:write_inputs", "disables the writing of all inputs");
       set(opt, "external:write_outputs", "disables the writing of all ouputs");
+      set(opt, "external:transport", R"(how data is handed to the external process: "file" (the default) writes it to temporary
+      files, "shm" copies it into POSIX shared memory objects whose names are passed with --input_shm and --decompressed_shm
+      when the launch method is forkexec or worker and /dev/shm exists, and uses files otherwise)");
+      set(opt, "external:max_concurrency", R"(the maximum number of evaluations run at a time when compress_many is
+      given several groups of buffers, one per io format, each of which is evaluated separately)");
+      set(opt, "external:evaluations", "the number of separate evaluations run by the last compress_many");
+      set(opt, "external:args_format", R"(how arguments are passed to the external process: "text" passes them
+      on the command line, "binary" passes --api binary:1 --request <path> where path holds the arguments and raw buffers
+      encoded with options_to_binary; this is independent of external:request_format, which the remote launch method
+      uses to encode its requests)");
 
       return opt;
     }
@@ -123,10 +198,13 @@ class external_metric_plugin : public libpressio_metrics_plugin {
       set(opt, "external:use_many", use_many);
       set(opt, "external:write_inputs", write_inputs);
       set(opt, "external:write_outputs", write_outputs);
+      set(opt, "external:transport", transport);
+      set(opt, "external:max_concurrency", max_concurrency);
+      set(opt, "external:args_format", args_format);
       return opt;
     }
 
-    int set_options(pressio_options const& opt) override {
+    int set_options_impl(pressio_options const& opt) override {
       pressio_options mopt = opt;
       std::string command;
       if(get(opt, "external:command", &command) == pressio_options_key_set) {
@@ -145,6 +223,21 @@ class external_metric_plugin : public libpressio_metrics_plugin {
       get(mopt, "external:use_many", &use_many);
       get(mopt, "external:write_inputs", &write_inputs);
       get(mopt, "external:write_outputs", &write_outputs);
+      std::string new_transport;
+      if(get(mopt, "external:transport", &new_transport) == pressio_options_key_set) {
+        if(new_transport != "shm" && new_transport != "file") {
+          return set_error(1, "unknown transport " + new_transport);
+        }
+        transport = std::move(new_transport);
+      }
+      get(mopt, "external:max_concurrency", &max_concurrency);
+      std::string new_args_format;
+      if(get(mopt, "external:args_format", &new_args_format) == pressio_options_key_set) {
+        if(new_args_format != "text" && new_args_format != "binary") {
+          return set_error(1, "unknown args format " + new_args_format);
+        }
+        args_format = std::move(new_args_format);
+      }
       get_meta_many(opt, "external:io_format", io_plugins(), io_formats, io_modules);
       return 0;
     }
@@ -192,12 +285,17 @@ class external_metric_plugin : public libpressio_metrics_plugin {
 
     size_t parse_result(extern_proc_results& proc_results, pressio_options& results) const
     {
+      std::string error_msg;
       try{
         std::istringstream stdout_stream(proc_results.proc_stdout);
         auto api_version = api_version_number(stdout_stream);
+        error_msg = "unsupported external:api=" + api_version;
         if(api_version == "1" || api_version == "2" || api_version == "3" || api_version == "4" || api_version == "5") {
             parse_v1(stdout_stream, proc_results, results);
             return stoull(api_version);
+        } else if(api_version == "binary:1") {
+            parse_binary(stdout_stream, proc_results, results);
+            return 1;
 #if LIBPRESSIO_HAS_JSON
         } else if(api_version == "json:1") {
             parse_json(stdout_stream, proc_results, results);
@@ -205,10 +303,15 @@ class external_metric_plugin : public libpressio_metrics_plugin {
 #endif
         }
 
-      } catch(...) {} //swallow all errors and set error information
+      } catch(std::exception const& ex) {
+        error_msg = ex.what();
+      } catch(...) {
+        error_msg = "failed to parse the output";
+      }
 
       results.clear();
       set(results, "external:error_code", static_cast<int32_t>(format_error));
+      set(results, "external:error_msg", error_msg);
       set(results, "external:return_code", 0);
       set(results, "external:stderr", proc_results.proc_stderr);
       set(results, "external:runtime", duration);
@@ -231,13 +334,29 @@ class external_metric_plugin : public libpressio_metrics_plugin {
       set(proc_results_opts, "external:runtime", duration);
     }
 
+    //the remainder of stdout is options encoded with options_to_binary;  decoding it skips text parsing entirely
+    void parse_binary(std::istringstream& stdout_stream, extern_proc_results const& input, pressio_options& results) const {
+      results.clear();
+
+      const size_t offset = static_cast<size_t>(stdout_stream.tellg());
+      pressio_options options = options_from_binary(input.proc_stdout.data() + offset, input.proc_stdout.size() - offset);
+
+      for (auto const& item : options) {
+        results.set("external:results:"+item.first, item.second);
+      }
+
+      set(results, "external:stderr", input.proc_stderr);
+      set(results, "external:return_code", input.return_code);
+      set(results, "external:error_code", input.return_code);
+      set(results, "external:runtime", duration);
+    }
+
 #if LIBPRESSIO_HAS_JSON
     void parse_json(std::istringstream& stdout_stream, extern_proc_results const& input, pressio_options& results) const {
       results.clear();
 
-      nlohmann::json j;
-      stdout_stream >> j;
-      pressio_options options = j;
+      const size_t offset = static_cast<size_t>(stdout_stream.tellg());
+      pressio_options options = options_from_json(input.proc_stdout.data() + offset, input.proc_stdout.size() - offset);
 
       for (auto const& item : options) {
         results.set("external:results:"+item.first, item.second);
@@ -250,7 +369,81 @@ class external_metric_plugin : public libpressio_metrics_plugin {
     }
 #endif
 
-    std::vector<std::string> build_command(std::vector<std::pair<std::string,std::string>> const& filenames, compat::span<const pressio_data* const> const& input_datasets) const {
+    /**
+     * \returns the name of field i as used in arguments and request keys, or an empty string
+     */
+    std::string field_name(size_t i) const {
+      return (i >= field_names.size()) ? "" : field_names[i];
+    }
+
+    /**
+     * \returns true if field i is written as raw bytes rather than with an io format
+     */
+    bool is_raw(size_t i) const {
+      return i >= io_formats.size() || io_formats[i] == "posix";
+    }
+
+    /**
+     * encodes the arguments for one evaluation with options_to_binary and writes them to a temporary file.
+     * Raw buffers are embedded in the request rather than handed off separately.
+     *
+     * \param[in] fields where the data of each field was handed off
+     * \param[in] input_datasets the input buffers of the evaluation
+     * \param[in] decompressed_datasets the decompressed buffers of the evaluation
+     * \param[out] path the path of the request
+     * \returns the arguments to pass to the external process
+     */
+    std::vector<std::string> build_binary_request(std::vector<external_field> const& fields,
+        compat::span<const pressio_data* const> const& input_datasets,
+        compat::span<const pressio_data* const> const& decompressed_datasets,
+        std::string& path) const {
+      pressio_options request;
+      set(request, "config_name", config_name);
+      auto embed = [](pressio_data const* data) {
+        return pressio_data::nonowning(data->dtype(), const_cast<void*>(data->data()), data->dimensions());
+      };
+      for (size_t i = 0; i < fields.size(); ++i) {
+        const std::string name = field_name(i).empty() ? "" : field_name(i) + ':';
+        if(is_raw(i)) {
+          if(write_inputs) set(request, name + "input_data", embed(input_datasets[i]));
+          if(write_outputs) set(request, name + "decompressed_data", embed(decompressed_datasets[i]));
+        } else {
+          set(request, name + "input", fields[i].input_path);
+          set(request, name + "decompressed", fields[i].decompressed_path);
+        }
+        set(request, name + "type", static_cast<int32_t>(input_datasets[i]->dtype()));
+        auto const& dims = input_datasets[i]->dimensions();
+        set(request, name + "dims", pressio_data(dims.begin(), dims.end()));
+      }
+      auto encoded = options_to_binary(request);
+
+      path = (prefixes.empty() ? std::string() : prefixes.front()) + ".pressioreqXXXXXX";
+      int fd = mkstemp(&path[0]);
+      if(fd == -1) {
+        path.clear();
+        throw std::runtime_error("failed to create the binary request");
+      }
+      char* resolved = realpath(path.c_str(), nullptr);
+      if(resolved) {
+        path = resolved;
+        free(resolved);
+      }
+      const char* ptr = static_cast<const char*>(encoded.data());
+      size_t remaining = encoded.size_in_bytes();
+      while(remaining > 0) {
+        ssize_t written = write(fd, ptr, remaining);
+        if(written <= 0) {
+          close(fd);
+          throw std::runtime_error("failed to write the binary request");
+        }
+        ptr += written;
+        remaining -= written;
+      }
+      close(fd);
+      return {"--api", "binary:1", "--request", path};
+    }
+
+    std::vector<std::string> build_command(std::vector<external_field> const& fields, compat::span<const pressio_data* const> const& input_datasets) const {
       std::vector<std::string> full_command;
       full_command.emplace_back("--api");
       full_command.emplace_back("5");
@@ -265,14 +458,20 @@ class external_metric_plugin : public libpressio_metrics_plugin {
         }
         return ss.str();
       };
-      for (size_t i = 0; i < filenames.size(); ++i) {
-        auto const& input_path = filenames[i].first;
-        auto const& decomp_path = filenames[i].second;
+      for (size_t i = 0; i < fields.size(); ++i) {
         auto const& input_data = input_datasets[i];
         full_command.emplace_back(format_arg(i, "input"));
-        full_command.emplace_back(input_path);
+        full_command.emplace_back(fields[i].input_path);
         full_command.emplace_back(format_arg(i, "decompressed"));
-        full_command.emplace_back(decomp_path);
+        full_command.emplace_back(fields[i].decompressed_path);
+        if(!fields[i].input_shm.empty()) {
+          full_command.emplace_back(format_arg(i, "input_shm"));
+          full_command.emplace_back(fields[i].input_shm);
+        }
+        if(!fields[i].decompressed_shm.empty()) {
+          full_command.emplace_back(format_arg(i, "decompressed_shm"));
+          full_command.emplace_back(fields[i].decompressed_shm);
+        }
         full_command.emplace_back(format_arg(i, "type"));
         switch(input_data->dtype()) {
           case pressio_float_dtype: full_command.emplace_back("float"); break;
@@ -296,9 +495,19 @@ class external_metric_plugin : public libpressio_metrics_plugin {
       return full_command;
     }
 
-    void run_external(compat::span<const pressio_data* const> const& input_data, compat::span<const pressio_data* const> const& decompressed_data) {
-      std::vector<int> fds;
-      std::vector<std::pair<std::string,std::string>> filenames;
+    /**
+     * hands one buffer to the external process, in shared memory if requested and possible, otherwise in a temporary file.
+     * Shared memory is only used when the process is launched on this machine and /dev/shm exists.
+     *
+     * \param[in] i the index of the field
+     * \param[in] kind "in" for inputs, "out" for decompressed outputs
+     * \param[in] data the buffer to hand off
+     * \param[in] write if false the buffer is not written
+     * \param[out] path the path to pass to the external process
+     * \param[out] shm the name of the shared memory object, left empty for files
+     * \param[out] fd the file descriptor of the file or object
+     */
+    void hand_off(size_t i, const char* kind, pressio_data const* data, bool write, std::string& path, std::string& shm, int& fd) {
       auto get_or = [](std::vector<std::string> const& array, size_t index) -> compat::optional<std::string> {
         if(index < array.size()){
           return array[index];
@@ -306,67 +515,154 @@ class external_metric_plugin : public libpressio_metrics_plugin {
           return {};
         }
       };
+      const bool raw = is_raw(i);
+      const bool local = launch_method == "forkexec" || launch_method == "worker";
+
+      if(transport == "shm" && local && has_dev_shm()) {
+        fd = create_shm(kind, get_or(prefixes, i).value_or(""), get_or(suffixes, i).value_or(""), shm);
+        if(fd != -1) {
+          path = "/dev/shm" + shm;
+          bool written = true;
+          if(write) {
+            if(raw) {
+              written = write_shm(fd, data) == 0;
+            } else {
+              io_modules[i]->set_options({{"io:path", path}});
+              written = io_modules[i]->write(data) == 0;
+            }
+          }
+          if(written) return;
+          close(fd);
+          shm_unlink(shm.c_str());
+        }
+        //shared memory is unavailable, use a file instead
+        shm.clear();
+      }
 
-      for (size_t i = 0; i < io_modules.size(); ++i) {
-        //write uncompressed data to a temporary file
-        std::string input_fd_name = get_or(prefixes, i).value_or("") + std::string(".pressioinXXXXXX") + get_or(suffixes, i).value_or("");
-        int input_fd = mkstemps(&input_fd_name[0], get_or(suffixes, i).value_or("").size());
-        char* resolved_input = realpath(input_fd_name.c_str(), nullptr);
-        input_fd_name = resolved_input;
-        free(resolved_input);
-				if(write_inputs) {
-					io_modules[i]->set_options({{"io:path", std::string(input_fd_name)}});
-					io_modules[i]->write(input_data[i]);
-				}
-
-        //write decompressed data to a temporary file
-        std::string output_fd_name = get_or(prefixes, i).value_or("") + std::string(".pressiooutXXXXXX") + get_or(suffixes, i).value_or("");
-        int decompressed_fd = mkstemps(&output_fd_name[0], get_or(suffixes,i).value_or("").size());
-        char* resolved_output = realpath(output_fd_name.c_str(), nullptr);
-        output_fd_name = resolved_output;
-        free(resolved_output);
-				if(write_outputs) {
-					io_modules[i]->set_options({{"io:path", std::string(output_fd_name)}});
-					io_modules[i]->write(decompressed_data[i]);
-				}
-        
-        filenames.emplace_back(input_fd_name, output_fd_name);
-        fds.emplace_back(input_fd);
-        fds.emplace_back(decompressed_fd);
+      path = get_or(prefixes, i).value_or("") + std::string(".pressio") + kind + "XXXXXX" + get_or(suffixes, i).value_or("");
+      fd = mkstemps(&path[0], get_or(suffixes, i).value_or("").size());
+      char* resolved = realpath(path.c_str(), nullptr);
+      path = resolved;
+      free(resolved);
+      if(write) {
+        io_modules[i]->set_options({{"io:path", path}});
+        io_modules[i]->write(data);
+      }
+    }
+
+    /**
+     * runs the external program on input_data and decompressed_data.  When there are several times as many
+     * buffers as io formats, each consecutive group of buffers is a separate evaluation; the evaluations are
+     * launched concurrently and their results are stored under external:<evaluation>:, with the first
+     * evaluation also stored under external: as if it were the only one.
+     */
+    void run_external(compat::span<const pressio_data* const> const& input_data, compat::span<const pressio_data* const> const& decompressed_data) {
+      const size_t nfields = io_modules.size();
+      const size_t evaluations = (nfields != 0 && input_data.size() > nfields && input_data.size() % nfields == 0 &&
+          decompressed_data.size() == input_data.size()) ? input_data.size() / nfields : 1;
+
+      //binary requests embed raw buffers, so only buffers with an io format are handed off
+      const bool binary_request = args_format == "binary";
+      std::vector<int> fds;
+      std::vector<std::vector<external_field>> fields(evaluations, std::vector<external_field>(nfields));
+      for (size_t e = 0; e < evaluations; ++e) {
+        for (size_t i = 0; i < nfields; ++i) {
+          if(binary_request && is_raw(i)) continue;
+          int input_fd, decompressed_fd;
+          auto& field = fields[e][i];
+          hand_off(i, "in", input_data[e * nfields + i], write_inputs, field.input_path, field.input_shm, input_fd);
+          hand_off(i, "out", decompressed_data[e * nfields + i], write_outputs, field.decompressed_path, field.decompressed_shm, decompressed_fd);
+          fds.emplace_back(input_fd);
+          fds.emplace_back(decompressed_fd);
+        }
       }
+      std::vector<std::string> request_paths;
+
+      //delete the temporary files and shared memory objects
+      auto cleanup = [&]{
+        std::for_each(std::begin(fds), std::end(fds), [](int fd){ close(fd);});
+        for (auto const& evaluation_fields : fields) {
+          std::for_each(std::begin(evaluation_fields), std::end(evaluation_fields),
+              [](external_field const& field){
+                if(!field.input_shm.empty()) shm_unlink(field.input_shm.c_str());
+                else if(!field.input_path.empty()) unlink(field.input_path.c_str());
+                if(!field.decompressed_shm.empty()) shm_unlink(field.decompressed_shm.c_str());
+                else if(!field.decompressed_path.empty()) unlink(field.decompressed_path.c_str());
+              });
+        }
+        for (auto const& path : request_paths) {
+          if(!path.empty()) unlink(path.c_str());
+        }
+      };
 
       //get the defaults
       auto default_result = launcher->launch({});
       parse_result(default_result, this->defaults);
 
-      //build the command
-      auto full_command = build_command(filenames, input_data);
+      //build the commands
+      std::vector<std::vector<std::string>> full_commands;
+      for (size_t e = 0; e < evaluations; ++e) {
+        compat::span<const pressio_data* const> evaluation_inputs{input_data.data() + e * nfields, nfields};
+        if(binary_request) {
+          compat::span<const pressio_data* const> evaluation_decompressed{decompressed_data.data() + e * nfields, nfields};
+          request_paths.emplace_back();
+          try {
+            full_commands.emplace_back(build_binary_request(fields[e], evaluation_inputs, evaluation_decompressed, request_paths.back()));
+          } catch(std::exception const& ex) {
+            results.clear();
+            set(results, "external:error_code", static_cast<int32_t>(format_error));
+            set(results, "external:error_msg", std::string(ex.what()));
+            cleanup();
+            return;
+          }
+        } else {
+          full_commands.emplace_back(build_command(fields[e], evaluation_inputs));
+        }
+      }
 
-      //run the external program
+      //run the external programs
       auto start_time = std::chrono::high_resolution_clock::now();
-      auto result = launcher->launch(full_command);
+      auto proc_results = launcher->launch_many(full_commands, max_concurrency);
       auto end_time = std::chrono::high_resolution_clock::now();
       duration = std::chrono::duration<double>(end_time - start_time).count();
 
       //parse the output
-      size_t api_version =parse_result(result, this->results);
+      results.clear();
+      for (size_t e = 0; e < evaluations; ++e) {
+        pressio_options evaluation_results;
+        size_t api_version = parse_result(proc_results[e], evaluation_results);
+        set(evaluation_results, "external:user_time", proc_results[e].user_time);
+        set(evaluation_results, "external:system_time", proc_results[e].system_time);
+        set(evaluation_results, "external:max_rss", proc_results[e].max_rss);
+        set(evaluation_results, "external:timed_out", static_cast<int32_t>(proc_results[e].timed_out));
+        if(proc_results[e].timed_out) {
+          set(evaluation_results, "external:error_code", static_cast<int32_t>(timeout_error));
+        }
+
+        //combine the results by setting defaults
+        if(api_version >= 3) {
+          for (auto const& default_v : defaults) {
+            if (evaluation_results.key_status(default_v.first) != pressio_options_key_set) {
+              evaluation_results.set(default_v.first, defaults.get(default_v.first));
+            }
+          }
+        }
 
-      //combine the results by setting defaults
-      if(api_version >= 3) {
-        for (auto const& default_v : defaults) {
-          if (results.key_status(default_v.first) != pressio_options_key_set) {
-            results.set(default_v.first, defaults.get(default_v.first));
+        if(evaluations > 1) {
+          const std::string evaluation_prefix = "external:" + std::to_string(e) + ":";
+          for (auto const& item : evaluation_results) {
+            results.set(evaluation_prefix + item.first.substr(std::strlen("external:")), item.second);
           }
         }
+        if(e == 0) {
+          results.copy_from(evaluation_results);
+        }
+      }
+      if(evaluations > 1) {
+        set(results, "external:evaluations", static_cast<uint64_t>(evaluations));
       }
 
-      //delete the temporary files
-      std::for_each(std::begin(fds), std::end(fds), [](int fd){ close(fd);});
-      std::for_each(std::begin(filenames), std::end(filenames),
-          [](std::pair<std::string,std::string> const& file){
-            unlink(file.first.c_str());
-            unlink(file.second.c_str());
-          });
+      cleanup();
     }
 
     int use_many = 0;
@@ -383,6 +679,9 @@ class external_metric_plugin : public libpressio_metrics_plugin {
     pressio_options defaults;
 		int write_inputs = 1;
 		int write_outputs = 1;
+    std::string transport = "file";
+    uint32_t max_concurrency = 1;
+    std::string args_format = "text";
     double duration = 0.0;
     std::vector<pressio_io> io_modules = {std::shared_ptr<libpressio_io_plugin>(io_plugins().build("posix"))};
 
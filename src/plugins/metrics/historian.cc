@@ -136,7 +136,7 @@ class pressio_historian_metric: public libpressio_metrics_plugin {
   std::unique_ptr<libpressio_metrics_plugin> clone() override {
     return compat::make_unique<pressio_historian_metric>(*this);
   }
-  int set_options(pressio_options const& opts) override {
+  int set_options_impl(pressio_options const& opts) override {
     get_meta(opts, "historian:metrics", metrics_plugins(),  metrics_id, metrics);
     get(opts, "historian:idx", &idx);
     std::vector<std::string> events_str;
@@ -275,7 +275,7 @@ public:
     return opt;
   }
 
-  int set_options(struct pressio_options const&) override
+  int set_options_impl(struct pressio_options const&) override
   {
     return 0;
   }
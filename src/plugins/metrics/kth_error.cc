@@ -73,7 +73,7 @@ public:
     return opt;
   }
 
-  int set_options(struct pressio_options const& opts) override
+  int set_options_impl(struct pressio_options const& opts) override
   {
     pressio_options opt;
     double tmp_k;
@@ -41,13 +41,13 @@ class mask_metrics: public libpressio_metrics_plugin {
   }
 
   int begin_compress_impl(pressio_data const* input, pressio_data const* output) override {
-    auto masked(pressio_data_for_each<pressio_data>(*input, mask, apply_mask{}));
+    auto masked(pressio_data_for_each<pressio_data>(*input, *mask, apply_mask{}));
     plugin->begin_compress(&masked, output);
     return 0;
   }
 
   int end_decompress_impl(pressio_data const* input, pressio_data const* output, int rc) override {
-    auto masked(pressio_data_for_each<pressio_data>(*output, mask, apply_mask{}));
+    auto masked(pressio_data_for_each<pressio_data>(*output, *mask, apply_mask{}));
     plugin->end_decompress(input, &masked, rc);
     return 0;
   }
@@ -75,7 +75,7 @@ class mask_metrics: public libpressio_metrics_plugin {
     return opts;
   }
 
-  int set_options(pressio_options const& opts) override {
+  int set_options_impl(pressio_options const& opts) override {
     get_meta(opts, "mask:metrics", metrics_plugins(), plugin_id, plugin);
     get(opts, "mask:mask", &mask);
     return 0;
@@ -96,7 +96,7 @@ class mask_metrics: public libpressio_metrics_plugin {
   private:
   pressio_metrics plugin =  metrics_plugins().build("noop");
   std::string plugin_id = "noop";
-  pressio_data mask;
+  pressio_option_shared_data mask{pressio_data()};
 };
 
 pressio_register mask_plugin(metrics_plugins(), "mask", []{ return compat::make_unique<mask_metrics>(); });
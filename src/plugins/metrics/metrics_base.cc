@@ -122,6 +122,9 @@ int libpressio_metrics_plugin::begin_set_options_impl(struct pressio_options con
 int libpressio_metrics_plugin::end_set_options_impl(struct pressio_options const &, int ) {
   return 0;
 }
+int libpressio_metrics_plugin::set_options_impl(struct pressio_options const &) {
+  return 0;
+}
 int libpressio_metrics_plugin::begin_compress_impl(const struct pressio_data *, struct pressio_data const *) {
   return 0;
 }
@@ -166,3 +169,9 @@ int libpressio_metrics_plugin::end_decompress_many_impl(compat::span<const press
 void libpressio_metrics_plugin::set_name(std::string const& new_name) {
   pressio_configurable::set_name(new_name);
 }
+
+int libpressio_metrics_plugin::set_options(struct pressio_options const& options) {
+  clear_error();
+  options_change_scope changed(*this, options);
+  return changed.finish(set_options_impl(options));
+}
@@ -142,7 +142,7 @@ public:
     return opts;
   }
 
-  int set_options(pressio_options const& opts) override {
+  int set_options_impl(pressio_options const& opts) override {
     get(opts, "region_of_interest:start", &start);
     get(opts, "region_of_interest:end", &end);
     return 0;
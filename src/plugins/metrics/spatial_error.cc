@@ -79,7 +79,7 @@ public:
     return opts;
   }
 
-  int set_options(pressio_options const& options) override {
+  int set_options_impl(pressio_options const& options) override {
     get(options, "spatial_error:threshold", &threshold);
     return 0;
   }
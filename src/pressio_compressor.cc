@@ -1,5 +1,7 @@
 #include "libpressio_ext/cpp/compressor.h"
 #include "libpressio_ext/cpp/options.h"
+#include "libpressio_ext/cpp/data.h"
+#include "libpressio_ext/cpp/io.h"
 
 extern "C" {
 
@@ -97,5 +99,19 @@ int pressio_compressor_decompress_many(struct pressio_compressor* compressor,
   return (*compressor)->decompress_many(in, in+num_inputs, out, out+num_outputs);
 }
 
+int pressio_compressor_compress_stream(struct pressio_compressor* compressor,
+    struct pressio_io* input, struct pressio_data const* input_template,
+    struct pressio_io* output, size_t slab_size, size_t window
+    ) {
+  return (*compressor)->compress_stream(**input, *input_template, **output, slab_size, window);
+}
+
+int pressio_compressor_decompress_stream(struct pressio_compressor* compressor,
+    struct pressio_io* input, struct pressio_io* output, size_t window,
+    struct pressio_data* output_template
+    ) {
+  return (*compressor)->decompress_stream(**input, **output, window, output_template);
+}
+
 
 }
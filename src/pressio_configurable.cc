@@ -1,5 +1,108 @@
+#include <algorithm>
+#include <atomic>
 #include "libpressio_ext/cpp/configurable.h"
 
+namespace {
+  std::atomic<uint64_t>& epoch() {
+    //starts at 1 so that a zero generation is never current
+    static std::atomic<uint64_t> counter{1};
+    return counter;
+  }
+}
+
+uint64_t pressio_configurable::current_epoch() {
+  return epoch().load(std::memory_order_acquire);
+}
+
+void pressio_configurable::bump_generation() {
+  generation = epoch().fetch_add(1, std::memory_order_acq_rel) + 1;
+}
+
+namespace {
+  /**
+   * \returns true if setting incoming would change the value of current
+   */
+  bool changes_value(pressio_option const& current, pressio_option const& incoming) {
+    if(!incoming.has_value()) return false;
+    if(incoming.type() == current.type()) return !(incoming == current);
+    auto converted = incoming.as(current.type(), pressio_conversion_implicit);
+    return !converted.has_value() || !(converted == current);
+  }
+}
+
+uint64_t pressio_configurable::add_options_listener(options_listener listener) {
+  const uint64_t id = changes.next_listener_id++;
+  changes.listeners.emplace_back(id, std::move(listener));
+  return id;
+}
+
+void pressio_configurable::remove_options_listener(uint64_t id) {
+  auto& listeners = changes.listeners;
+  listeners.erase(std::remove_if(listeners.begin(), listeners.end(),
+        [id](std::pair<uint64_t, options_listener> const& entry) { return entry.first == id; }),
+      listeners.end());
+}
+
+pressio_options pressio_configurable::changed_options(pressio_options const& options) const {
+  pressio_options changed;
+  for (auto const& entry : get_options()) {
+    //keys are either unnamed or of the form /name:key
+    compat::string_view full_key = entry.first, entry_name, key = full_key;
+    if(!full_key.empty() && full_key.front() == '/') {
+      const auto colon = full_key.find(':');
+      if(colon == compat::string_view::npos) continue;
+      entry_name = full_key.substr(1, colon - 1);
+      key = full_key.substr(colon + 1);
+    }
+    auto incoming = options.lookup(entry_name, key);
+    if(incoming != options.end() && changes_value(entry.second, incoming->second)) {
+      changed.set(entry.first, incoming->second);
+    }
+  }
+  return changed;
+}
+
+bool pressio_configurable::option_changed(pressio_options::const_iterator before, compat::string_view const& name, compat::string_view const& key) const {
+  if(before == changes.before.end()) return true;
+  auto incoming = changes.incoming->lookup(name, key);
+  return incoming != changes.incoming->end() && changes_value(before->second, incoming->second);
+}
+
+pressio_configurable::options_change_scope::options_change_scope(pressio_configurable& configurable, pressio_options const& options):
+  configurable(configurable)
+{
+  auto& changes = configurable.changes;
+  if(changes.tracking || !changes.listeners.empty()) {
+    changes.before = configurable.get_options();
+    changes.incoming = &options;
+  }
+}
+
+pressio_configurable::options_change_scope::~options_change_scope() {
+  auto& changes = configurable.changes;
+  if(succeeded) {
+    configurable.bump_generation();
+    if(changes.incoming != nullptr && !changes.listeners.empty()) {
+      pressio_options changed;
+      for (auto const& entry : configurable.get_options()) {
+        auto before = changes.before.find(entry.first);
+        if(before == changes.before.end() || !(before->second == entry.second)) {
+          changed.set(entry.first, entry.second);
+        }
+      }
+      if(changed.size() != 0) {
+        //copy so that listeners may add or remove listeners
+        auto listeners = changes.listeners;
+        for (auto const& listener : listeners) {
+          listener.second(configurable, changed);
+        }
+      }
+    }
+  }
+  changes.incoming = nullptr;
+  changes.before.clear();
+}
+
 struct pressio_options pressio_configurable::get_documentation() const {
   return {};
 }
@@ -382,6 +382,7 @@ pressio_data pressio_data::cast(pressio_dtype const dtype) const {
 bool pressio_data::operator==(pressio_data const& rhs) const {
   if(data_dtype != rhs.data_dtype) return false;
   if(dims != rhs.dims) return false;
+  if(!has_data() || !rhs.has_data()) return has_data() == rhs.has_data();
   return pressio_data_for_each<bool>(*this, rhs, data_all_equal{});
 }
 
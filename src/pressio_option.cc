@@ -354,7 +354,8 @@ pressio_option pressio_option::as(const enum pressio_option_type to_type, const
     //don't allow conversions from pressio_option_data_type for now
     case pressio_option_data_type:
       if(to_type == pressio_option_data_type) {
-        return get_value<pressio_data>();
+        //share the buffer rather than copying it
+        return *this;
       } else return {};
     default:
       return {};
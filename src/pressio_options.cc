@@ -191,35 +191,9 @@ char* pressio_options_to_string(struct pressio_options const* options) {
 
 std::vector<compat::string_view> pressio_options::search(compat::string_view const& value) {
   std::vector<compat::string_view> order;
-  //normalize the string
-  auto size = value.size();
-  const unsigned int has_leading_slash = !value.empty() && value.front() == '/';
-  const unsigned int has_training_slash = !value.empty() && value.back() == '/';
-  if(size >= 2) {
-    if(has_leading_slash) --size;
-    if(has_training_slash) --size;
-  } else if(size == 1){
-    if(has_leading_slash) --size;
-  }
-  const auto normalized = value.substr(has_leading_slash, size);
-
-  
-  //special case empty string
-  if(normalized.empty()) {
-    order.emplace_back("");
-    return order;
-  }
-
-  order.reserve(std::count(std::begin(normalized), std::end(normalized), '/') + 2);
-  bool done = false;
-  auto len = std::string::npos;
-  while(!done) {
-    order.emplace_back(normalized.substr(0, len));
-
-    len = normalized.rfind('/', len - 1);
-    done = (len == std::string::npos);
-  }
-  order.emplace_back("");
-
+  search_each(value, [&order](compat::string_view const& path) {
+      order.emplace_back(path);
+      return false;
+  });
   return order;
 }
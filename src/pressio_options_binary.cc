@@ -0,0 +1,409 @@
+#include <cstring>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "pressio_options.h"
+#include "libpressio_ext/cpp/binary.h"
+#include "libpressio_ext/cpp/data.h"
+#include "libpressio_ext/cpp/options.h"
+#include "libpressio_ext/cpp/pressio.h"
+#include "libpressio_ext/binary/pressio_options_binary.h"
+
+namespace {
+  const char magic[4] = {'P', 'R', 'O', 'B'};
+  const uint8_t format_version = 1;
+  const uint8_t has_value_flag = 0x80;
+  const size_t payload_alignment = 8;
+
+  uint8_t native_byte_order() {
+    const uint16_t probe = 1;
+    uint8_t first;
+    memcpy(&first, &probe, 1);
+    return first;
+  }
+
+  /**
+   * writes the encoding;  when constructed without a buffer it only counts the bytes that would be written
+   */
+  class binary_writer {
+    public:
+    explicit binary_writer(unsigned char* out=nullptr): out(out) {}
+
+    void bytes(const void* src, size_t n) {
+      if(out && n) memcpy(out + pos, src, n);
+      pos += n;
+    }
+    void byte(uint8_t value) {
+      bytes(&value, 1);
+    }
+    void varint(uint64_t value) {
+      while(value >= 0x80) {
+        byte(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+      }
+      byte(static_cast<uint8_t>(value));
+    }
+    void zigzag(int64_t value) {
+      varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+    void string(std::string const& value) {
+      varint(value.size());
+      bytes(value.data(), value.size());
+    }
+    void align() {
+      while(pos % payload_alignment) byte(0);
+    }
+    size_t size() const { return pos; }
+
+    private:
+    unsigned char* out;
+    size_t pos = 0;
+  };
+
+  void encode_data(binary_writer& w, pressio_data const& data) {
+    w.varint(data.dtype());
+    auto const& dims = data.dimensions();
+    w.varint(dims.size());
+    for (auto dim : dims) {
+      w.varint(dim);
+    }
+    const bool has_data = data.has_data() && data.size_in_bytes() > 0;
+    w.byte(has_data);
+    if(has_data) {
+      w.align();
+      w.bytes(data.data(), data.size_in_bytes());
+    }
+  }
+
+  void encode_option(binary_writer& w, pressio_option const& option) {
+    const bool has_value = option.has_value();
+    w.byte(static_cast<uint8_t>(option.type()) | (has_value ? has_value_flag : 0));
+    if(!has_value) return;
+    switch(option.type()) {
+      case pressio_option_int8_type:
+        w.byte(static_cast<uint8_t>(option.get_value<int8_t>()));
+        break;
+      case pressio_option_uint8_type:
+        w.byte(option.get_value<uint8_t>());
+        break;
+      case pressio_option_int16_type:
+        w.zigzag(option.get_value<int16_t>());
+        break;
+      case pressio_option_int32_type:
+        w.zigzag(option.get_value<int32_t>());
+        break;
+      case pressio_option_int64_type:
+        w.zigzag(option.get_value<int64_t>());
+        break;
+      case pressio_option_uint16_type:
+        w.varint(option.get_value<uint16_t>());
+        break;
+      case pressio_option_uint32_type:
+        w.varint(option.get_value<uint32_t>());
+        break;
+      case pressio_option_uint64_type:
+        w.varint(option.get_value<uint64_t>());
+        break;
+      case pressio_option_float_type:
+        {
+          float value = option.get_value<float>();
+          w.bytes(&value, sizeof(value));
+        }
+        break;
+      case pressio_option_double_type:
+        {
+          double value = option.get_value<double>();
+          w.bytes(&value, sizeof(value));
+        }
+        break;
+      case pressio_option_charptr_type:
+        w.string(option.get_value<std::string>());
+        break;
+      case pressio_option_charptr_array_type:
+        {
+          auto const& values = option.get_value<std::vector<std::string>>();
+          w.varint(values.size());
+          for (auto const& value : values) {
+            w.string(value);
+          }
+        }
+        break;
+      case pressio_option_data_type:
+        encode_data(w, option.get_value<pressio_data>());
+        break;
+      case pressio_option_unset_type:
+      case pressio_option_userptr_type:
+        break;
+    }
+  }
+
+  void encode(binary_writer& w, pressio_options const& options) {
+    w.bytes(magic, sizeof(magic));
+    w.byte(format_version);
+    w.byte(native_byte_order());
+    size_t entries = 0;
+    for (auto const& entry : options) {
+      if(entry.second.type() != pressio_option_userptr_type) ++entries;
+    }
+    w.varint(entries);
+    for (auto const& entry : options) {
+      if(entry.second.type() == pressio_option_userptr_type) continue;
+      w.string(entry.first);
+      encode_option(w, entry.second);
+    }
+  }
+
+  void release_shared_buffer(void*, void* metadata) {
+    delete static_cast<std::shared_ptr<pressio_data>*>(metadata);
+  }
+
+  /**
+   * how pressio_data payloads are materialized when decoding
+   */
+  enum class payload_mode {
+    /** payloads are copied out of the buffer */
+    copy,
+    /** payloads are non-owning views into the buffer */
+    view,
+    /** payloads are views that share ownership of the buffer */
+    shared,
+  };
+
+  class binary_reader {
+    public:
+    binary_reader(const void* buffer, size_t size, payload_mode mode, std::shared_ptr<pressio_data> owner={}):
+      begin(static_cast<const unsigned char*>(buffer)), end(begin + size), pos(begin), mode(mode), owner(std::move(owner)) {}
+
+    const unsigned char* bytes(size_t n) {
+      if(n > static_cast<size_t>(end - pos)) throw std::runtime_error("truncated binary options");
+      auto ret = pos;
+      pos += n;
+      return ret;
+    }
+    uint8_t byte() {
+      return *bytes(1);
+    }
+    uint64_t varint() {
+      uint64_t value = 0;
+      for (unsigned shift = 0; shift < 64; shift += 7) {
+        uint8_t b = byte();
+        value |= static_cast<uint64_t>(b & 0x7f) << shift;
+        if(!(b & 0x80)) return value;
+      }
+      throw std::runtime_error("invalid varint in binary options");
+    }
+    int64_t zigzag() {
+      uint64_t value = varint();
+      return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+    template <class T>
+    T checked_varint() {
+      uint64_t value = varint();
+      if(value > std::numeric_limits<T>::max()) throw std::runtime_error("value out of range in binary options");
+      return static_cast<T>(value);
+    }
+    template <class T>
+    T checked_zigzag() {
+      int64_t value = zigzag();
+      if(value > std::numeric_limits<T>::max() || value < std::numeric_limits<T>::min()) {
+        throw std::runtime_error("value out of range in binary options");
+      }
+      return static_cast<T>(value);
+    }
+    template <class T>
+    T raw() {
+      T value;
+      memcpy(&value, bytes(sizeof(T)), sizeof(T));
+      return value;
+    }
+    std::string string() {
+      size_t size = checked_varint<size_t>();
+      auto ptr = bytes(size);
+      return std::string(reinterpret_cast<const char*>(ptr), size);
+    }
+    void align() {
+      bytes((payload_alignment - (pos - begin) % payload_alignment) % payload_alignment);
+    }
+
+    pressio_data data() {
+      uint64_t dtype_i = varint();
+      if(dtype_i > pressio_byte_dtype) throw std::runtime_error("invalid dtype in binary options");
+      auto dtype = static_cast<pressio_dtype>(dtype_i);
+      size_t ndims = checked_varint<size_t>();
+      if(ndims > static_cast<size_t>(end - pos)) throw std::runtime_error("truncated binary options");
+      std::vector<size_t> dims(ndims);
+      size_t size = pressio_dtype_size(dtype);
+      for (auto& dim : dims) {
+        dim = checked_varint<size_t>();
+        if(dim != 0 && size > std::numeric_limits<size_t>::max() / dim) {
+          throw std::runtime_error("data too large in binary options");
+        }
+        size *= dim;
+      }
+      if(!byte()) {
+        return pressio_data::empty(dtype, dims);
+      }
+      align();
+      auto payload = bytes(size);
+      void* ptr = const_cast<unsigned char*>(payload);
+      const bool aligned = reinterpret_cast<uintptr_t>(payload) % payload_alignment == 0;
+      if(mode == payload_mode::copy || !aligned) {
+        return pressio_data::copy(dtype, payload, dims);
+      } else if(mode == payload_mode::view) {
+        return pressio_data::nonowning(dtype, ptr, dims);
+      } else {
+        return pressio_data::move(dtype, ptr, dims, release_shared_buffer, new std::shared_ptr<pressio_data>(owner));
+      }
+    }
+
+    pressio_option option() {
+      uint8_t tag = byte();
+      auto type = static_cast<pressio_option_type>(tag & ~has_value_flag);
+      if(type > pressio_option_int64_type) throw std::runtime_error("invalid option type in binary options");
+      pressio_option option;
+      if(!(tag & has_value_flag)) {
+        option.set_type(type);
+        return option;
+      }
+      switch(type) {
+        case pressio_option_int8_type:
+          option = static_cast<int8_t>(byte());
+          break;
+        case pressio_option_uint8_type:
+          option = byte();
+          break;
+        case pressio_option_int16_type:
+          option = checked_zigzag<int16_t>();
+          break;
+        case pressio_option_int32_type:
+          option = checked_zigzag<int32_t>();
+          break;
+        case pressio_option_int64_type:
+          option = zigzag();
+          break;
+        case pressio_option_uint16_type:
+          option = checked_varint<uint16_t>();
+          break;
+        case pressio_option_uint32_type:
+          option = checked_varint<uint32_t>();
+          break;
+        case pressio_option_uint64_type:
+          option = varint();
+          break;
+        case pressio_option_float_type:
+          option = raw<float>();
+          break;
+        case pressio_option_double_type:
+          option = raw<double>();
+          break;
+        case pressio_option_charptr_type:
+          option = string();
+          break;
+        case pressio_option_charptr_array_type:
+          {
+            size_t count = checked_varint<size_t>();
+            if(count > static_cast<size_t>(end - pos)) throw std::runtime_error("truncated binary options");
+            std::vector<std::string> values;
+            values.reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+              values.emplace_back(string());
+            }
+            option = std::move(values);
+          }
+          break;
+        case pressio_option_data_type:
+          option = pressio_option(data());
+          break;
+        case pressio_option_unset_type:
+        case pressio_option_userptr_type:
+          throw std::runtime_error("unexpected value for option type in binary options");
+      }
+      return option;
+    }
+
+    pressio_options options() {
+      auto header = bytes(sizeof(magic));
+      if(memcmp(header, magic, sizeof(magic)) != 0) throw std::runtime_error("not binary options");
+      if(byte() != format_version) throw std::runtime_error("unsupported binary options version");
+      if(byte() != native_byte_order()) throw std::runtime_error("binary options have a different byte order");
+      size_t entries = checked_varint<size_t>();
+      pressio_options options;
+      for (size_t i = 0; i < entries; ++i) {
+        std::string key = string();
+        options.insert(options.end(), {std::move(key), option()});
+      }
+      return options;
+    }
+
+    private:
+    const unsigned char* begin;
+    const unsigned char* end;
+    const unsigned char* pos;
+    payload_mode mode;
+    std::shared_ptr<pressio_data> owner;
+  };
+}
+
+size_t options_binary_size(pressio_options const& options) {
+  binary_writer sizer;
+  encode(sizer, options);
+  return sizer.size();
+}
+
+pressio_data options_to_binary(pressio_options const& options) {
+  auto buffer = pressio_data::owning(pressio_byte_dtype, {options_binary_size(options)});
+  binary_writer writer(static_cast<unsigned char*>(buffer.data()));
+  encode(writer, options);
+  return buffer;
+}
+
+pressio_options options_from_binary(const void* buffer, size_t size) {
+  return binary_reader(buffer, size, payload_mode::copy).options();
+}
+
+pressio_options options_from_binary_nocopy(const void* buffer, size_t size) {
+  return binary_reader(buffer, size, payload_mode::view).options();
+}
+
+pressio_options options_from_binary(pressio_data&& buffer) {
+  auto owner = std::make_shared<pressio_data>(std::move(buffer));
+  return binary_reader(owner->data(), owner->size_in_bytes(), payload_mode::shared, owner).options();
+}
+
+extern "C" {
+  struct pressio_data* pressio_options_to_binary(struct pressio* library, struct pressio_options const* options) {
+    try {
+      return new pressio_data(options_to_binary(*options));
+    } catch (std::exception const& ex) {
+      if(library) {
+        library->set_error(1, ex.what());
+      }
+    }
+    return nullptr;
+  }
+
+  struct pressio_options* pressio_options_new_binary(struct pressio* library, const void* buffer, size_t size) {
+    try {
+      return new pressio_options(options_from_binary(buffer, size));
+    } catch (std::exception const& ex) {
+      if(library) {
+        library->set_error(2, ex.what());
+      }
+    }
+    return nullptr;
+  }
+
+  struct pressio_options* pressio_options_new_binary_nocopy(struct pressio* library, const void* buffer, size_t size) {
+    try {
+      return new pressio_options(options_from_binary_nocopy(buffer, size));
+    } catch (std::exception const& ex) {
+      if(library) {
+        library->set_error(2, ex.what());
+      }
+    }
+    return nullptr;
+  }
+}
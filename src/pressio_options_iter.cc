@@ -1,10 +1,9 @@
-#include <map>
 #include <string>
 #include "libpressio_ext/cpp/options.h"
 
 struct pressio_options_iter {
   private:
-  using iterator_t =  std::map<std::string, pressio_option>::const_iterator;
+  using iterator_t =  pressio_options::const_iterator;
   public:
   pressio_options_iter(iterator_t current, iterator_t end): current(current), end(end) {}
   iterator_t current;
@@ -2,9 +2,15 @@
 #include <libpressio_ext/cpp/options.h>
 #include <libpressio_ext/cpp/pressio.h>
 #include <pressio_options.h>
+#include <libpressio_ext/cpp/json.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <vector>
 #include <stdexcept>
 #include <sstream>
+#include "std_compat/optional.h"
 
 void to_json(nlohmann::json& j, pressio_data const& data){
   j["dims"] = data.dimensions();
@@ -86,6 +92,7 @@ void from_json(nlohmann::json const& j, pressio_data& data) {
   std::vector<double> values = j.at("values");
   std::vector<size_t> dims = j.at("dims");
   auto dtype = static_cast<pressio_dtype>(j.at("dtype"));
+  if(pressio_dtype_size(dtype) <= 0) throw std::runtime_error("data has an invalid dtype");
 
   data = pressio_data::nonowning(
       pressio_double_dtype,
@@ -255,17 +262,697 @@ void from_json(nlohmann::json const& j, pressio_options& options) {
 
 
 
+namespace {
+  /**
+   * a number as reported by the parser, kept exact until the type it is stored as is known
+   */
+  struct json_number {
+    enum class kind { integer, unsigned_integer, floating };
+    kind type;
+    int64_t i;
+    uint64_t u;
+    double d;
+
+    template <class T>
+    T as() const {
+      switch(type) {
+        case kind::integer: return static_cast<T>(i);
+        case kind::unsigned_integer: return static_cast<T>(u);
+        default: return static_cast<T>(d);
+      }
+    }
+  };
+
+  /**
+   * accumulates the numbers of an array directly in a buffer of the requested dtype which
+   * is handed to a pressio_data without copying
+   */
+  class data_builder {
+    public:
+    data_builder()=default;
+    data_builder(data_builder const&)=delete;
+    data_builder& operator=(data_builder const&)=delete;
+    ~data_builder() { free(buffer); }
+
+    void reset(pressio_dtype new_dtype) {
+      free(buffer);
+      buffer = nullptr;
+      dtype = new_dtype;
+      count = 0;
+      capacity = 0;
+    }
+
+    void append(json_number const& n) {
+      if(count == capacity) {
+        size_t new_capacity = (capacity) ? capacity * 2 : 64;
+        void* tmp = realloc(buffer, new_capacity * pressio_dtype_size(dtype));
+        if(tmp == nullptr) throw std::bad_alloc();
+        buffer = tmp;
+        capacity = new_capacity;
+      }
+      switch(dtype) {
+        case pressio_double_dtype: store<double>(n); break;
+        case pressio_float_dtype: store<float>(n); break;
+        case pressio_uint8_dtype: store<uint8_t>(n); break;
+        case pressio_uint16_dtype: store<uint16_t>(n); break;
+        case pressio_uint32_dtype: store<uint32_t>(n); break;
+        case pressio_uint64_dtype: store<uint64_t>(n); break;
+        case pressio_int8_dtype: store<int8_t>(n); break;
+        case pressio_int16_dtype: store<int16_t>(n); break;
+        case pressio_int32_dtype: store<int32_t>(n); break;
+        case pressio_int64_dtype: store<int64_t>(n); break;
+        case pressio_byte_dtype: store<uint8_t>(n); break;
+      }
+      ++count;
+    }
+
+    size_t size() const { return count; }
+
+    pressio_data release(std::vector<size_t> const& dims) {
+      void* ptr = buffer;
+      buffer = nullptr;
+      count = 0;
+      capacity = 0;
+      if(ptr == nullptr) return pressio_data::owning(dtype, dims);
+      return pressio_data::move(dtype, ptr, dims, pressio_data_libc_free_fn, nullptr);
+    }
+
+    private:
+    template <class T>
+    void store(json_number const& n) {
+      static_cast<T*>(buffer)[count] = n.as<T>();
+    }
+
+    void* buffer = nullptr;
+    pressio_dtype dtype = pressio_double_dtype;
+    size_t count = 0;
+    size_t capacity = 0;
+  };
+
+  /**
+   * reports syntax errors, as opposed to std::runtime_error for unsupported content
+   */
+  struct json_syntax_error: public std::invalid_argument {
+    using std::invalid_argument::invalid_argument;
+  };
+
+  /**
+   * builds pressio_options from SAX events without an intermediate nlohmann::json document.
+   *
+   * Accepts the same documents as from_json(nlohmann::json const&, pressio_options&)
+   */
+  class options_sax {
+    public:
+    using number_integer_t = nlohmann::json::number_integer_t;
+    using number_unsigned_t = nlohmann::json::number_unsigned_t;
+    using number_float_t = nlohmann::json::number_float_t;
+    using string_t = nlohmann::json::string_t;
+    using binary_t = nlohmann::json::binary_t;
+
+    explicit options_sax(pressio_options& options): options(options) {}
+
+    bool null() {
+      switch(top()) {
+        case frame::root: options.set(option_key, pressio_option()); break;
+        case frame::typed: if(typed_field == "value") pending = pending_value{}; break;
+        case frame::array: throw std::runtime_error("other types are not supported");
+        default: break;
+      }
+      return true;
+    }
+    bool boolean(bool) {
+      if(top() == frame::array) throw std::runtime_error("other types are not supported");
+      //boolean entries are not supported and are skipped
+      return true;
+    }
+    bool number_integer(number_integer_t value) {
+      return number(json_number{json_number::kind::integer, value, 0, 0.0});
+    }
+    bool number_unsigned(number_unsigned_t value) {
+      return number(json_number{json_number::kind::unsigned_integer, 0, value, 0.0});
+    }
+    bool number_float(number_float_t value, string_t const&) {
+      return number(json_number{json_number::kind::floating, 0, 0, value});
+    }
+    bool string(string_t& value) {
+      switch(top()) {
+        case frame::root:
+          options.set(option_key, std::move(value));
+          break;
+        case frame::typed:
+          if(typed_field == "value") {
+            pending = pending_value{};
+            pending.kind = pending_value::kind_t::string;
+            pending.string = std::move(value);
+          }
+          break;
+        case frame::array:
+          if(array.elements == array_state::element::number || array.counts.size() > 1) {
+            throw std::runtime_error("unexpected array type");
+          }
+          array.elements = array_state::element::string;
+          ++array.counts.back();
+          array.strings.emplace_back(std::move(value));
+          break;
+        default:
+          break;
+      }
+      return true;
+    }
+    bool binary(binary_t&) {
+      throw std::runtime_error("binary values are not supported");
+    }
+
+    bool start_object(std::size_t) {
+      if(frames.empty()) {
+        frames.push_back(frame::root);
+        return true;
+      }
+      switch(top()) {
+        case frame::root:
+          typed_field.clear();
+          typed_type = compat::optional<pressio_option_type>();
+          pending = pending_value{};
+          frames.push_back(frame::typed);
+          break;
+        case frame::typed:
+          if(typed_field == "value") {
+            data_field.clear();
+            data_dims = compat::optional<std::vector<size_t>>();
+            data_dtype = compat::optional<pressio_dtype>();
+            data_values = compat::optional<pressio_data>();
+            frames.push_back(frame::data);
+          } else {
+            frames.push_back(frame::ignore);
+          }
+          break;
+        case frame::array:
+          throw std::runtime_error("other types are not supported");
+        default:
+          frames.push_back(frame::ignore);
+          break;
+      }
+      return true;
+    }
+    bool key(string_t& value) {
+      switch(top()) {
+        case frame::root: option_key = std::move(value); break;
+        case frame::typed: typed_field = std::move(value); break;
+        case frame::data: data_field = std::move(value); break;
+        default: break;
+      }
+      return true;
+    }
+    bool end_object() {
+      frame ended = top();
+      frames.pop_back();
+      if(ended == frame::typed) finish_typed();
+      else if(ended == frame::data) finish_data();
+      return true;
+    }
+
+    bool start_array(std::size_t) {
+      if(frames.empty()) throw std::runtime_error("expected a json object");
+      switch(top()) {
+        case frame::array:
+          ++array.counts.back();
+          break;
+        case frame::root:
+          begin_array(destination::option, pressio_double_dtype);
+          break;
+        case frame::typed:
+          if(typed_field != "value") {
+            frames.push_back(frame::ignore);
+            return true;
+          }
+          begin_array(destination::typed_value, pressio_double_dtype);
+          break;
+        case frame::data:
+          if(data_field == "dims") {
+            begin_array(destination::data_dims, pressio_uint64_dtype);
+          } else if(data_field == "values") {
+            begin_array(destination::data_values, data_dtype.value_or(pressio_double_dtype));
+          } else {
+            frames.push_back(frame::ignore);
+            return true;
+          }
+          break;
+        case frame::ignore:
+          frames.push_back(frame::ignore);
+          return true;
+      }
+      if(array.elements == array_state::element::string) throw std::runtime_error("unexpected array type");
+      const size_t depth = array.counts.size();
+      if(array.dims.size() <= depth) array.dims.push_back(0);
+      array.counts.push_back(0);
+      return true;
+    }
+    bool end_array() {
+      if(top() != frame::array) {
+        frames.pop_back();
+        return true;
+      }
+      array.dims[array.counts.size() - 1] = array.counts.back();
+      array.counts.pop_back();
+      if(array.counts.empty()) {
+        frames.pop_back();
+        finish_array();
+      }
+      return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, nlohmann::detail::exception const& ex) {
+      throw json_syntax_error(ex.what());
+    }
+
+    private:
+    enum class frame { root, typed, data, array, ignore };
+    enum class destination { option, typed_value, data_dims, data_values };
+
+    struct array_state {
+      enum class element { none, number, string };
+      destination dest;
+      element elements;
+      std::vector<size_t> dims;
+      std::vector<size_t> counts;
+      data_builder numbers;
+      std::vector<std::string> strings;
+    };
+
+    /**
+     * the value of a typed object, kept until both its type and value are known
+     */
+    struct pending_value {
+      enum class kind_t { none, number, string, strings, data };
+      kind_t kind = kind_t::none;
+      json_number number{json_number::kind::integer, 0, 0, 0.0};
+      std::string string;
+      std::vector<std::string> strings;
+      pressio_data data;
+    };
+
+    frame top() const {
+      if(frames.empty()) throw std::runtime_error("expected a json object");
+      return frames.back();
+    }
+
+    bool number(json_number const& value) {
+      switch(top()) {
+        case frame::root:
+          options.set(option_key, value.as<double>());
+          break;
+        case frame::typed:
+          if(typed_field == "type") {
+            typed_type = static_cast<pressio_option_type>(value.as<int64_t>());
+          } else if(typed_field == "value") {
+            pending = pending_value{};
+            pending.kind = pending_value::kind_t::number;
+            pending.number = value;
+          }
+          break;
+        case frame::data:
+          if(data_field == "dtype") {
+            auto dtype = static_cast<pressio_dtype>(value.as<int64_t>());
+            if(pressio_dtype_size(dtype) <= 0) throw std::runtime_error("data has an invalid dtype");
+            data_dtype = dtype;
+          }
+          break;
+        case frame::array:
+          if(array.elements == array_state::element::string) throw std::runtime_error("unexpected array type");
+          array.elements = array_state::element::number;
+          ++array.counts.back();
+          array.numbers.append(value);
+          break;
+        case frame::ignore:
+          break;
+      }
+      return true;
+    }
+
+    void begin_array(destination dest, pressio_dtype dtype) {
+      array.dest = dest;
+      array.elements = array_state::element::none;
+      array.dims.clear();
+      array.counts.clear();
+      array.strings.clear();
+      array.numbers.reset(dtype);
+      frames.push_back(frame::array);
+    }
+
+    void finish_array() {
+      if(array.elements == array_state::element::string) {
+        std::vector<std::string> strings = std::move(array.strings);
+        array.strings.clear();
+        switch(array.dest) {
+          case destination::option:
+            options.set(option_key, std::move(strings));
+            break;
+          case destination::typed_value:
+            pending = pending_value{};
+            pending.kind = pending_value::kind_t::strings;
+            pending.strings = std::move(strings);
+            break;
+          default:
+            throw std::runtime_error("unexpected array type");
+        }
+        return;
+      }
+
+      size_t expected = 1;
+      for (auto dim : array.dims) expected *= dim;
+      if(expected != array.numbers.size()) throw std::runtime_error("ragged arrays are not supported");
+      pressio_data data = array.numbers.release(array.dims);
+      switch(array.dest) {
+        case destination::option:
+          options.set(option_key, pressio_option(std::move(data)));
+          break;
+        case destination::typed_value:
+          pending = pending_value{};
+          pending.kind = pending_value::kind_t::data;
+          pending.data = std::move(data);
+          break;
+        case destination::data_dims:
+          data_dims = data.to_vector<size_t>();
+          break;
+        case destination::data_values:
+          data_values = std::move(data);
+          break;
+      }
+    }
+
+    void finish_data() {
+      if(!data_values) throw std::runtime_error("data is missing values");
+      pressio_data data = std::move(*data_values);
+      if(data_dims) {
+        if(data_size_in_elements(data_dims->size(), data_dims->data()) != data.num_elements()) {
+          throw std::runtime_error("data dims do not match the number of values");
+        }
+        data.reshape(*data_dims);
+      }
+      if(data_dtype && *data_dtype != data.dtype()) {
+        data = data.cast(*data_dtype);
+      }
+      pending = pending_value{};
+      pending.kind = pending_value::kind_t::data;
+      pending.data = std::move(data);
+    }
+
+    void finish_typed() {
+      if(!typed_type) throw std::runtime_error("typed option is missing its type");
+      pressio_option option;
+      const auto type = *typed_type;
+      if(pending.kind == pending_value::kind_t::none) {
+        if(type == pressio_option_userptr_type) throw std::runtime_error("userptr and unset ptr types are not convertible to nlohmann::json");
+        option.set_type(type);
+        options.set(option_key, option);
+        return;
+      }
+      auto require = [this](pending_value::kind_t kind) {
+        if(pending.kind != kind) throw std::runtime_error("typed option value does not match its type");
+      };
+      switch(type) {
+        case pressio_option_data_type:
+          require(pending_value::kind_t::data);
+          option = pressio_option(std::move(pending.data));
+          break;
+        case pressio_option_int8_type:
+          require(pending_value::kind_t::number);
+          option = pending.number.as<int8_t>();
+          break;
+        case pressio_option_int16_type:
+          require(pending_value::kind_t::number);
+          option = pending.number.as<int16_t>();
+          break;
+        case pressio_option_int32_type:
+          require(pending_value::kind_t::number);
+          option = pending.number.as<int32_t>();
+          break;
+        case pressio_option_int64_type:
+          require(pending_value::kind_t::number);
+          option = pending.number.as<int64_t>();
+          break;
+        case pressio_option_uint8_type:
+          require(pending_value::kind_t::number);
+          option = pending.number.as<uint8_t>();
+          break;
+        case pressio_option_uint16_type:
+          require(pending_value::kind_t::number);
+          option = pending.number.as<uint16_t>();
+          break;
+        case pressio_option_uint32_type:
+          require(pending_value::kind_t::number);
+          option = pending.number.as<uint32_t>();
+          break;
+        case pressio_option_uint64_type:
+          require(pending_value::kind_t::number);
+          option = pending.number.as<uint64_t>();
+          break;
+        case pressio_option_float_type:
+          require(pending_value::kind_t::number);
+          option = pending.number.as<float>();
+          break;
+        case pressio_option_double_type:
+          require(pending_value::kind_t::number);
+          option = pending.number.as<double>();
+          break;
+        case pressio_option_charptr_type:
+          require(pending_value::kind_t::string);
+          option = std::move(pending.string);
+          break;
+        case pressio_option_charptr_array_type:
+          require(pending_value::kind_t::strings);
+          option = std::move(pending.strings);
+          break;
+        case pressio_option_unset_type:
+          break;
+        case pressio_option_userptr_type:
+        default:
+          throw std::runtime_error("userptr and unset ptr types are not convertible to nlohmann::json");
+      }
+      options.set(option_key, option);
+    }
+
+    pressio_options& options;
+    std::vector<frame> frames;
+    std::string option_key, typed_field, data_field;
+    compat::optional<pressio_option_type> typed_type;
+    pending_value pending;
+    compat::optional<std::vector<size_t>> data_dims;
+    compat::optional<pressio_dtype> data_dtype;
+    compat::optional<pressio_data> data_values;
+    array_state array;
+  };
+
+  /**
+   * writes json directly to a string, formatting numbers in a stack buffer so that
+   * large arrays are written without allocating per element
+   */
+  class json_writer {
+    public:
+    explicit json_writer(std::string& out): out(out) {}
+
+    void raw(const char* str) { out.append(str); }
+    void raw(char c) { out.push_back(c); }
+
+    void string(std::string const& value) {
+      out.push_back('"');
+      for (char c : value) {
+        switch(c) {
+          case '"': out.append("\\\""); break;
+          case '\\': out.append("\\\\"); break;
+          case '\b': out.append("\\b"); break;
+          case '\f': out.append("\\f"); break;
+          case '\n': out.append("\\n"); break;
+          case '\r': out.append("\\r"); break;
+          case '\t': out.append("\\t"); break;
+          default:
+            if(static_cast<unsigned char>(c) < 0x20) {
+              char escaped[8];
+              snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+              out.append(escaped);
+            } else {
+              out.push_back(c);
+            }
+        }
+      }
+      out.push_back('"');
+    }
+
+    void number(int64_t value) {
+      char buffer[32];
+      int len = snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(value));
+      out.append(buffer, len);
+    }
+    void number(uint64_t value) {
+      char buffer[32];
+      int len = snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(value));
+      out.append(buffer, len);
+    }
+    void number(double value) {
+      if(!std::isfinite(value)) {
+        //json has no representation for non-finite values
+        out.append("null");
+        return;
+      }
+      //use the shortest of the common precisions that round trips
+      char buffer[32];
+      int len = snprintf(buffer, sizeof(buffer), "%.15g", value);
+      if(strtod(buffer, nullptr) != value) {
+        len = snprintf(buffer, sizeof(buffer), "%.17g", value);
+      }
+      out.append(buffer, len);
+    }
+    void number(float value) {
+      if(!std::isfinite(value)) {
+        out.append("null");
+        return;
+      }
+      char buffer[32];
+      int len = snprintf(buffer, sizeof(buffer), "%.7g", static_cast<double>(value));
+      if(strtof(buffer, nullptr) != value) {
+        len = snprintf(buffer, sizeof(buffer), "%.9g", static_cast<double>(value));
+      }
+      out.append(buffer, len);
+    }
+
+    template <class T>
+    void typed(pressio_option_type type, T value) {
+      raw("{\"type\":");
+      number(static_cast<uint64_t>(type));
+      raw(",\"value\":");
+      number(value);
+      raw('}');
+    }
+
+    void data(pressio_data const& data) {
+      raw("{\"dims\":[");
+      auto const& dims = data.dimensions();
+      for (size_t i = 0; i < dims.size(); ++i) {
+        if(i) raw(',');
+        number(static_cast<uint64_t>(dims[i]));
+      }
+      raw("],\"dtype\":");
+      number(static_cast<uint64_t>(data.dtype()));
+      raw(",\"values\":[");
+      if(data.has_data()) {
+        out.reserve(out.size() + data.num_elements() * 8);
+        switch(data.dtype()) {
+          case pressio_double_dtype: values<double, double>(data); break;
+          case pressio_float_dtype: values<float, float>(data); break;
+          case pressio_uint8_dtype: values<uint8_t, uint64_t>(data); break;
+          case pressio_uint16_dtype: values<uint16_t, uint64_t>(data); break;
+          case pressio_uint32_dtype: values<uint32_t, uint64_t>(data); break;
+          case pressio_uint64_dtype: values<uint64_t, uint64_t>(data); break;
+          case pressio_int8_dtype: values<int8_t, int64_t>(data); break;
+          case pressio_int16_dtype: values<int16_t, int64_t>(data); break;
+          case pressio_int32_dtype: values<int32_t, int64_t>(data); break;
+          case pressio_int64_dtype: values<int64_t, int64_t>(data); break;
+          case pressio_byte_dtype: values<uint8_t, uint64_t>(data); break;
+        }
+      }
+      raw("]}");
+    }
+
+    void option(pressio_option const& option) {
+      const auto type = option.type();
+      if(not option.has_value()) {
+        raw("{\"type\":");
+        number(static_cast<uint64_t>(type));
+        raw(",\"value\":null}");
+        return;
+      }
+      switch(type) {
+        case pressio_option_data_type:
+          raw("{\"type\":");
+          number(static_cast<uint64_t>(type));
+          raw(",\"value\":");
+          data(option.get_value<pressio_data>());
+          raw('}');
+          break;
+        case pressio_option_int8_type: typed(type, static_cast<int64_t>(option.get_value<int8_t>())); break;
+        case pressio_option_int16_type: typed(type, static_cast<int64_t>(option.get_value<int16_t>())); break;
+        case pressio_option_int32_type: typed(type, static_cast<int64_t>(option.get_value<int32_t>())); break;
+        case pressio_option_int64_type: typed(type, option.get_value<int64_t>()); break;
+        case pressio_option_uint8_type: typed(type, static_cast<uint64_t>(option.get_value<uint8_t>())); break;
+        case pressio_option_uint16_type: typed(type, static_cast<uint64_t>(option.get_value<uint16_t>())); break;
+        case pressio_option_uint32_type: typed(type, static_cast<uint64_t>(option.get_value<uint32_t>())); break;
+        case pressio_option_uint64_type: typed(type, option.get_value<uint64_t>()); break;
+        case pressio_option_float_type: typed(type, option.get_value<float>()); break;
+        case pressio_option_double_type:
+          //doubles and strings are represented directly in javascript
+          number(option.get_value<double>());
+          break;
+        case pressio_option_charptr_type:
+          string(option.get_value<std::string>());
+          break;
+        case pressio_option_charptr_array_type:
+          {
+            auto const& strings = option.get_value<std::vector<std::string>>();
+            raw('[');
+            for (size_t i = 0; i < strings.size(); ++i) {
+              if(i) raw(',');
+              string(strings[i]);
+            }
+            raw(']');
+          }
+          break;
+        case pressio_option_unset_type:
+          raw("{\"type\":6,\"value\":null}");
+          break;
+        case pressio_option_userptr_type:
+          throw std::runtime_error("userptr and unset ptr types are not convertible to JSON");
+      }
+    }
+
+    void options(pressio_options const& options) {
+      raw('{');
+      bool first = true;
+      for (auto const& it : options) {
+        if(it.second.type() == pressio_option_userptr_type) continue;
+        if(!first) raw(',');
+        first = false;
+        string(it.first);
+        raw(':');
+        option(it.second);
+      }
+      raw('}');
+    }
+
+    private:
+    template <class T, class Formatted>
+    void values(pressio_data const& data) {
+      auto const* ptr = static_cast<T const*>(data.data());
+      const size_t n = data.num_elements();
+      for (size_t i = 0; i < n; ++i) {
+        if(i) raw(',');
+        number(static_cast<Formatted>(ptr[i]));
+      }
+    }
+
+    std::string& out;
+  };
+}
+
+pressio_options options_from_json(const char* json, size_t size) {
+  pressio_options options;
+  options_sax handler(options);
+  nlohmann::json::sax_parse(json, json + size, &handler);
+  return options;
+}
+
+std::string options_to_json(pressio_options const& options) {
+  std::string out;
+  json_writer writer(out);
+  writer.options(options);
+  return out;
+}
+
 extern "C" {
   struct pressio_options* pressio_options_new_json(struct pressio* library, const char* json) {
     pressio_options* options = nullptr;
     try {
-      nlohmann::json parsed = nlohmann::json::parse(json);
-      options = new pressio_options(parsed.get<pressio_options>());
-    } catch (nlohmann::detail::out_of_range& ex) {
-      if(library) {
-        library->set_error(2, ex.what());
-      }
-    } catch (nlohmann::detail::parse_error& ex) {
+      options = new pressio_options(options_from_json(json, strlen(json)));
+    } catch (json_syntax_error& ex) {
       if(library) {
         std::stringstream err_msg;
         err_msg << ex.what() << "\n" << json;
@@ -282,8 +969,7 @@ extern "C" {
   char* pressio_options_to_json(struct pressio* library, struct pressio_options const* options) {
     char* ret = nullptr;
     try {
-      nlohmann::json jstr = *options;
-      std::string str = jstr.dump();
+      std::string str = options_to_json(*options);
       ret = strdup(str.c_str());
     } catch (std::runtime_error& ex) {
       if(library) {
@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iterator>
+#include <set>
+#include <dirent.h>
+#include <dlfcn.h>
+#include "pressio.h"
+#include "libpressio_ext/cpp/pressio.h"
+#include "libpressio_ext/cpp/plugin_loader.h"
+#include "libpressio_ext/cpp/startup.h"
+#include "libpressio_ext/launch/external_launch.h"
+
+namespace {
+  const std::string module_prefix = "libpressio_plugin_";
+
+  template <class Registry>
+  void registered_names(std::set<std::string>& names, std::string const& kind, Registry const& registry) {
+    for (auto const& entry : registry.current()) {
+      names.emplace(kind + ":" + entry.first);
+    }
+  }
+
+  std::set<std::string> registered_names() {
+    std::set<std::string> names;
+    registered_names(names, "compressor", compressor_plugins());
+    registered_names(names, "metric", metrics_plugins());
+    registered_names(names, "io", io_plugins());
+    registered_names(names, "launch", launch_plugins());
+    return names;
+  }
+
+  std::vector<std::string> split_path(const char* path) {
+    std::vector<std::string> directories;
+    if(path == nullptr) return directories;
+    std::string remaining(path);
+    size_t pos;
+    while((pos = remaining.find(':')) != std::string::npos) {
+      if(pos != 0) directories.emplace_back(remaining.substr(0, pos));
+      remaining.erase(0, pos + 1);
+    }
+    if(!remaining.empty()) directories.emplace_back(std::move(remaining));
+    return directories;
+  }
+
+  /**
+   * \returns the plugin name for a module file name, or the empty string if it is not a module
+   */
+  std::string module_name(std::string const& filename) {
+    if(filename.compare(0, module_prefix.size(), module_prefix) != 0) return "";
+    const auto dot = filename.find('.', module_prefix.size());
+    if(dot == std::string::npos) return "";
+    const std::string extension = filename.substr(dot);
+    if(extension.compare(0, 3, ".so") != 0 && extension != ".dylib") return "";
+    return filename.substr(module_prefix.size(), dot - module_prefix.size());
+  }
+
+  /**
+   * looks up names missing from the registries on the search path
+   */
+  struct install_fallbacks {
+    install_fallbacks() {
+      auto load_for = [](std::string const& name) { return plugin_loader().load_for(name); };
+      compressor_plugins().set_fallback(load_for);
+      metrics_plugins().set_fallback(load_for);
+      io_plugins().set_fallback(load_for);
+      launch_plugins().set_fallback(load_for);
+    }
+  } fallbacks;
+}
+
+pressio_plugin_loader& plugin_loader() {
+  static pressio_plugin_loader loader;
+  return loader;
+}
+
+std::vector<std::string> pressio_plugin_loader::search_path() const {
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  if(has_search_path) return directories;
+  return split_path(getenv("LIBPRESSIO_PLUGIN_PATH"));
+}
+
+void pressio_plugin_loader::set_search_path(std::vector<std::string> const& new_directories) {
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  directories = new_directories;
+  has_search_path = true;
+  scanned = false;
+  path_for_name.clear();
+  for (auto it = by_path.begin(); it != by_path.end();) {
+    if(it->second.loaded) ++it;
+    else it = by_path.erase(it);
+  }
+}
+
+void pressio_plugin_loader::scan() {
+  if(scanned) return;
+  scanned = true;
+  for (auto const& directory : search_path()) {
+    DIR* dir = opendir(directory.c_str());
+    if(dir == nullptr) continue;
+    while(dirent* entry = readdir(dir)) {
+      const std::string name = module_name(entry->d_name);
+      if(name.empty() || path_for_name.count(name)) continue;
+      const std::string path = directory + "/" + entry->d_name;
+      path_for_name.emplace(name, path);
+      auto& module = by_path[path];
+      module.path = path;
+      module.name = name;
+    }
+    closedir(dir);
+  }
+}
+
+int pressio_plugin_loader::load(std::string const& path, std::string* error_msg) {
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  auto& module = by_path[path];
+  if(module.loaded) return 0;
+  module.path = path;
+  if(module.name.empty()) {
+    const auto slash = path.rfind('/');
+    module.name = module_name(path.substr((slash == std::string::npos) ? 0 : slash + 1));
+  }
+
+  const auto before = registered_names();
+  const auto begin = std::chrono::steady_clock::now();
+  void* handle;
+  {
+    pressio_startup_timer timer("load:" + path);
+    //modules are never unloaded since the plugins they register refer to their code
+    handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  }
+  const auto end = std::chrono::steady_clock::now();
+  if(handle == nullptr) {
+    const char* err = dlerror();
+    module.error = (err) ? err : "failed to load " + path;
+    if(error_msg) *error_msg = module.error;
+    return 1;
+  }
+  module.loaded = true;
+  module.error.clear();
+  module.load_seconds = std::chrono::duration<double>(end - begin).count();
+  const auto after = registered_names();
+  module.provides.clear();
+  std::set_difference(after.begin(), after.end(), before.begin(), before.end(), std::back_inserter(module.provides));
+  return 0;
+}
+
+bool pressio_plugin_loader::load_for(std::string const& name) {
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  scan();
+  auto path = path_for_name.find(name);
+  if(path == path_for_name.end() || by_path[path->second].loaded) return false;
+  return load(path->second) == 0;
+}
+
+std::vector<pressio_plugin_module> pressio_plugin_loader::modules() const {
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  std::vector<pressio_plugin_module> modules;
+  for (auto const& module : by_path) {
+    modules.emplace_back(module.second);
+  }
+  return modules;
+}
+
+extern "C" {
+int pressio_load_plugin(struct pressio* library, const char* path) {
+  std::string error_msg;
+  if(plugin_loader().load(path, &error_msg)) {
+    if(library) library->set_error(1, error_msg);
+    return 1;
+  }
+  return 0;
+}
+}
@@ -2,6 +2,9 @@
 #include <cstring>
 #include <algorithm>
 #include <errno.h>
+#include <unistd.h>
+#include "libpressio_ext/cpp/data.h"
+#include "pressio_posix.h"
 
 std::string errno_to_error() {
     // gnulibc insists on providing their implementation
@@ -25,3 +28,95 @@ std::string errno_to_error() {
     else return "failed to get error msg";
 #endif
 }
+
+bool pressio_region_valid(std::vector<size_t> const& dims,
+    std::vector<size_t> const& start,
+    std::vector<size_t> const& stride,
+    std::vector<size_t> const& count,
+    std::vector<size_t> const& block) {
+  if(dims.empty()) return false;
+  if(start.size() != dims.size() ||
+     stride.size() != dims.size() ||
+     count.size() != dims.size() ||
+     block.size() != dims.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < dims.size(); ++i) {
+    if(count[i] < 1 || block[i] < 1 || stride[i] < 1) return false;
+    //the last element selected in this dimension must be within the array
+    if(start[i] + (count[i] - 1) * stride[i] + block[i] > dims[i]) return false;
+  }
+  return true;
+}
+
+bool pressio_pread_region(int fd, size_t offset,
+    std::vector<size_t> const& dims,
+    std::vector<size_t> const& start,
+    std::vector<size_t> const& stride,
+    std::vector<size_t> const& count,
+    std::vector<size_t> const& block,
+    pressio_data& out) {
+  const size_t ndims = dims.size();
+  const size_t elm_size = pressio_dtype_size(out.dtype());
+  std::vector<size_t> out_dims(ndims), global_stride(ndims), out_stride(ndims);
+  for (size_t i = 0, g = 1, o = 1; i < ndims; ++i) {
+    out_dims[i] = count[i] * block[i];
+    global_stride[i] = g;
+    out_stride[i] = o;
+    g *= dims[i];
+    o *= out_dims[i];
+  }
+
+  //a dimension is contiguous in the file if its blocks abut each other, and the following
+  //dimension can be merged into the same read if this one spans the entire array
+  size_t run = 1;
+  size_t first_outer = 0;
+  while(first_outer < ndims) {
+    const bool contiguous = count[first_outer] == 1 || stride[first_outer] == block[first_outer];
+    if(!contiguous) break;
+    run *= out_dims[first_outer];
+    const bool spans = start[first_outer] == 0 && out_dims[first_outer] == dims[first_outer];
+    ++first_outer;
+    if(!spans) break;
+  }
+  //when the fastest dimension has gaps, read it one block at a time
+  std::vector<size_t> step(ndims, 1);
+  if(first_outer == 0) {
+    run = block[0];
+    step[0] = block[0];
+  }
+
+  std::vector<size_t> pos(ndims, 0);
+  uint8_t* dst = static_cast<uint8_t*>(out.data());
+  const size_t run_bytes = run * elm_size;
+  while(true) {
+    size_t src_offset = 0, dst_offset = 0;
+    for (size_t i = 0; i < ndims; ++i) {
+      const size_t src_idx = start[i] + (pos[i] / block[i]) * stride[i] + pos[i] % block[i];
+      src_offset += src_idx * global_stride[i];
+      dst_offset += pos[i] * out_stride[i];
+    }
+
+    size_t total_read = 0;
+    while(total_read < run_bytes) {
+      ssize_t bytes_read = pread(fd,
+          dst + dst_offset * elm_size + total_read,
+          run_bytes - total_read,
+          static_cast<off_t>(offset + src_offset * elm_size + total_read)
+          );
+      if(bytes_read < 0 && errno == EINTR) continue;
+      if(bytes_read <= 0) return false;
+      total_read += static_cast<size_t>(bytes_read);
+    }
+
+    //advance to the next run, odometer style over the dimensions not covered by the run
+    size_t dim = first_outer;
+    for(; dim < ndims; ++dim) {
+      pos[dim] += step[dim];
+      if(pos[dim] < out_dims[dim]) break;
+      pos[dim] = 0;
+    }
+    if(dim == ndims) break;
+  }
+  return true;
+}
@@ -1,2 +1,44 @@
 #include <string>
+#include <vector>
+#include <cstddef>
 std::string errno_to_error();
+
+struct pressio_data;
+
+/**
+ * checks that a selection of blocks lies within an array of the given dimensions
+ *
+ * \param[in] dims the dimensions of the full array
+ * \param[in] start the position in the array to start at
+ * \param[in] stride the number of elements between the first elements of each block
+ * \param[in] count the number of blocks in each direction
+ * \param[in] block the dimensions of each block
+ * \returns true if the selection is valid
+ */
+bool pressio_region_valid(std::vector<size_t> const& dims,
+    std::vector<size_t> const& start,
+    std::vector<size_t> const& stride,
+    std::vector<size_t> const& count,
+    std::vector<size_t> const& block);
+
+/**
+ * reads a selection of blocks from an array stored contiguously in a file using pread,
+ * coalescing adjacent elements into as few reads as possible
+ *
+ * \param[in] fd the file descriptor to read from; its offset is not modified
+ * \param[in] offset the offset in bytes of the first element of the array in the file
+ * \param[in] dims the dimensions of the full array
+ * \param[in] start the position in the array to start at
+ * \param[in] stride the number of elements between the first elements of each block
+ * \param[in] count the number of blocks in each direction
+ * \param[in] block the dimensions of each block
+ * \param[out] out an allocated buffer with the dimensions count[i]*block[i] to read into
+ * \returns true on success, false on failure with errno set if the failure was from pread
+ */
+bool pressio_pread_region(int fd, size_t offset,
+    std::vector<size_t> const& dims,
+    std::vector<size_t> const& start,
+    std::vector<size_t> const& stride,
+    std::vector<size_t> const& count,
+    std::vector<size_t> const& block,
+    pressio_data& out);
@@ -0,0 +1,86 @@
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <unistd.h>
+#include "pressio.h"
+#include "pressio_options.h"
+#include "libpressio_ext/cpp/data.h"
+#include "libpressio_ext/cpp/options.h"
+#include "libpressio_ext/cpp/startup.h"
+
+namespace {
+  struct startup_log {
+    std::mutex lock;
+    std::vector<pressio_startup_event> events;
+    bool profile_memory = getenv("LIBPRESSIO_PROFILE_STARTUP") != nullptr;
+  };
+
+  startup_log& log() {
+    static startup_log log;
+    return log;
+  }
+
+  /**
+   * \returns the resident set size in bytes, or 0 if it is not being recorded
+   */
+  int64_t resident_bytes() {
+    if(!log().profile_memory) return 0;
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if(statm == nullptr) return 0;
+    long size = 0, resident = 0;
+    const int matched = fscanf(statm, "%ld %ld", &size, &resident);
+    fclose(statm);
+    if(matched != 2) return 0;
+    return static_cast<int64_t>(resident) * sysconf(_SC_PAGESIZE);
+  }
+}
+
+pressio_startup_timer::pressio_startup_timer(std::string name):
+  name(std::move(name)),
+  rss_begin(resident_bytes()),
+  begin(std::chrono::steady_clock::now())
+{}
+
+pressio_startup_timer::~pressio_startup_timer() {
+  const auto end = std::chrono::steady_clock::now();
+  const int64_t rss_end = resident_bytes();
+  auto& startup = log();
+  std::lock_guard<std::mutex> guard(startup.lock);
+  startup.events.push_back(pressio_startup_event{
+      std::move(name),
+      std::chrono::duration<double>(end - begin).count(),
+      rss_end - rss_begin
+  });
+}
+
+std::vector<pressio_startup_event> pressio_startup_events() {
+  auto& startup = log();
+  std::lock_guard<std::mutex> guard(startup.lock);
+  return startup.events;
+}
+
+extern "C" {
+struct pressio_options* pressio_startup_report() {
+  const auto events = pressio_startup_events();
+  std::vector<std::string> names;
+  std::vector<double> seconds;
+  std::vector<int64_t> rss_bytes;
+  names.reserve(events.size());
+  seconds.reserve(events.size());
+  rss_bytes.reserve(events.size());
+  double total = 0;
+  for (auto const& event : events) {
+    names.emplace_back(event.name);
+    seconds.emplace_back(event.seconds);
+    rss_bytes.emplace_back(event.rss_bytes);
+    total += event.seconds;
+  }
+
+  auto report = new pressio_options;
+  report->set("startup:names", names);
+  report->set("startup:seconds", pressio_data(seconds.begin(), seconds.end()));
+  report->set("startup:rss_bytes", pressio_data(rss_bytes.begin(), rss_bytes.end()));
+  report->set("startup:total_seconds", total);
+  return report;
+}
+}
@@ -1,6 +1,7 @@
 #include "libpressio_ext/cpp/serializable.h"
 #include <libpressio_ext/cpp/data.h>
 #include <libpressio_ext/cpp/options.h>
+#include <libpressio_ext/cpp/binary.h>
 #include <cassert>
 #include <stdexcept>
 
@@ -465,35 +466,44 @@ namespace serializer {
     return ret;
   }
 
-  int serializer<pressio_options>::send(pressio_options const& option, int dest, int tag, MPI_Comm comm) {
-    int ret = 0;
-    std::vector<std::pair<std::string, pressio_option>> options_v(std::begin(option), std::end(option));
-    ret |= comm::send(options_v, dest, tag, comm);
-    return ret;
+  int serializer<pressio_options>::send(pressio_options const& options, int dest, int tag, MPI_Comm comm) {
+    //send the options as a single binary message rather than one message per option
+    return comm::send(options_to_binary(options), dest, tag, comm);
   }
 
   int serializer<pressio_options>::recv(pressio_options& options, int source, int tag, MPI_Comm comm, MPI_Status* status) {
     int ret = 0;
-    std::vector<std::pair<std::string, pressio_option>> options_v;
-    ret |= comm::recv(options_v, source, tag, comm, status);
-    std::move(std::begin(options_v), std::end(options_v), std::inserter(options, options.end()));
+    pressio_data encoded;
+    ret |= comm::recv(encoded, source, tag, comm, status);
+    if(ret) return ret;
+    try {
+      pressio_options received = options_from_binary(std::move(encoded));
+      std::move(std::begin(received), std::end(received), std::inserter(options, options.end()));
+    } catch(std::runtime_error const&) {
+      return 1;
+    }
     return ret;
   }
 
   int serializer<pressio_options>::bcast(pressio_options& options, int root, MPI_Comm comm) {
     int ret = 0;
     int rank;
-    MPI_Comm_size(comm, &rank);
-    std::vector<std::pair<std::string, pressio_option>> options_v;
+    MPI_Comm_rank(comm, &rank);
+    pressio_data encoded;
 
     if(rank == root) {
-      std::copy(std::begin(options), std::end(options), std::back_inserter(options_v));
+      encoded = options_to_binary(options);
     }
 
-    comm::bcast(options_v, root, comm);
+    ret |= comm::bcast(encoded, root, comm);
 
-    if(rank != root) {
-      std::move(std::begin(options_v), std::end(options_v), std::inserter(options, options.begin()));
+    if(rank != root && ret == 0) {
+      try {
+        pressio_options received = options_from_binary(std::move(encoded));
+        std::move(std::begin(received), std::end(received), std::inserter(options, options.begin()));
+      } catch(std::runtime_error const&) {
+        return 1;
+      }
     }
 
     return ret;
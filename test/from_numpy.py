@@ -5,7 +5,7 @@ sys.path.insert(0, pressio_path)
 import pressio
 import numpy as np
 
-SIZES = [(3,), (3,5), (3,5,7), (3,5,7,11)]
+SIZES = [(3,), (3,5), (3,5,7), (3,5,7,11), (3,5,7,11,2)]
 FLOAT_DTYPES = [np.float32, np.float64]
 INT_DTYPES = [np.int8, np.int16, np.int32, np.int64, np.uint8, np.uint16, np.uint32, np.uint64]
 rng = np.random.default_rng()
@@ -22,8 +22,12 @@ def convert_back_and_forth(nd_array):
     try:
         p_data = pressio.io_data_from_numpy(nd_array)
         n_data = pressio.io_data_to_numpy(p_data)
+        m_data = pressio.io_data_move_to_numpy(p_data)
         pressio.data_free(p_data)
         assert np.array_equal(nd_array, n_data), f"FAILED nd_array size={nd_array.shape}, dtype={nd_array.dtype}"
+        assert np.array_equal(nd_array, m_data), f"FAILED move nd_array size={nd_array.shape}, dtype={nd_array.dtype}"
+        if nd_array.flags.c_contiguous:
+            assert np.shares_memory(nd_array, m_data), f"FAILED zero-copy nd_array size={nd_array.shape}, dtype={nd_array.dtype}"
     except (AssertionError,TypeError) as e:
         print(e)
         global FAILED
@@ -39,5 +43,9 @@ for size in SIZES:
         test_float(float_dtype, size)
     for int_dtype in INT_DTYPES:
         test_integer(int_dtype, size)
+
+# non-contiguous arrays are copied
+convert_back_and_forth(rng.random(size=(6,5), dtype=np.float64)[::2])
+convert_back_and_forth(rng.random(size=(6,5), dtype=np.float32).T)
 print("PASSED=", PASSED, "FAILED=", FAILED)
 sys.exit(FAILED != 0)
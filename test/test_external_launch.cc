@@ -0,0 +1,295 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <set>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "libpressio_ext/launch/external_launch.h"
+#include "libpressio_ext/cpp/options.h"
+#include "libpressio_ext/cpp/libpressio.h"
+
+namespace {
+  double result(extern_proc_results const& results, std::string const& name) {
+    auto pos = results.proc_stdout.find(name + "=");
+    if(pos == std::string::npos) return -1;
+    return std::stod(results.proc_stdout.substr(pos + name.size() + 1));
+  }
+}
+
+TEST(ExternalWorker, ReusesTheWorkerAcrossJobs) {
+  pressio_launcher launcher = launch_plugins().build("worker");
+  ASSERT_TRUE(launcher);
+  launcher->set_options({{"external:commands", std::vector<std::string>{WORKER_HELPER}}});
+
+  auto defaults = launcher->launch({});
+  EXPECT_EQ(defaults.error_code, success);
+  EXPECT_EQ(result(defaults, "defaulted"), 2.0);
+
+  auto first = launcher->launch({"--input", "has a space", "--dim", "3"});
+  auto second = launcher->launch({"--input", "x"});
+  ASSERT_EQ(first.error_code, success);
+  ASSERT_EQ(second.error_code, success);
+  EXPECT_EQ(result(first, "jobs"), 2);
+  EXPECT_EQ(result(second, "jobs"), 3);
+  EXPECT_EQ(result(first, "nargs"), 4);
+  EXPECT_EQ(result(first, "pid"), result(second, "pid"));
+  EXPECT_EQ(second.proc_stderr, "job 3\n");
+}
+
+TEST(ExternalWorker, RestartsFailedWorkers) {
+  pressio_launcher launcher = launch_plugins().build("worker");
+  launcher->set_options({
+      {"external:commands", std::vector<std::string>{WORKER_HELPER}},
+      {"external:worker_timeout", 0.5},
+      {"external:worker_max_restarts", 0u},
+  });
+
+  auto before = launcher->launch({"--input", "x"});
+  auto crashed = launcher->launch({"--crash"});
+  EXPECT_NE(crashed.error_code, success);
+  auto hung = launcher->launch({"--hang"});
+  EXPECT_NE(hung.error_code, success);
+
+  auto after = launcher->launch({"--input", "x"});
+  ASSERT_EQ(after.error_code, success);
+  EXPECT_EQ(result(after, "jobs"), 1);
+  EXPECT_NE(result(before, "pid"), result(after, "pid"));
+}
+
+TEST(ExternalWorker, RecyclesWorkersAfterMaxJobs) {
+  pressio_launcher launcher = launch_plugins().build("worker");
+  launcher->set_options({
+      {"external:commands", std::vector<std::string>{WORKER_HELPER}},
+      {"external:worker_max_jobs", uint64_t{2}},
+  });
+  std::vector<double> jobs;
+  for (int i = 0; i < 4; ++i) {
+    jobs.push_back(result(launcher->launch({"--input", "x"}), "jobs"));
+  }
+  EXPECT_EQ(jobs, (std::vector<double>{1, 2, 1, 2}));
+}
+
+TEST(ExternalWorker, KeepsWorkersAcrossBatches) {
+  pressio_launcher launcher = launch_plugins().build("worker");
+  launcher->set_options({{"external:commands", std::vector<std::string>{WORKER_HELPER}}});
+  const std::vector<std::vector<std::string>> batch(4, std::vector<std::string>{"--input", "x"});
+
+  auto pids = [&]{
+    std::set<double> found;
+    for (auto const& results : launcher->launch_many(batch, 2)) {
+      EXPECT_EQ(results.error_code, success);
+      found.insert(result(results, "pid"));
+    }
+    return found;
+  };
+  auto first = pids();
+  auto second = pids();
+  EXPECT_LE(first.size(), 2);
+  EXPECT_EQ(first, second);
+
+  //plain launches reuse the first of the workers
+  EXPECT_EQ(first.count(result(launcher->launch({"--input", "x"}), "pid")), 1);
+}
+
+TEST(ExternalForkexec, RunsJobsConcurrently) {
+  pressio_launcher launcher = launch_plugins().build("forkexec");
+  launcher->set_options({{"external:commands", std::vector<std::string>{"/bin/sh", "-c"}}});
+  std::vector<std::vector<std::string>> jobs;
+  for (int i = 0; i < 4; ++i) {
+    jobs.push_back({"sleep 0.5; echo external:api=5; echo job=" + std::to_string(i)});
+  }
+
+  auto begin = std::chrono::steady_clock::now();
+  auto results = launcher->launch_many(jobs, 4);
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+  ASSERT_EQ(results.size(), 4);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(results[i].error_code, success);
+    EXPECT_EQ(result(results[i], "job"), i);
+  }
+  //run one at a time the jobs take at least 2 seconds
+  EXPECT_LT(elapsed, 1.5);
+}
+
+TEST(ExternalForkexec, ReadsLargeOutputsFromBothStreams) {
+  pressio_launcher launcher = launch_plugins().build("forkexec");
+  launcher->set_options({{"external:commands", std::vector<std::string>{"/bin/sh", "-c"}}});
+  auto results = launcher->launch_many({
+      {"head -c 1000000 /dev/zero >&2; head -c 1000000 /dev/zero; exit 3"},
+      {"head -c 1000000 /dev/zero; head -c 1000000 /dev/zero >&2"},
+      }, 2);
+  ASSERT_EQ(results.size(), 2);
+  for (auto const& result : results) {
+    EXPECT_EQ(result.proc_stdout.size(), 1000000);
+    EXPECT_EQ(result.proc_stderr.size(), 1000000);
+  }
+  EXPECT_EQ(results[0].return_code, 3);
+  EXPECT_EQ(results[1].return_code, 0);
+}
+
+TEST(ExternalForkexec, DrainsOthersWhileAChildOutlivesItsOutputs) {
+  pressio_launcher launcher = launch_plugins().build("forkexec");
+  launcher->set_options({{"external:commands", std::vector<std::string>{"/bin/sh", "-c"}}});
+  std::string flag("test_forkexec_flagXXXXXX");
+  close(mkstemp(&flag[0]));
+  unlink(flag.c_str());
+
+  //the first child waits (for at most 5 seconds) on the second, which fills its pipe before it finishes
+  auto begin = std::chrono::steady_clock::now();
+  auto results = launcher->launch_many({
+      {"exec >&- 2>&-; i=0; while [ ! -e " + flag + " ] && [ $i -lt 100 ]; do sleep 0.05; i=$((i+1)); done"},
+      {"head -c 1000000 /dev/zero; touch " + flag},
+      }, 2);
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+  unlink(flag.c_str());
+
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_EQ(results[0].return_code, 0);
+  EXPECT_EQ(results[1].proc_stdout.size(), 1000000);
+  EXPECT_LT(elapsed, 3);
+}
+
+TEST(ExternalForkexec, StopsJobsThatTimeOut) {
+  pressio_launcher launcher = launch_plugins().build("forkexec");
+  launcher->set_options({
+      {"external:commands", std::vector<std::string>{"/bin/sh", "-c"}},
+      {"external:timeout", 0.3},
+      {"external:timeout_grace", 0.3},
+  });
+
+  auto begin = std::chrono::steady_clock::now();
+  auto results = launcher->launch_many({
+      {"echo started; sleep 30"},
+      {"trap '' TERM; sleep 30"},
+      {"echo external:api=5"},
+      }, 3);
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+  EXPECT_LT(elapsed, 5);
+
+  ASSERT_EQ(results.size(), 3);
+  EXPECT_TRUE(results[0].timed_out);
+  EXPECT_EQ(results[0].error_code, timeout_error);
+  EXPECT_EQ(results[0].proc_stdout, "started\n");
+  EXPECT_TRUE(results[1].timed_out);
+  EXPECT_EQ(results[1].return_code, 128 + 9);
+  EXPECT_FALSE(results[2].timed_out);
+  EXPECT_EQ(results[2].error_code, success);
+  EXPECT_EQ(results[2].proc_stdout, "external:api=5\n");
+  EXPECT_GT(results[2].max_rss, 0);
+}
+
+namespace {
+  pressio_options evaluate_external(pressio_options const& options) {
+    pressio library;
+    auto compressor = library.get_compressor("noop");
+    const char* metrics_ids[] = {"external"};
+    auto metrics = pressio_metrics(library.get_metrics(std::begin(metrics_ids), std::end(metrics_ids)));
+    compressor->set_metrics(metrics);
+    compressor->set_metrics_options({
+        {"external:launch_method", std::string("worker")},
+        {"external:command", std::string(WORKER_HELPER)},
+    });
+    compressor->set_metrics_options(options);
+
+    auto input = pressio_data{1.0, 2.0, 3.0, 4.0};
+    auto compressed = pressio_data::empty(pressio_byte_dtype, {});
+    auto decompressed = pressio_data::empty(pressio_double_dtype, {4});
+    EXPECT_EQ(compressor->compress(&input, &compressed), 0);
+    EXPECT_EQ(compressor->decompress(&compressed, &decompressed), 0);
+    return compressor->get_metrics_results();
+  }
+
+  double metric(pressio_options const& results, std::string const& name) {
+    double value = -1;
+    results.get("external:results:" + name, &value);
+    return value;
+  }
+}
+
+TEST(ExternalMetric, HandsDataOverSharedMemory) {
+  auto results = evaluate_external({{"external:transport", std::string("shm")}});
+  EXPECT_EQ(metric(results, "shm"), 1);
+  EXPECT_EQ(metric(results, "input_shm_sum"), 10);
+  EXPECT_EQ(metric(results, "decompressed_shm_sum"), 10);
+  //the path passed with --input refers to the same data
+  EXPECT_EQ(metric(results, "input_sum"), 10);
+  EXPECT_EQ(metric(results, "decompressed_sum"), 10);
+}
+
+TEST(ExternalMetric, HandsDataOverFilesWhenRequested) {
+  auto results = evaluate_external({{"external:transport", std::string("file")}});
+  EXPECT_EQ(metric(results, "shm"), 0);
+  EXPECT_EQ(metric(results, "input_sum"), 10);
+  EXPECT_EQ(metric(results, "decompressed_sum"), 10);
+}
+
+TEST(ExternalMetric, DefaultsToFiles) {
+  auto results = evaluate_external({});
+  EXPECT_EQ(metric(results, "shm"), 0);
+  EXPECT_EQ(metric(results, "input_sum"), 10);
+}
+
+TEST(ExternalMetric, PassesBinaryRequests) {
+  auto results = evaluate_external({{"external:args_format", std::string("binary")}});
+  EXPECT_EQ(metric(results, "nargs"), 4);
+  EXPECT_EQ(metric(results, "input_sum"), 10);
+  EXPECT_EQ(metric(results, "decompressed_sum"), 10);
+}
+
+TEST(ExternalMetric, ReportsUndecodableOutput) {
+  auto results = evaluate_external({
+      {"external:args_format", std::string("binary")},
+      {"external:config_name", std::string("corrupt")},
+  });
+  int32_t error_code = 0;
+  std::string error_msg;
+  results.get("external:error_code", &error_code);
+  results.get("external:error_msg", &error_msg);
+  EXPECT_EQ(error_code, format_error);
+  EXPECT_FALSE(error_msg.empty());
+}
+
+TEST(ExternalMetric, EvaluatesEachGroupOfABatch) {
+  pressio library;
+  auto compressor = library.get_compressor("noop");
+  const char* metrics_ids[] = {"external"};
+  auto metrics = pressio_metrics(library.get_metrics(std::begin(metrics_ids), std::end(metrics_ids)));
+  compressor->set_metrics(metrics);
+  compressor->set_metrics_options({
+      {"external:launch_method", std::string("worker")},
+      {"external:command", std::string(WORKER_HELPER)},
+      {"external:use_many", 1},
+      {"external:max_concurrency", 3u},
+  });
+
+  std::vector<pressio_data> inputs{
+    pressio_data{1.0, 2.0},
+    pressio_data{3.0, 4.0},
+    pressio_data{5.0, 6.0},
+  };
+  std::vector<pressio_data> compressed(3, pressio_data::empty(pressio_byte_dtype, {}));
+  std::vector<pressio_data> decompressed(3, pressio_data::empty(pressio_double_dtype, {2}));
+  std::vector<const pressio_data*> input_ptrs, compressed_cptrs;
+  std::vector<pressio_data*> compressed_ptrs, decompressed_ptrs;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    input_ptrs.push_back(&inputs[i]);
+    compressed_ptrs.push_back(&compressed[i]);
+    compressed_cptrs.push_back(&compressed[i]);
+    decompressed_ptrs.push_back(&decompressed[i]);
+  }
+  ASSERT_EQ(compressor->compress_many(input_ptrs.begin(), input_ptrs.end(), compressed_ptrs.begin(), compressed_ptrs.end()), 0);
+  ASSERT_EQ(compressor->decompress_many(compressed_cptrs.begin(), compressed_cptrs.end(), decompressed_ptrs.begin(), decompressed_ptrs.end()), 0);
+
+  auto results = compressor->get_metrics_results();
+  uint64_t evaluations = 0;
+  results.get("external:evaluations", &evaluations);
+  EXPECT_EQ(evaluations, 3);
+  for (int e = 0; e < 3; ++e) {
+    double input_sum = -1;
+    results.get("external:" + std::to_string(e) + ":results:input_sum", &input_sum);
+    EXPECT_EQ(input_sum, 4 * e + 3);
+  }
+  //the first evaluation is also reported as if it were the only one
+  EXPECT_EQ(metric(results, "input_sum"), 3);
+}
@@ -0,0 +1,235 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <nlohmann/json.hpp>
+#include "libpressio_ext/launch/external_launch.h"
+#include "libpressio_ext/cpp/binary.h"
+#include "libpressio_ext/cpp/data.h"
+#include "libpressio_ext/cpp/libpressio.h"
+#include "libpressio_ext/cpp/options.h"
+
+namespace {
+  /**
+   * a minimal HTTP/1.1 server on the loopback interface that keeps connections alive and answers each
+   * request with the number of arguments it was sent, in the same encoding as the request.  An argument
+   * "sleep" delays the response by 200ms.
+   */
+  class loopback_server {
+    public:
+    loopback_server() {
+      listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+      sockaddr_in addr{};
+      addr.sin_family = AF_INET;
+      addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      addr.sin_port = 0;
+      bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+      listen(listen_fd, 16);
+      socklen_t len = sizeof(addr);
+      getsockname(listen_fd, reinterpret_cast<sockaddr*>(&addr), &len);
+      port = ntohs(addr.sin_port);
+      acceptor = std::thread([this]{ accept_connections(); });
+    }
+
+    ~loopback_server() {
+      shutdown(listen_fd, SHUT_RDWR);
+      acceptor.join();
+      close(listen_fd);
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        for (int fd : clients) shutdown(fd, SHUT_RDWR);
+      }
+      for (auto& handler : handlers) handler.join();
+    }
+
+    std::string url() const {
+      return "http://127.0.0.1:" + std::to_string(port) + "/";
+    }
+
+    std::atomic<int> connections{0};
+    std::atomic<int> requests{0};
+
+    private:
+    void accept_connections() {
+      while(true) {
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if(fd == -1) return;
+        ++connections;
+        std::lock_guard<std::mutex> guard(lock);
+        clients.push_back(fd);
+        handlers.emplace_back([this, fd]{ serve(fd); close(fd); });
+      }
+    }
+
+    void serve(int fd) {
+      std::string buffer;
+      while(true) {
+        size_t header_end;
+        while((header_end = buffer.find("\r\n\r\n")) == std::string::npos) {
+          if(!receive(fd, buffer)) return;
+        }
+        std::string headers = buffer.substr(0, header_end);
+        size_t content_length = std::stoull(header_value(headers, "content-length"));
+        while(buffer.size() < header_end + 4 + content_length) {
+          if(!receive(fd, buffer)) return;
+        }
+        std::string body = buffer.substr(header_end + 4, content_length);
+        buffer.erase(0, header_end + 4 + content_length);
+        ++requests;
+
+        const bool binary = header_value(headers, "content-type") == "application/x-pressio-options";
+        std::vector<std::string> args;
+        if(binary) {
+          options_from_binary(body.data(), body.size()).get("args", &args);
+        } else {
+          args = nlohmann::json::parse(body)["args"].get<std::vector<std::string>>();
+        }
+        if(std::find(args.begin(), args.end(), "sleep") != args.end()) {
+          std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        }
+        std::string proc_stdout = "external:api=5\nnargs=" + std::to_string(args.size()) + "\n";
+
+        std::string response, content_type;
+        if(binary) {
+          pressio_options results;
+          results.set("stdout", proc_stdout);
+          results.set("stderr", std::string("binary"));
+          results.set("return_code", int32_t{0});
+          auto encoded = options_to_binary(results);
+          response.assign(static_cast<const char*>(encoded.data()), encoded.size_in_bytes());
+          content_type = "application/x-pressio-options";
+        } else {
+          nlohmann::json results;
+          results["stdout"] = proc_stdout;
+          results["stderr"] = "json";
+          results["return_code"] = 0;
+          response = results.dump();
+          content_type = "application/json";
+        }
+        std::string reply = "HTTP/1.1 200 OK\r\nContent-Type: " + content_type +
+          "\r\nContent-Length: " + std::to_string(response.size()) + "\r\n\r\n" + response;
+        if(send(fd, reply.data(), reply.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(reply.size())) return;
+      }
+    }
+
+    static bool receive(int fd, std::string& buffer) {
+      char chunk[4096];
+      ssize_t nread = recv(fd, chunk, sizeof chunk, 0);
+      if(nread <= 0) return false;
+      buffer.append(chunk, nread);
+      return true;
+    }
+
+    static std::string header_value(std::string const& headers, std::string const& name) {
+      std::string lower = headers;
+      for (auto& c : lower) c = static_cast<char>(tolower(c));
+      auto pos = lower.find("\r\n" + name + ":");
+      if(pos == std::string::npos) return "0";
+      pos = headers.find_first_not_of(' ', pos + name.size() + 3);
+      return headers.substr(pos, headers.find("\r\n", pos) - pos);
+    }
+
+    int listen_fd;
+    uint16_t port;
+    std::thread acceptor;
+    std::mutex lock;
+    std::vector<int> clients;
+    std::vector<std::thread> handlers;
+  };
+
+  pressio_launcher make_launcher(loopback_server const& server, std::string const& format, uint32_t max_connections = 0) {
+    pressio_launcher launcher = launch_plugins().build("remote");
+    launcher->set_options({
+        {"external:connection_string", server.url()},
+        {"external:request_format", format},
+        {"external:max_connections", max_connections},
+    });
+    return launcher;
+  }
+}
+
+TEST(ExternalRemote, ReusesConnectionsBetweenLaunches) {
+  loopback_server server;
+  {
+    auto launcher = make_launcher(server, "binary");
+    for (int i = 0; i < 5; ++i) {
+      auto results = launcher->launch({"--input", "x"});
+      ASSERT_EQ(results.error_code, 0) << results.proc_stderr;
+      EXPECT_EQ(results.proc_stdout, "external:api=5\nnargs=2\n");
+      EXPECT_EQ(results.proc_stderr, "binary");
+    }
+  }
+  EXPECT_EQ(server.requests, 5);
+  EXPECT_EQ(server.connections, 1);
+}
+
+TEST(ExternalRemote, SendsConcurrentRequestsOverThePool) {
+  loopback_server server;
+  {
+    auto launcher = make_launcher(server, "binary", 3);
+    std::vector<std::vector<std::string>> jobs;
+    for (int i = 0; i < 6; ++i) {
+      jobs.emplace_back(i + 1, "sleep");
+    }
+    auto begin = std::chrono::steady_clock::now();
+    auto results = launcher->launch_many(jobs, 6);
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    ASSERT_EQ(results.size(), 6);
+    for (int i = 0; i < 6; ++i) {
+      EXPECT_EQ(results[i].proc_stdout, "external:api=5\nnargs=" + std::to_string(i + 1) + "\n");
+    }
+    //one at a time the requests take at least 1.2 seconds, over three connections 0.4 seconds
+    EXPECT_LT(elapsed, 1.0);
+  }
+  EXPECT_LE(server.connections, 3);
+}
+
+TEST(ExternalRemote, SupportsJsonRequests) {
+  loopback_server server;
+  auto launcher = make_launcher(server, "json");
+  auto results = launcher->launch({"--input", "x", "--dim", "3"});
+  ASSERT_EQ(results.error_code, 0) << results.proc_stderr;
+  EXPECT_EQ(results.proc_stdout, "external:api=5\nnargs=4\n");
+  EXPECT_EQ(results.proc_stderr, "json");
+}
+
+TEST(ExternalRemote, RunsTheExternalMetric) {
+  loopback_server server;
+  pressio library;
+  auto compressor = library.get_compressor("noop");
+  const char* metrics_ids[] = {"external"};
+  auto metrics = pressio_metrics(library.get_metrics(std::begin(metrics_ids), std::end(metrics_ids)));
+  compressor->set_metrics(metrics);
+  ASSERT_EQ(compressor->set_metrics_options({
+      {"external:launch_method", std::string("remote")},
+      {"external:connection_string", server.url()},
+      {"external:request_format", std::string("json")},
+      {"external:args_format", std::string("binary")},
+  }), 0) << compressor->error_msg();
+  //the metric and the launcher each keep their own format, so the options round trip
+  ASSERT_EQ(compressor->set_metrics_options(compressor->get_metrics_options()), 0) << compressor->error_msg();
+
+  auto input = pressio_data{1.0, 2.0, 3.0, 4.0};
+  auto compressed = pressio_data::empty(pressio_byte_dtype, {});
+  auto decompressed = pressio_data::empty(pressio_double_dtype, {4});
+  ASSERT_EQ(compressor->compress(&input, &compressed), 0);
+  ASSERT_EQ(compressor->decompress(&compressed, &decompressed), 0);
+
+  auto results = compressor->get_metrics_results();
+  std::string proc_stderr;
+  double nargs = -1;
+  results.get("external:stderr", &proc_stderr);
+  results.get("external:results:nargs", &nargs);
+  //json requests to the server carrying --api binary:1 --request <path>
+  EXPECT_EQ(proc_stderr, "json");
+  EXPECT_EQ(nargs, 4);
+}
@@ -0,0 +1,131 @@
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "libpressio_ext/cpp/binary.h"
+#include "libpressio_ext/cpp/data.h"
+#include "libpressio_ext/cpp/options.h"
+
+/*
+ * a worker for the "worker" launch method;  it answers each job with the number of jobs it has run,
+ * its pid, the number of arguments, and the sums of double precision input and decompressed data.
+ * The arguments --crash and --hang make it exit or stop responding instead.  Binary requests are answered
+ * in binary, or with a corrupt reply if the config_name is "corrupt".
+ */
+static bool read_job(std::vector<std::string>& args) {
+  size_t nargs;
+  if(!(std::cin >> nargs)) return false;
+  std::cin.get();
+  args.clear();
+  for (size_t i = 0; i < nargs; ++i) {
+    size_t len;
+    if(!(std::cin >> len)) return false;
+    std::cin.get();
+    std::string arg(len, '\0');
+    std::cin.read(&arg[0], len);
+    std::cin.get();
+    args.emplace_back(std::move(arg));
+  }
+  return static_cast<bool>(std::cin);
+}
+
+static std::string arg_value(std::vector<std::string> const& args, std::string const& flag) {
+  for (size_t i = 0; i + 1 < args.size(); ++i) {
+    if(args[i] == flag) return args[i+1];
+  }
+  return "";
+}
+
+static double sum_file(std::string const& path) {
+  std::ifstream file(path, std::ios::binary);
+  double sum = 0, value;
+  while(file.read(reinterpret_cast<char*>(&value), sizeof(value))) sum += value;
+  return sum;
+}
+
+static double sum_shm(std::string const& name) {
+  int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if(fd == -1) return -1;
+  struct stat info;
+  fstat(fd, &info);
+  double sum = 0;
+  if(info.st_size > 0) {
+    void* ptr = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    const double* values = static_cast<const double*>(ptr);
+    for (size_t i = 0; i < info.st_size / sizeof(double); ++i) sum += values[i];
+    munmap(ptr, info.st_size);
+  }
+  close(fd);
+  return sum;
+}
+
+static double sum_data(pressio_options const& request, std::string const& key) {
+  pressio_data data;
+  if(request.get(key, &data) != pressio_options_key_set) return -1;
+  double sum = 0;
+  for (auto value : data.to_vector<double>()) sum += value;
+  return sum;
+}
+
+static void answer_binary(std::string const& request_path, size_t nargs, std::ostringstream& out) {
+  std::ifstream file(request_path, std::ios::binary);
+  std::string encoded((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  pressio_options request = options_from_binary(encoded.data(), encoded.size());
+  out << "external:api=binary:1\n";
+  std::string config_name;
+  request.get("config_name", &config_name);
+  if(config_name == "corrupt") {
+    out << "not binary options";
+    return;
+  }
+  pressio_options reply{
+    {"nargs", static_cast<double>(nargs)},
+    {"input_sum", sum_data(request, "input_data")},
+    {"decompressed_sum", sum_data(request, "decompressed_data")},
+  };
+  auto reply_data = options_to_binary(reply);
+  out.write(static_cast<const char*>(reply_data.data()), reply_data.size_in_bytes());
+}
+
+int main()
+{
+  std::vector<std::string> args;
+  for (size_t jobs = 1; read_job(args); ++jobs) {
+    std::ostringstream out, err;
+    if(arg_value(args, "--api") == "binary:1") {
+      answer_binary(arg_value(args, "--request"), args.size(), out);
+    } else if(args.empty()) {
+      out << "external:api=5\n";
+      out << "defaulted=2.0\n";
+    } else {
+      for (auto const& arg : args) {
+        if(arg == "--crash") return 3;
+        if(arg == "--hang") pause();
+      }
+      out << "external:api=5\n";
+      out << "jobs=" << jobs << '\n';
+      out << "pid=" << getpid() << '\n';
+      out << "nargs=" << args.size() << '\n';
+      if(arg_value(args, "--type") == "double") {
+        out << "input_sum=" << sum_file(arg_value(args, "--input")) << '\n';
+        out << "decompressed_sum=" << sum_file(arg_value(args, "--decompressed")) << '\n';
+        auto input_shm = arg_value(args, "--input_shm");
+        out << "shm=" << !input_shm.empty() << '\n';
+        if(!input_shm.empty()) {
+          out << "input_shm_sum=" << sum_shm(input_shm) << '\n';
+          out << "decompressed_shm_sum=" << sum_shm(arg_value(args, "--decompressed_shm")) << '\n';
+        }
+      }
+      err << "job " << jobs << '\n';
+    }
+    std::string out_s = out.str(), err_s = err.str();
+    std::cout << 0 << ' ' << out_s.size() << ' ' << err_s.size() << '\n' << out_s << err_s << std::flush;
+  }
+  return 0;
+}
@@ -110,3 +110,67 @@ TEST(hdffilter, filter_runs) {
 
     
 }
+
+TEST(hdffilter, chunks_reuse_compressors) {
+    const hsize_t dims[] = {30,30,30};
+    const hsize_t chunks[] = {10,10,10};
+    const auto vector_len = std::accumulate(std::begin(dims), std::end(dims), 1, compat::multiplies<>{});
+    std::vector<float> v(vector_len);
+    std::vector<float> v2(vector_len);
+
+    if(H5Zregister(H5Z_LIBPRESSIO) < 0) {
+        FAIL() << "failed to register plugin";
+    }
+
+    hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
+    cleanup fapl_cleanup ([&fapl]{ H5Pclose(fapl);});
+    if(H5Pset_fapl_core(fapl, /*increment*/1024, /*backingstore*/false)) {
+        FAIL() << "failed to set core driver";
+    }
+    hid_t file = H5Fcreate("hdf5filter_cache", H5F_ACC_TRUNC, H5P_DEFAULT, fapl);
+    if(file < 0) {
+        FAIL() << "failed to create in-memory file";
+    }
+    cleanup file_cleanup([&file]{H5Fclose(file);});
+    hid_t space = H5Screate_simple(3, dims, nullptr);
+    cleanup space_cleanup([&space]{H5Sclose(space);});
+    hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+    cleanup cleanup_dcpl([&dcpl]{H5Pclose(dcpl);});
+    if(H5Pset_chunk(dcpl, 3, chunks) < 0 ) {
+        FAIL() << "failure to configure chunk size";
+    }
+    pressio_options options;
+    if(H5Pset_libpressio(dcpl, "noop", &options) < 0) {
+      FAIL() << "failed to configure libpressio settings";
+    }
+
+    {
+      hid_t dataset = H5Dcreate(file, "testing", H5T_NATIVE_FLOAT, space, H5P_DEFAULT, dcpl, H5P_DEFAULT);
+      if(dataset < 0) {
+          FAIL() << "failed to create dataset";
+      }
+      cleanup dataset_cleanup([&dataset]{ H5Dclose(dataset);});
+      std::iota(v.begin(), v.end(), 1.0f);
+      H5Dwrite(dataset, H5T_NATIVE_FLOAT, H5S_ALL, H5S_ALL, H5P_DEFAULT, v.data());
+    }
+    {
+      hid_t dataset = H5Dopen(file, "testing", H5P_DEFAULT);
+      if(dataset < 0) {
+          FAIL() << "failed to open dataset";
+      }
+      cleanup dataset_cleanup([&dataset]{ H5Dclose(dataset);});
+      H5Dread(dataset, H5T_NATIVE_FLOAT, H5S_ALL, H5S_ALL, H5P_DEFAULT, v2.data());
+    }
+    EXPECT_EQ(v, v2);
+
+    H5Z_libpressio_cache_stats stats;
+    H5Z_libpressio_get_cache_stats(&stats);
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_GE(stats.hits, 26);
+    EXPECT_EQ(stats.entries, 1);
+
+    H5Z_libpressio_set_cache_size(0);
+    H5Z_libpressio_get_cache_stats(&stats);
+    EXPECT_EQ(stats.entries, 0);
+    EXPECT_EQ(stats.evictions, 1);
+}
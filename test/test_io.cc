@@ -1,4 +1,6 @@
 #include <vector>
+#include <memory>
+#include <sys/stat.h>
 #include <numeric>
 #include <cstddef>
 #include "libpressio_ext/io/pressio_io.h"
@@ -324,3 +326,404 @@ TEST_F(PressioDataIOTests, TestReadCSV) {
   close(tmpwrite_fd);
   unlink(tmpwrite_name.data());
 }
+
+TEST_F(PressioDataIOTests, TestReadRegionGeneric) {
+  size_t sizes[] = {2,3};
+  size_t start[] = {1,0};
+  size_t stride[] = {1,2};
+  size_t count[] = {1,2};
+  auto io = pressio_get_io(&library, "posix");
+  (*io)->set_options({
+      {"io:path", tmp_name}
+  });
+  auto size_info = pressio_data_new_empty(pressio_int32_dtype, 2, sizes);
+  auto data = pressio_io_read_region(io, size_info, 2, start, stride, count, nullptr);
+  ASSERT_NE(data, nullptr);
+  EXPECT_EQ(pressio_data_dtype(data), pressio_int32_dtype);
+  EXPECT_EQ(pressio_data_get_dimension(data, 0), 1);
+  EXPECT_EQ(pressio_data_get_dimension(data, 1), 2);
+  int* ptr = static_cast<int*>(pressio_data_ptr(data, nullptr));
+  EXPECT_EQ(ptr[0], 1);
+  EXPECT_EQ(ptr[1], 5);
+  pressio_data_free(data);
+  pressio_data_free(size_info);
+  pressio_io_free(io);
+}
+
+TEST_F(PressioDataIOTests, TestReadRegionMmap) {
+  auto io = library.get_io("mmap");
+  if(!io) GTEST_SKIP() << "mmap io plugin not built";
+  std::vector<size_t> start{1,0}, stride{1,2}, count{1,2}, block{1,1};
+  ASSERT_EQ(io->set_options({{"io:path", tmp_name}}), 0);
+  auto full = pressio_data::empty(pressio_int32_dtype, {2,3});
+  std::unique_ptr<pressio_data> region(io->read_region(&full, start, stride, count, block));
+  ASSERT_NE(region, nullptr) << io->error_msg();
+
+  auto all = pressio_data::copy(pressio_int32_dtype, data.data(), {2,3});
+  EXPECT_EQ(*region, all.select(start, stride, count, block));
+  auto invalid = pressio_data::empty(pressio_int32_dtype, {2,3});
+  EXPECT_EQ(io->read_region(&invalid, {2,0}, stride, count, block), nullptr);
+}
+
+TEST_F(PressioDataIOTests, TestReadRegionNumpy) {
+  auto io = library.get_io("numpy");
+  if(!io) GTEST_SKIP() << "numpy io plugin not built";
+  std::string path("test_io_numpyXXXXXX");
+  close(mkstemp(&path[0]));
+  std::vector<size_t> start{0,1}, stride{1,1}, count{2,2}, block{1,1};
+  auto all = pressio_data::copy(pressio_int32_dtype, data.data(), {2,3});
+  ASSERT_EQ(io->set_options({{"io:path", path}}), 0);
+  ASSERT_EQ(io->write(&all), 0) << io->error_msg();
+
+  //the dtype and dimensions come from the header of the file
+  std::unique_ptr<pressio_data> region(io->read_region(nullptr, start, stride, count, block));
+  ASSERT_NE(region, nullptr) << io->error_msg();
+  EXPECT_EQ(*region, all.select(start, stride, count, block));
+  unlink(path.c_str());
+}
+
+TEST_F(PressioDataIOTests, TestReadRegionHDF5) {
+  auto io = library.get_io("hdf5");
+  if(!io) GTEST_SKIP() << "hdf5 io plugin not built";
+  std::string path("test_io_hdf5XXXXXX");
+  close(mkstemp(&path[0]));
+  unlink(path.c_str());
+  auto all = pressio_data::copy(pressio_int32_dtype, data.data(), {2,3});
+  ASSERT_EQ(io->set_options({{"io:path", path}, {"hdf5:dataset", std::string("data")}}), 0);
+  ASSERT_EQ(io->write(&all), 0) << io->error_msg();
+
+  std::vector<size_t> start{1,0}, stride{1,2}, count{1,2}, block{1,1};
+  std::unique_ptr<pressio_data> region(io->read_region(nullptr, start, stride, count, block));
+  ASSERT_NE(region, nullptr) << io->error_msg();
+  EXPECT_EQ(*region, all.select(start, stride, count, block));
+
+  //a region is relative to what read returns, both for a box and for other configured hyperslabs
+  std::vector<size_t> region_start{1,0}, region_stride{1,1}, region_count{1,2};
+  for (uint64_t file_stride : {1, 2}) {
+    auto reader = library.get_io("hdf5");
+    ASSERT_EQ(reader->set_options({
+        {"io:path", path},
+        {"hdf5:dataset", std::string("data")},
+        {"hdf5:file_start", pressio_data{uint64_t{0}, uint64_t{2} - file_stride}},
+        {"hdf5:file_count", pressio_data{uint64_t{2}, uint64_t{2}}},
+        {"hdf5:file_stride", pressio_data{uint64_t{1}, file_stride}},
+    }), 0);
+    std::unique_ptr<pressio_data> configured(reader->read(nullptr));
+    ASSERT_NE(configured, nullptr) << reader->error_msg();
+    region.reset(reader->read_region(nullptr, region_start, region_stride, region_count, block));
+    ASSERT_NE(region, nullptr) << reader->error_msg();
+    EXPECT_EQ(*region, configured->select(region_start, region_stride, region_count, block));
+    EXPECT_EQ(reader->read_region(nullptr, {2,0}, region_stride, region_count, block), nullptr);
+  }
+  unlink(path.c_str());
+}
+
+TEST_F(PressioDataIOTests, TestReadSelect) {
+  std::vector<size_t> start{0,1}, stride{1,1}, count{2,2}, block{1,1};
+  auto io = library.get_io("select");
+  io->set_options({
+      {"io:path", tmp_name},
+      {"select:start", pressio_data(std::begin(start), std::end(start))},
+      {"select:stride", pressio_data(std::begin(stride), std::end(stride))},
+      {"select:size", pressio_data(std::begin(count), std::end(count))},
+      {"select:block", pressio_data(std::begin(block), std::end(block))},
+  });
+  pressio_data full = pressio_data::empty(pressio_int32_dtype, {2,3});
+  pressio_data* selected = io->read(&full);
+  ASSERT_NE(selected, nullptr);
+
+  auto all = pressio_data::copy(pressio_int32_dtype, data.data(), {2,3});
+  EXPECT_EQ(*selected, all.select(start, stride, count, block));
+  pressio_data_free(selected);
+}
+
+TEST_F(PressioDataIOTests, TestManyFiles) {
+  std::vector<std::string> paths;
+  std::vector<pressio_data> buffers;
+  for (int i = 0; i < 4; ++i) {
+    paths.emplace_back("test_io_manyXXXXXX");
+    close(mkstemp(&paths.back()[0]));
+    buffers.emplace_back(pressio_data::owning(pressio_int32_dtype, {2,3}));
+    std::iota(static_cast<int*>(buffers.back().data()), static_cast<int*>(buffers.back().data()) + 6, i);
+  }
+  auto io = library.get_io("many_files");
+  ASSERT_EQ(io->set_options({
+      {"many_files:paths", paths},
+      {"many_files:nthreads", 3u},
+  }), 0);
+
+  std::vector<const pressio_data*> to_write;
+  for (auto const& buffer : buffers) to_write.push_back(&buffer);
+  EXPECT_EQ(io->write_many(to_write.begin(), to_write.end()), 0) << io->error_msg();
+
+  std::vector<pressio_data*> to_read;
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    to_read.push_back(pressio_data_new_empty(pressio_int32_dtype, 2, dims));
+  }
+  EXPECT_EQ(io->read_many(to_read.begin(), to_read.end()), 0) << io->error_msg();
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    EXPECT_EQ(*to_read[i], buffers[i]);
+    pressio_data_free(to_read[i]);
+  }
+
+  //read returns each file in order while reading ahead
+  pressio_data dims_template = pressio_data::empty(pressio_int32_dtype, {2,3});
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    pressio_data* read = io->read(&dims_template);
+    ASSERT_NE(read, nullptr) << io->error_msg();
+    EXPECT_EQ(*read, buffers[i]);
+    pressio_data_free(read);
+  }
+  EXPECT_EQ(io->read(nullptr), nullptr);
+
+  //write writes each buffer to the next file in order
+  auto writer = library.get_io("many_files");
+  ASSERT_EQ(writer->set_options({{"many_files:paths", paths}}), 0);
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    ASSERT_EQ(writer->write(&buffers[buffers.size() - 1 - i]), 0) << writer->error_msg();
+  }
+  EXPECT_NE(writer->write(&buffers.front()), 0);
+  ASSERT_EQ(io->set_options({{"many_files:paths", paths}}), 0);
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    pressio_data* read = io->read(&dims_template);
+    ASSERT_NE(read, nullptr) << io->error_msg();
+    EXPECT_EQ(*read, buffers[buffers.size() - 1 - i]);
+    pressio_data_free(read);
+  }
+
+  for (auto const& path : paths) unlink(path.c_str());
+}
+
+TEST_F(PressioDataIOTests, TestContainer) {
+  auto io = library.get_io("container");
+  if(!io) GTEST_SKIP() << "container io plugin not built";
+  std::string path("test_io_containerXXXXXX");
+  close(mkstemp(&path[0]));
+
+  auto field = pressio_data::copy(pressio_int32_dtype, data.data(), {2,3});
+  auto compressed = pressio_data::owning(pressio_byte_dtype, {5});
+  memset(compressed.data(), 7, 5);
+
+  ASSERT_EQ(io->set_options({{"io:path", path}, {"container:field", "raw"}}), 0);
+  ASSERT_EQ(io->write(&field), 0) << io->error_msg();
+  ASSERT_EQ(io->set_options({
+      {"container:field", "compressed"},
+      {"container:compressor_id", "noop"},
+      {"container:dtype", static_cast<int32_t>(pressio_int32_dtype)},
+      {"container:dims", pressio_data({2ul, 3ul})},
+  }), 0);
+  ASSERT_EQ(io->write(&compressed), 0) << io->error_msg();
+
+  //a fresh instance rebuilds the index from the file
+  auto reader = library.get_io("container");
+  reader->set_options({{"io:path", path}, {"container:field", "raw"}});
+  pressio_data* read = reader->read(nullptr);
+  ASSERT_NE(read, nullptr) << reader->error_msg();
+  EXPECT_EQ(*read, field);
+  //the field may be modified in place without changing the file
+  static_cast<int32_t*>(read->data())[0] = -1;
+  pressio_data_free(read);
+  read = reader->read(nullptr);
+  ASSERT_NE(read, nullptr) << reader->error_msg();
+  EXPECT_EQ(*read, field);
+  pressio_data_free(read);
+
+  reader->set_options({{"container:field", "compressed"}});
+  read = reader->read(nullptr);
+  ASSERT_NE(read, nullptr) << reader->error_msg();
+  EXPECT_EQ(*read, compressed);
+  pressio_data_free(read);
+  std::string compressor_id;
+  pressio_data dims;
+  auto options = reader->get_options();
+  options.get("container:read_compressor_id", &compressor_id);
+  options.get("container:read_dims", &dims);
+  EXPECT_EQ(compressor_id, "noop");
+  EXPECT_EQ(dims.to_vector<size_t>(), std::vector<size_t>({2, 3}));
+
+  //a read does not leak metadata into the next write, and written options are kept until set again
+  ASSERT_EQ(reader->set_options({{"container:field", "raw2"}}), 0);
+  ASSERT_EQ(reader->write(&field), 0) << reader->error_msg();
+  io->get_options().get("container:compressor_id", &compressor_id);
+  EXPECT_EQ(compressor_id, "noop");
+  ASSERT_EQ(io->set_options({{"container:field", "raw3"}, {"container:compressor_id", ""}}), 0);
+  ASSERT_EQ(io->write(&field), 0) << io->error_msg();
+  for (auto name : {"raw2", "raw3"}) {
+    auto checker = library.get_io("container");
+    checker->set_options({{"io:path", path}, {"container:field", name}});
+    read = checker->read(nullptr);
+    ASSERT_NE(read, nullptr) << checker->error_msg();
+    EXPECT_EQ(*read, field) << name;
+    pressio_data_free(read);
+    options = checker->get_options();
+    options.get("container:read_compressor_id", &compressor_id);
+    options.get("container:read_dims", &dims);
+    EXPECT_EQ(compressor_id, "") << name;
+    EXPECT_EQ(dims.to_vector<size_t>(), std::vector<size_t>({2, 3})) << name;
+  }
+
+  reader->set_options({{"container:field", "missing"}});
+  EXPECT_EQ(reader->read(nullptr), nullptr);
+  EXPECT_NE(reader->error_code(), 0);
+
+  unlink(path.c_str());
+}
+
+TEST_F(PressioDataIOTests, TestCompressStream) {
+  std::string out_name("test_io_streamXXXXXX");
+  int out_fd = mkstemp(&out_name[0]);
+
+  auto input = library.get_io("posix");
+  input->set_options({{"io:path", tmp_name}});
+  auto output = library.get_io("posix");
+  output->set_options({{"io:file_descriptor", out_fd}});
+  auto compressor = library.get_compressor("noop");
+
+  auto input_template = pressio_data::empty(pressio_int32_dtype, {2,3});
+  ASSERT_EQ(compressor->compress_stream(*input, input_template, *output, 2, 1), 0) << compressor->error_msg();
+
+  //a header, then slabs of two rows, then one row, each preceded by its size
+  auto written = pressio_io_data_path_read(nullptr, out_name.c_str());
+  ASSERT_NE(written, nullptr);
+  auto bytes = static_cast<unsigned char*>(written->data());
+  ASSERT_GT(written->size_in_bytes(), 16u);
+  EXPECT_EQ(memcmp(bytes, "PRESSIOS", 8), 0);
+  uint32_t header_size;
+  memcpy(&header_size, bytes + 12, sizeof(uint32_t));
+  ASSERT_EQ(written->size_in_bytes(), 16 + header_size + 2*sizeof(uint64_t) + data.size()*sizeof(int));
+  bytes += 16 + header_size;
+  uint64_t frame_size;
+  memcpy(&frame_size, bytes, sizeof(uint64_t));
+  EXPECT_EQ(frame_size, 4*sizeof(int));
+  EXPECT_EQ(memcmp(bytes + sizeof(uint64_t), data.data(), 4*sizeof(int)), 0);
+  memcpy(&frame_size, bytes + sizeof(uint64_t) + 4*sizeof(int), sizeof(uint64_t));
+  EXPECT_EQ(frame_size, 2*sizeof(int));
+  EXPECT_EQ(memcmp(bytes + 2*sizeof(uint64_t) + 4*sizeof(int), data.data() + 4, 2*sizeof(int)), 0);
+  pressio_data_free(written);
+
+  //errors reading a slab are reported by the compressor
+  input->set_options({{"io:path", std::string("/nonexistent/path")}});
+  EXPECT_NE(compressor->compress_stream(*input, input_template, *output, 1, 2), 0);
+
+  close(out_fd);
+  unlink(out_name.c_str());
+}
+
+TEST_F(PressioDataIOTests, TestDecompressStream) {
+  std::string stream_name("test_io_streamXXXXXX");
+  int stream_fd = mkstemp(&stream_name[0]);
+  std::string out_name("test_io_decompressedXXXXXX");
+  int out_fd = mkstemp(&out_name[0]);
+
+  auto input = library.get_io("posix");
+  input->set_options({{"io:path", tmp_name}});
+  auto stream = library.get_io("posix");
+  stream->set_options({{"io:file_descriptor", stream_fd}});
+  auto output = library.get_io("posix");
+  output->set_options({{"io:file_descriptor", out_fd}});
+  auto compressor = library.get_compressor("noop");
+
+  auto input_template = pressio_data::empty(pressio_int32_dtype, {2,3});
+  ASSERT_EQ(compressor->compress_stream(*input, input_template, *stream, 2, 2), 0) << compressor->error_msg();
+
+  //the header describes the input, and the slabs concatenate to the original data
+  lseek(stream_fd, 0, SEEK_SET);
+  pressio_data decoded_template;
+  ASSERT_EQ(compressor->decompress_stream(*stream, *output, 2, &decoded_template), 0) << compressor->error_msg();
+  EXPECT_EQ(decoded_template.dtype(), pressio_int32_dtype);
+  EXPECT_EQ(decoded_template.dimensions(), std::vector<size_t>({2,3}));
+  auto decompressed = pressio_io_data_path_read(nullptr, out_name.c_str());
+  ASSERT_NE(decompressed, nullptr);
+  ASSERT_EQ(decompressed->size_in_bytes(), data.size()*sizeof(int));
+  EXPECT_EQ(memcmp(decompressed->data(), data.data(), data.size()*sizeof(int)), 0);
+  pressio_data_free(decompressed);
+
+  //streams from a different compressor are rejected
+  lseek(stream_fd, 0, SEEK_SET);
+  auto other = library.get_compressor("sample");
+  ASSERT_TRUE(other);
+  EXPECT_NE(other->decompress_stream(*stream, *output, 2), 0);
+
+  //data that is not a stream is rejected
+  auto raw = library.get_io("posix");
+  raw->set_options({{"io:file_descriptor", tmp_fd}});
+  EXPECT_NE(compressor->decompress_stream(*raw, *output, 2), 0);
+
+  //a path is reopened on each read, so it cannot be read as a stream
+  auto by_path = library.get_io("posix");
+  by_path->set_options({{"io:path", stream_name}});
+  EXPECT_NE(compressor->decompress_stream(*by_path, *output, 2), 0);
+  EXPECT_NE(compressor->compress_stream(*input, input_template, *by_path, 2, 2), 0);
+
+  //a frame larger than the header allows is rejected before it is read
+  const uint64_t huge = uint64_t{1} << 60;
+  struct stat statbuf;
+  ASSERT_EQ(fstat(stream_fd, &statbuf), 0);
+  //the frames hold slabs of 2x2 and 2x1 ints
+  const off_t first_frame = statbuf.st_size - (sizeof(uint64_t) + 4 * sizeof(int)) - (sizeof(uint64_t) + 2 * sizeof(int));
+  ASSERT_EQ(pwrite(stream_fd, &huge, sizeof(huge), first_frame), static_cast<ssize_t>(sizeof(huge)));
+  lseek(stream_fd, 0, SEEK_SET);
+  EXPECT_NE(compressor->decompress_stream(*stream, *output, 2), 0);
+  EXPECT_NE(std::string(compressor->error_msg()).find("larger than the stream header allows"), std::string::npos) << compressor->error_msg();
+
+  close(stream_fd);
+  close(out_fd);
+  unlink(stream_name.c_str());
+  unlink(out_name.c_str());
+}
+
+TEST_F(PressioDataIOTests, TestPrefetch) {
+  auto io = library.get_io("prefetch");
+  ASSERT_EQ(io->set_options({{"io:path", tmp_name}, {"prefetch:depth", 2u}}), 0);
+  auto expected = pressio_data::copy(pressio_int32_dtype, data.data(), {2,3});
+
+  //each read is served from the ring, and the buffer passed in is reused for later reads
+  pressio_data* buffer = pressio_data_new_empty(pressio_int32_dtype, 2, dims);
+  for (int i = 0; i < 4; ++i) {
+    pressio_data* read = io->read(buffer);
+    ASSERT_NE(read, nullptr) << io->error_msg();
+    EXPECT_EQ(*read, expected);
+    pressio_data_free(buffer);
+    buffer = read;
+  }
+  pressio_data_free(buffer);
+
+  //setting options that change nothing keeps the reads ahead, while a real change starts over
+  std::vector<std::string> paths;
+  std::vector<pressio_data> buffers;
+  for (int i = 0; i < 4; ++i) {
+    paths.emplace_back("test_io_prefetchXXXXXX");
+    close(mkstemp(&paths.back()[0]));
+    buffers.emplace_back(pressio_data::owning(pressio_int32_dtype, {2,3}));
+    std::iota(static_cast<int*>(buffers.back().data()), static_cast<int*>(buffers.back().data()) + 6, i);
+  }
+  auto files = library.get_io("prefetch");
+  ASSERT_EQ(files->set_options({{"prefetch:io", "many_files"}, {"many_files:paths", paths}}), 0);
+  for (auto const& buffer : buffers) {
+    ASSERT_EQ(files->write(&buffer), 0) << files->error_msg();
+  }
+  ASSERT_EQ(files->set_options({{"many_files:paths", paths}}), 0);
+  pressio_data dims_template = pressio_data::empty(pressio_int32_dtype, {2,3});
+  pressio_data* read = files->read(&dims_template);
+  ASSERT_NE(read, nullptr) << files->error_msg();
+  EXPECT_EQ(*read, buffers[0]);
+  pressio_data_free(read);
+  ASSERT_EQ(files->set_options({{"many_files:paths", paths}, {"prefetch:depth", 2u}}), 0);
+  read = files->read(&dims_template);
+  ASSERT_NE(read, nullptr) << files->error_msg();
+  EXPECT_EQ(*read, buffers[1]);
+  pressio_data_free(read);
+  std::vector<std::string> reversed(paths.rbegin(), paths.rend());
+  ASSERT_EQ(files->set_options({{"many_files:paths", reversed}}), 0);
+  read = files->read(&dims_template);
+  ASSERT_NE(read, nullptr) << files->error_msg();
+  EXPECT_EQ(*read, buffers[3]);
+  pressio_data_free(read);
+  for (auto const& path : paths) unlink(path.c_str());
+
+  //failures of the child are reported to the caller
+  io->set_options({{"io:path", std::string("/nonexistent/path")}});
+  EXPECT_EQ(io->read(nullptr), nullptr);
+  EXPECT_NE(io->error_code(), 0);
+  EXPECT_EQ(io->read(nullptr), nullptr);
+}
@@ -15,7 +15,7 @@ class hasoptoins_metric : public libpressio_metrics_plugin
 {
 public:
   
-  int set_options(pressio_options const& options) override {
+  int set_options_impl(pressio_options const& options) override {
     options.get("hasoptions:value", &value);
     return 0;
   }
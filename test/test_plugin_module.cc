@@ -0,0 +1,3 @@
+#include "libpressio_ext/cpp/pressio.h"
+
+static pressio_register compressor_loaded_noop_plugin(compressor_plugins(), "loaded_noop", [](){ return compressor_plugins().build("noop"); });
@@ -293,3 +293,18 @@ TEST(test_mulit_dimensional_array, test_mulit_dimensional_array_operator) {
   pressio_data_free(data);
 }
 
+
+TEST_F(PressioDataTests, ReleaseMalloc) {
+  auto owned = pressio_data::owning(pressio_float_dtype, {4});
+  void* ptr = owned.data();
+  void* released = owned.release_malloc();
+  EXPECT_EQ(released, ptr);
+  EXPECT_FALSE(owned.has_data());
+  EXPECT_EQ(owned.dimensions(), std::vector<size_t>{4});
+  free(released);
+
+  std::vector<float> v(4);
+  auto view = pressio_data::nonowning(pressio_float_dtype, v.data(), {4});
+  EXPECT_EQ(view.release_malloc(), nullptr);
+  EXPECT_EQ(view.data(), v.data());
+}
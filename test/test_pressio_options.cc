@@ -1,7 +1,11 @@
+#include <algorithm>
 #include <cstdlib>
 #include <sstream>
 #include "libpressio_ext/cpp/options.h"
 #include "libpressio_ext/cpp/printers.h"
+#include "libpressio_ext/cpp/libpressio.h"
+#include "libpressio_ext/cpp/binary.h"
+#include "libpressio_ext/binary/pressio_options_binary.h"
 #include "std_compat/string_view.h"
 #include "pressio_option.h"
 #include "pressio_data.h"
@@ -465,3 +469,250 @@ TEST(SubTreeParsing, EmptySearchPath) {
   std::vector<compat::string_view> search_order{""};
   EXPECT_EQ(search_order, pressio_options::search(examplar));
 }
+
+TEST(SubTreeParsing, NamedLookupUsesMostSpecificName) {
+  pressio_options options{
+    {"sz:abs_err_bound", 1.0},
+    {"/pressio:sz:abs_err_bound", 2.0},
+    {"/pressio/sz:sz:abs_err_bound", 3.0},
+  };
+  double value = 0;
+  EXPECT_EQ(options.get("pressio/sz", "sz:abs_err_bound", &value), pressio_options_key_set);
+  EXPECT_EQ(value, 3.0);
+  EXPECT_EQ(options.get("pressio/other", "sz:abs_err_bound", &value), pressio_options_key_set);
+  EXPECT_EQ(value, 2.0);
+  EXPECT_EQ(options.get("other", "sz:abs_err_bound", &value), pressio_options_key_set);
+  EXPECT_EQ(value, 1.0);
+  EXPECT_EQ(options.get("pressio", "sz:missing", &value), pressio_options_key_does_not_exist);
+
+  options.set("pressio", "sz:rel_err_bound", 4.0);
+  EXPECT_EQ(options.key_status("/pressio:sz:rel_err_bound"), pressio_options_key_set);
+  EXPECT_EQ(options.key_status("pressio", "sz:rel_err_bound"), pressio_options_key_set);
+}
+
+TEST(SubTreeParsing, IterationIsSortedAndCopyFromKeepsExisting) {
+  pressio_options options;
+  options.set("c", 1);
+  options.set("a", 2);
+  options.set("b", 3);
+  pressio_options other{{"a", 4}, {"d", 5}};
+  options.copy_from(other);
+
+  std::vector<std::string> keys;
+  for (auto const& option : options) keys.push_back(option.first);
+  EXPECT_EQ(keys, std::vector<std::string>({"a", "b", "c", "d"}));
+  int value = 0;
+  options.get("a", &value);
+  EXPECT_EQ(value, 2);
+  options.get("d", &value);
+  EXPECT_EQ(value, 5);
+}
+
+TEST_F(PressioOptionsTests, DataIsSharedBetweenCopies) {
+  std::vector<double> values(1000, 1.0);
+  pressio_options options;
+  options.set("mask", pressio_data(values.begin(), values.end()));
+  pressio_options copy = options;
+  copy.copy_from(options);
+  pressio_options merged;
+  merged.copy_from(copy);
+
+  auto const& original = options.get("mask").get_value<pressio_data>();
+  EXPECT_EQ(original.data(), copy.get("mask").get_value<pressio_data>().data());
+  EXPECT_EQ(original.data(), merged.get("mask").get_value<pressio_data>().data());
+
+  //assigning a new value to one copy leaves the others alone
+  copy.set("mask", pressio_data(values.begin(), values.begin() + 10));
+  EXPECT_EQ(options.get("mask").get_value<pressio_data>().num_elements(), 1000);
+  EXPECT_EQ(copy.get("mask").get_value<pressio_data>().num_elements(), 10);
+
+  pressio_data out;
+  EXPECT_EQ(options.get("mask", &out), pressio_options_key_set);
+  EXPECT_EQ(out, original);
+  EXPECT_NE(out.data(), original.data());
+}
+
+TEST(OptionsSharedData, PluginsCanHoldTheSharedBuffer) {
+  std::vector<uint8_t> values(1000, 1);
+  pressio_options options;
+  options.set("mask", pressio_data(values.begin(), values.end()));
+  auto const& original = options.get("mask").get_value<pressio_data>();
+
+  pressio_option_shared_data shared;
+  EXPECT_EQ(options.get("mask", &shared), pressio_options_key_set);
+  EXPECT_EQ(shared->data(), original.data());
+
+  pressio_options out;
+  out.set("mask", shared);
+  EXPECT_EQ(out.get("mask").get_value<pressio_data>().data(), original.data());
+
+  pressio_metrics mask = metrics_plugins().build("mask");
+  ASSERT_TRUE(mask);
+  ASSERT_EQ(mask->set_options({{"mask:mask", options.get("mask")}}), 0);
+  auto stored = mask->get_options();
+  EXPECT_EQ(stored.get("mask:mask").get_value<pressio_data>().data(), original.data());
+}
+
+TEST(OptionsBinary, RoundTripsEveryType) {
+  std::vector<float> values{1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  pressio_options options{
+    {"i8", int8_t{-3}}, {"u8", uint8_t{250}}, {"i16", int16_t{-300}}, {"u16", uint16_t{60000}},
+    {"i32", int32_t{-70000}}, {"u32", uint32_t{4000000000u}}, {"i64", int64_t{-(int64_t{1} << 40)}},
+    {"u64", uint64_t{1} << 63}, {"f", 1.5f}, {"d", 0.1}, {"s", std::string("hello")},
+    {"strs", std::vector<std::string>{"a", "", "ccc"}},
+    {"data", pressio_data::copy(pressio_float_dtype, values.data(), {2, 3})},
+    {"empty", pressio_data::empty(pressio_int32_dtype, {7})},
+  };
+  options.set_type("unset_double", pressio_option_double_type);
+  int user = 0;
+  options.set("user", static_cast<void*>(&user));
+
+  pressio_data encoded = options_to_binary(options);
+  EXPECT_EQ(encoded.size_in_bytes(), options_binary_size(options));
+
+  pressio_options decoded = options_from_binary(encoded.data(), encoded.size_in_bytes());
+  options.erase("user");
+  EXPECT_EQ(decoded, options);
+  EXPECT_EQ(decoded.get("unset_double").type(), pressio_option_double_type);
+  EXPECT_FALSE(decoded.get("unset_double").has_value());
+  EXPECT_FALSE(decoded.get("empty").get_value<pressio_data>().has_data());
+
+  //views point into the encoded buffer
+  pressio_options view = options_from_binary_nocopy(encoded.data(), encoded.size_in_bytes());
+  auto const& view_data = view.get("data").get_value<pressio_data>();
+  auto begin = static_cast<const unsigned char*>(encoded.data());
+  auto payload = static_cast<const unsigned char*>(view_data.data());
+  EXPECT_TRUE(payload >= begin && payload < begin + encoded.size_in_bytes());
+  EXPECT_EQ(view_data.to_vector<float>(), values);
+
+  //shared decoding keeps the buffer alive after it is released by the caller
+  pressio_options shared = options_from_binary(std::move(encoded));
+  EXPECT_EQ(shared, options);
+}
+
+TEST(OptionsBinary, RejectsInvalidInput) {
+  pressio library;
+  pressio_options options{{"a", 1}, {"b", std::string("bee")}};
+  pressio_data* encoded = pressio_options_to_binary(&library, &options);
+  ASSERT_NE(encoded, nullptr);
+
+  for (size_t size = 0; size < encoded->size_in_bytes(); ++size) {
+    EXPECT_EQ(pressio_options_new_binary(&library, encoded->data(), size), nullptr) << size;
+  }
+  EXPECT_NE(library.err_code(), 0);
+
+  pressio_options* decoded = pressio_options_new_binary(&library, encoded->data(), encoded->size_in_bytes());
+  ASSERT_NE(decoded, nullptr);
+  EXPECT_EQ(*decoded, options);
+  pressio_options_free(decoded);
+  pressio_data_free(encoded);
+}
+
+TEST(OptionsCache, RecomputedAfterChanges) {
+  pressio library;
+  auto compressor = library.get_compressor("chunking");
+  const auto generation = compressor->get_generation();
+  const pressio_options first = compressor->get_options();
+  EXPECT_EQ(compressor->get_options(), first);
+  EXPECT_EQ(compressor->get_configuration(), compressor->get_configuration());
+  EXPECT_EQ(compressor->get_generation(), generation);
+
+  std::vector<size_t> size{8, 8};
+  ASSERT_EQ(compressor->set_options({{"chunking:size", pressio_data(size.begin(), size.end())}}), 0);
+  EXPECT_GT(compressor->get_generation(), generation);
+  pressio_data stored;
+  compressor->get_options().get("chunking:size", &stored);
+  EXPECT_EQ(stored.to_vector<size_t>(), size);
+
+  //changing a child through the parent is visible in the parent
+  ASSERT_EQ(compressor->set_options({{"chunking:compressor", "sample"}}), 0);
+  EXPECT_EQ(compressor->get_options().key_status("sample:mode"), pressio_options_key_set);
+
+  compressor->set_name("renamed");
+  EXPECT_EQ(compressor->get_options().key_status("renamed", "chunking:size"), pressio_options_key_set);
+  EXPECT_EQ(compressor->get_documentation().key_status("renamed", "chunking:size"), pressio_options_key_set);
+
+  pressio_metrics metrics = library.get_metric("size");
+  compressor->set_metrics(metrics);
+  std::string metric_id;
+  compressor->get_options().get("renamed", "chunking:metric", &metric_id);
+  EXPECT_EQ(metric_id, "size");
+}
+
+TEST(OptionsCache, MetricsBumpTheirGeneration) {
+  pressio library;
+  auto metric = library.get_metric("external");
+  auto generation = metric->get_generation();
+  ASSERT_EQ(metric->set_options({{"external:config_name", std::string("renamed")}}), 0);
+  EXPECT_GT(metric->get_generation(), generation);
+
+  generation = metric->get_generation();
+  metric->set_name("named");
+  EXPECT_GT(metric->get_generation(), generation);
+}
+
+TEST(OptionsDiff, PatchTurnsOneIntoTheOther) {
+  const pressio_options before{{"a", 1}, {"b", std::string("bee")}, {"c", 3.0}, {"/n:d", 4u}};
+  pressio_options after{{"a", 1}, {"b", std::string("buzz")}, {"/n:d", 4u}, {"e", 5}};
+  after.set_type("f", pressio_option_int32_type);
+
+  auto changes = before.diff(after);
+  EXPECT_FALSE(changes.empty());
+  EXPECT_EQ(changes.removed, std::vector<std::string>{"c"});
+  EXPECT_EQ(changes.changed.size(), 3);
+  EXPECT_EQ(changes.changed.key_status("b"), pressio_options_key_set);
+  EXPECT_EQ(changes.changed.key_status("e"), pressio_options_key_set);
+  EXPECT_EQ(changes.changed.key_status("f"), pressio_options_key_exists);
+
+  pressio_options patched = before;
+  patched.patch(changes);
+  EXPECT_EQ(patched, after);
+  EXPECT_TRUE(after.diff(after).empty());
+}
+
+TEST(OptionsDiff, ListenersSeeOnlyChanges) {
+  pressio library;
+  auto compressor = library.get_compressor("chunking");
+  std::vector<pressio_options> notified;
+  const auto id = compressor->add_options_listener([&](pressio_configurable const&, pressio_options const& changed) {
+      notified.push_back(changed);
+  });
+
+  std::vector<size_t> size{8, 8};
+  const pressio_options new_size{{"chunking:size", pressio_data(size.begin(), size.end())}};
+  EXPECT_EQ(compressor->changed_options(new_size).key_status("chunking:size"), pressio_options_key_set);
+  ASSERT_EQ(compressor->set_options(new_size), 0);
+  ASSERT_EQ(notified.size(), 1);
+  EXPECT_EQ(notified.front().size(), 1);
+  EXPECT_EQ(notified.front().key_status("chunking:size"), pressio_options_key_set);
+
+  //setting the same value again is not a change
+  EXPECT_EQ(compressor->changed_options(new_size).size(), 0);
+  ASSERT_EQ(compressor->set_options(new_size), 0);
+  EXPECT_EQ(notified.size(), 1);
+
+  //clones do not notify the listeners of the original
+  auto clone = compressor->clone();
+  ASSERT_EQ(clone->set_options({{"chunking:compressor", "sample"}}), 0);
+  EXPECT_EQ(notified.size(), 1);
+
+  compressor->remove_options_listener(id);
+  ASSERT_EQ(compressor->set_options({{"chunking:compressor", "sample"}}), 0);
+  EXPECT_EQ(notified.size(), 1);
+}
+
+TEST(OptionsDiff, FailedSetOptionsAreNotReported) {
+  pressio library;
+  auto metric = library.get_metric("external");
+  size_t notified = 0;
+  metric->add_options_listener([&](pressio_configurable const&, pressio_options const&) { ++notified; });
+  const auto generation = metric->get_generation();
+
+  EXPECT_NE(metric->set_options({{"external:transport", std::string("carrier_pigeon")}}), 0);
+  EXPECT_EQ(metric->get_generation(), generation);
+  EXPECT_EQ(notified, 0);
+
+  ASSERT_EQ(metric->set_options({{"external:config_name", std::string("renamed")}}), 0);
+  EXPECT_GT(metric->get_generation(), generation);
+  EXPECT_EQ(notified, 1);
+}
@@ -0,0 +1,75 @@
+#include <cstdlib>
+#include <string>
+#include <nlohmann/json.hpp>
+#include "libpressio_ext/cpp/options.h"
+#include "libpressio_ext/cpp/libpressio.h"
+#include "libpressio_ext/cpp/json.h"
+#include "libpressio_ext/json/pressio_options_json.h"
+#include "gtest/gtest.h"
+
+TEST(PressioOptionsJson, RoundTripsEveryType) {
+  std::vector<int64_t> values{1, -2, int64_t{1} << 60, 4, 5, 6};
+  pressio_options options{
+    {"i8", int8_t{-3}}, {"u8", uint8_t{250}}, {"i16", int16_t{-300}}, {"u16", uint16_t{60000}},
+    {"i32", int32_t{-70000}}, {"u32", uint32_t{4000000000u}}, {"i64", int64_t{-(int64_t{1} << 62)}},
+    {"u64", uint64_t{1} << 63}, {"f", 1.1f}, {"d", 0.1}, {"s", std::string("quote\" slash\\ tab\t")},
+    {"strs", std::vector<std::string>{"a", "", "ccc"}},
+    {"data", pressio_data::copy(pressio_int64_dtype, values.data(), {2, 3})},
+  };
+  options.set_type("unset_int", pressio_option_int32_type);
+
+  pressio library;
+  char* json = pressio_options_to_json(&library, &options);
+  ASSERT_NE(json, nullptr);
+  pressio_options* parsed = pressio_options_new_json(&library, json);
+  ASSERT_NE(parsed, nullptr) << library.err_msg();
+  EXPECT_EQ(*parsed, options);
+  EXPECT_EQ(parsed->get("unset_int").type(), pressio_option_int32_type);
+  EXPECT_FALSE(parsed->get("unset_int").has_value());
+  pressio_options_free(parsed);
+  free(json);
+}
+
+TEST(PressioOptionsJson, ParsesArraysIntoData) {
+  const std::string json = R"({"mask": [[1, 2, 3], [4, 5, 6.5]], "names": ["a", "b"], "x": 3, "s": "str", "empty": []})";
+  pressio_options options = options_from_json(json.data(), json.size());
+
+  auto const& mask = options.get("mask").get_value<pressio_data>();
+  EXPECT_EQ(mask.dtype(), pressio_double_dtype);
+  EXPECT_EQ(mask.dimensions(), std::vector<size_t>({2, 3}));
+  EXPECT_EQ(mask.to_vector<double>(), std::vector<double>({1, 2, 3, 4, 5, 6.5}));
+  EXPECT_EQ(options.get("names").get_value<std::vector<std::string>>(), std::vector<std::string>({"a", "b"}));
+  EXPECT_EQ(options.get("x").get_value<double>(), 3.0);
+  EXPECT_EQ(options.get("s").get_value<std::string>(), "str");
+  EXPECT_EQ(options.get("empty").get_value<pressio_data>().num_elements(), 0);
+
+  //empty arrays are not supported by the nlohmann::json based path
+  options.erase("empty");
+  const std::string nonempty = R"({"mask": [[1, 2, 3], [4, 5, 6.5]], "names": ["a", "b"], "x": 3, "s": "str"})";
+  EXPECT_EQ(options, nlohmann::json::parse(nonempty).get<pressio_options>());
+}
+
+TEST(PressioOptionsJson, ReportsErrors) {
+  pressio library;
+  EXPECT_EQ(pressio_options_new_json(&library, R"({"a": [1, )"), nullptr);
+  EXPECT_EQ(library.err_code(), 2);
+  EXPECT_EQ(pressio_options_new_json(&library, R"({"a": [[1, 2], [3]]})"), nullptr);
+  EXPECT_EQ(library.err_code(), 1);
+  EXPECT_EQ(pressio_options_new_json(&library, R"({"a": [1, "b"]})"), nullptr);
+  EXPECT_EQ(library.err_code(), 1);
+
+  //the dtype of data values must be one libpressio knows
+  std::vector<int32_t> values{1, 2};
+  pressio_options options{{"data", pressio_data::copy(pressio_int32_dtype, values.data(), {2})}};
+  char* json = pressio_options_to_json(&library, &options);
+  ASSERT_NE(json, nullptr);
+  std::string invalid(json);
+  free(json);
+  const std::string dtype = "\"dtype\":" + std::to_string(pressio_int32_dtype);
+  auto pos = invalid.find(dtype);
+  ASSERT_NE(pos, std::string::npos) << invalid;
+  invalid.replace(pos, dtype.size(), "\"dtype\":999");
+  EXPECT_EQ(pressio_options_new_json(&library, invalid.c_str()), nullptr);
+  EXPECT_EQ(library.err_code(), 1);
+  EXPECT_NE(std::string(library.err_msg()).find("invalid dtype"), std::string::npos) << library.err_msg();
+}
@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <set>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "libpressio_ext/cpp/libpressio.h"
+#include "std_compat/memory.h"
+
+namespace {
+  /**
+   * a compressor that records the process it ran in, sleeps if asked to, and fails or exits on request
+   */
+  class pid_compressor_plugin: public libpressio_compressor_plugin {
+    public:
+    struct pressio_options get_configuration_impl() const override {
+      pressio_options options;
+      set(options, "pressio:thread_safe", static_cast<int32_t>(pressio_thread_safety_serialized));
+      set(options, "pressio:stability", "stable");
+      return options;
+    }
+    struct pressio_options get_documentation_impl() const override {
+      return {};
+    }
+    struct pressio_options get_options_impl() const override {
+      pressio_options options;
+      set(options, "pid:sleep_ms", sleep_ms);
+      return options;
+    }
+    int set_options_impl(struct pressio_options const& options) override {
+      get(options, "pid:sleep_ms", &sleep_ms);
+      return 0;
+    }
+
+    //the first element of the input selects the behavior: negative fails, 0 exits, otherwise records the pid
+    int compress_impl(const pressio_data *input, struct pressio_data* output) override {
+      std::this_thread::sleep_for(std::chrono::milliseconds(sleep_ms));
+      const double mode = static_cast<const double*>(input->data())[0];
+      if(mode < 0) return set_error(3, "asked to fail");
+      if(mode == 0) _exit(1);
+      *output = pressio_data{static_cast<double>(getpid()), mode};
+      return 0;
+    }
+    int decompress_impl(const pressio_data *input, struct pressio_data* output) override {
+      *output = pressio_data::clone(*input);
+      return 0;
+    }
+
+    int major_version() const override { return 0; }
+    int minor_version() const override { return 0; }
+    int patch_version() const override { return 0; }
+    const char* version() const override { return "0.0.0"; }
+    const char* prefix() const override { return "pid"; }
+    std::shared_ptr<libpressio_compressor_plugin> clone() override {
+      return compat::make_unique<pid_compressor_plugin>(*this);
+    }
+
+    uint32_t sleep_ms = 0;
+  };
+
+  pressio_register pid_plugin(compressor_plugins(), "pid", [](){ return compat::make_unique<pid_compressor_plugin>(); });
+
+  /**
+   * runs compress_many on one input per entry of modes
+   */
+  int compress_modes(pressio_compressor& compressor, std::vector<double> const& modes, std::vector<pressio_data>& outputs) {
+    std::vector<pressio_data> inputs;
+    for (double mode : modes) {
+      inputs.push_back(pressio_data{mode});
+    }
+    outputs.assign(modes.size(), pressio_data::empty(pressio_double_dtype, {}));
+    std::vector<const pressio_data*> input_ptrs;
+    std::vector<pressio_data*> output_ptrs;
+    for (size_t i = 0; i < modes.size(); ++i) {
+      input_ptrs.push_back(&inputs[i]);
+      output_ptrs.push_back(&outputs[i]);
+    }
+    return compressor->compress_many(input_ptrs.data(), input_ptrs.data() + input_ptrs.size(),
+        output_ptrs.data(), output_ptrs.data() + output_ptrs.size());
+  }
+
+  pressio_compressor make_pool(uint32_t nprocs, uint32_t sleep_ms = 0) {
+    pressio library;
+    auto compressor = library.get_compressor("process_pool");
+    compressor->set_options({
+        {"process_pool:compressor", std::string("pid")},
+        {"process_pool:nprocs", nprocs},
+        {"pid:sleep_ms", sleep_ms},
+    });
+    return compressor;
+  }
+
+  double element(pressio_data const& data, size_t i) {
+    return static_cast<const double*>(data.data())[i];
+  }
+}
+
+TEST(ProcessPool, CompressesInPersistentWorkerProcesses) {
+  auto compressor = make_pool(2);
+  std::vector<pressio_data> outputs;
+  ASSERT_EQ(compress_modes(compressor, {1, 2, 3, 4, 5}, outputs), 0) << compressor->error_msg();
+
+  std::set<double> pids;
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    ASSERT_EQ(outputs[i].num_elements(), 2);
+    EXPECT_EQ(element(outputs[i], 1), i + 1);
+    pids.insert(element(outputs[i], 0));
+  }
+  EXPECT_EQ(pids.count(getpid()), 0);
+  EXPECT_LE(pids.size(), 2);
+
+  ASSERT_EQ(compress_modes(compressor, {1, 2}, outputs), 0);
+  for (auto const& output : outputs) {
+    EXPECT_EQ(pids.count(element(output, 0)), 1);
+  }
+}
+
+TEST(ProcessPool, RunsWorkersInParallel) {
+  auto compressor = make_pool(4, 300);
+  std::vector<pressio_data> outputs;
+  auto begin = std::chrono::steady_clock::now();
+  ASSERT_EQ(compress_modes(compressor, {1, 2, 3, 4}, outputs), 0);
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+  //one at a time the buffers take at least 1.2 seconds
+  EXPECT_LT(elapsed, 0.9);
+}
+
+TEST(ProcessPool, ReportsErrorsAndReplacesWorkersThatExit) {
+  auto compressor = make_pool(2);
+  std::vector<pressio_data> outputs;
+  EXPECT_EQ(compress_modes(compressor, {1, -1}, outputs), 3);
+  EXPECT_EQ(std::string(compressor->error_msg()), "asked to fail");
+
+  EXPECT_NE(compress_modes(compressor, {0}, outputs), 0);
+  ASSERT_EQ(compress_modes(compressor, {1, 2, 3}, outputs), 0) << compressor->error_msg();
+  EXPECT_EQ(element(outputs[2], 1), 3);
+}
+
+TEST(ProcessPool, RoundTripsThroughTheChildCompressor) {
+  pressio library;
+  auto compressor = library.get_compressor("process_pool");
+  compressor->set_options({
+      {"process_pool:nprocs", 3u},
+      {"process_pool:group_size", uint64_t{2}},
+  });
+
+  std::vector<pressio_data> inputs{
+    pressio_data{1.0, 2.0, 3.0, 4.0, 5.0, 6.0},
+    pressio_data{1, 2, 3},
+    pressio_data{1.5f, 2.5f},
+    pressio_data::owning(pressio_int8_dtype, {0}),
+  };
+  inputs[0].reshape({2, 3});
+  std::vector<pressio_data> compressed(inputs.size(), pressio_data::empty(pressio_byte_dtype, {}));
+  std::vector<pressio_data> decompressed;
+  for (auto const& input : inputs) {
+    decompressed.push_back(pressio_data::empty(input.dtype(), input.dimensions()));
+  }
+  std::vector<const pressio_data*> input_ptrs, compressed_cptrs;
+  std::vector<pressio_data*> compressed_ptrs, decompressed_ptrs;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    input_ptrs.push_back(&inputs[i]);
+    compressed_ptrs.push_back(&compressed[i]);
+    compressed_cptrs.push_back(&compressed[i]);
+    decompressed_ptrs.push_back(&decompressed[i]);
+  }
+  ASSERT_EQ(compressor->compress_many(input_ptrs.data(), input_ptrs.data() + input_ptrs.size(),
+        compressed_ptrs.data(), compressed_ptrs.data() + compressed_ptrs.size()), 0) << compressor->error_msg();
+  ASSERT_EQ(compressor->decompress_many(compressed_cptrs.data(), compressed_cptrs.data() + compressed_cptrs.size(),
+        decompressed_ptrs.data(), decompressed_ptrs.data() + decompressed_ptrs.size()), 0) << compressor->error_msg();
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    EXPECT_EQ(decompressed[i], inputs[i]) << i;
+  }
+
+  //three buffers are split into a group of two and a group of one
+  for (auto& buffer : decompressed) {
+    buffer = pressio_data::empty(buffer.dtype(), buffer.dimensions());
+  }
+  ASSERT_EQ(compressor->compress_many(input_ptrs.data(), input_ptrs.data() + 3,
+        compressed_ptrs.data(), compressed_ptrs.data() + 3), 0) << compressor->error_msg();
+  ASSERT_EQ(compressor->decompress_many(compressed_cptrs.data(), compressed_cptrs.data() + 3,
+        decompressed_ptrs.data(), decompressed_ptrs.data() + 3), 0) << compressor->error_msg();
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(decompressed[i], inputs[i]) << i;
+  }
+
+  //as is a single buffer
+  auto single = pressio_data::empty(pressio_byte_dtype, {});
+  auto single_decompressed = pressio_data::empty(inputs[1].dtype(), inputs[1].dimensions());
+  ASSERT_EQ(compressor->compress(&inputs[1], &single), 0) << compressor->error_msg();
+  ASSERT_EQ(compressor->decompress(&single, &single_decompressed), 0) << compressor->error_msg();
+  EXPECT_EQ(single_decompressed, inputs[1]);
+}
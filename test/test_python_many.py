@@ -0,0 +1,37 @@
+#!/usr/bin/env python
+import sys
+from concurrent.futures import ThreadPoolExecutor
+pressio_path = sys.argv[1]
+sys.path.insert(0, pressio_path)
+import pressio
+import numpy as np
+
+rng = np.random.default_rng(0)
+library = pressio.instance()
+compressor = pressio.get_compressor(library, b"noop")
+
+arrays = [rng.random(size=(i + 2, 7, 3)) for i in range(4)]
+compressed = pressio._pressio_compressor_compress_many(compressor, arrays)
+assert compressed is not None, pressio.compressor_error_msg(compressor)
+assert len(compressed) == len(arrays)
+
+outputs = [np.zeros_like(a) for a in arrays]
+decompressed = pressio._pressio_compressor_decompress_many(compressor, compressed, outputs)
+assert decompressed is not None, pressio.compressor_error_msg(compressor)
+for a, d in zip(arrays, decompressed):
+    assert d.shape == a.shape and d.dtype == a.dtype
+    assert np.array_equal(a, d)
+
+# compressing from several python threads at once must neither deadlock nor corrupt results
+def roundtrip(array):
+    local = pressio.compressor_clone(compressor)
+    comp = pressio._pressio_compressor_compress_many(local, [array])
+    dec = pressio._pressio_compressor_decompress_many(local, comp, [np.zeros_like(array)])
+    pressio.compressor_release(local)
+    return np.array_equal(array, dec[0])
+
+with ThreadPoolExecutor(4) as pool:
+    assert all(pool.map(roundtrip, arrays * 4))
+
+pressio.compressor_release(compressor)
+pressio.release(library)
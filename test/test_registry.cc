@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "libpressio_ext/cpp/data.h"
+#include "libpressio_ext/cpp/options.h"
+#include "libpressio_ext/cpp/pressio.h"
+#include "libpressio_ext/cpp/plugin_loader.h"
+#include "pressio.h"
+#include "pressio_options.h"
+#include "gtest/gtest.h"
+
+namespace {
+  using metrics_registry = pressio_registry<std::unique_ptr<libpressio_metrics_plugin>>;
+}
+
+TEST(Registry, MetaCompressorsCanUsePrototypes) {
+  //process_pool builds a noop child from compressor_plugins() in its constructor; this runs first so
+  //that the registry is not yet published when the prototype is built
+  ASSERT_TRUE(compressor_plugins().use_prototype("process_pool"));
+  auto built = compressor_plugins().build("process_pool");
+  ASSERT_NE(built, nullptr);
+  EXPECT_STREQ(built->prefix(), "process_pool");
+}
+
+TEST(Registry, BuildsFromPrototypes) {
+  metrics_registry registry;
+  std::atomic<int> constructed{0};
+  registry.regsiter_factory("counted", [&]{
+      ++constructed;
+      return metrics_plugins().build("size");
+  });
+
+  EXPECT_TRUE(registry.contains("counted"));
+  EXPECT_FALSE(registry.contains("missing"));
+  EXPECT_EQ(registry.build("missing"), nullptr);
+  ASSERT_NE(registry.build("counted"), nullptr);
+  EXPECT_EQ(constructed, 1);
+
+  EXPECT_FALSE(registry.use_prototype("missing"));
+  ASSERT_TRUE(registry.use_prototype("counted"));
+  EXPECT_EQ(constructed, 2);
+  for (int i = 0; i < 3; ++i) {
+    auto built = registry.build("counted");
+    ASSERT_NE(built, nullptr);
+    EXPECT_STREQ(built->prefix(), "size");
+  }
+  EXPECT_EQ(constructed, 2);
+}
+
+TEST(Registry, PrototypeFactoriesMayBuildFromTheSameRegistry) {
+  //like meta-compressors, this factory builds its child from the registry it is registered in
+  pressio_registry<std::shared_ptr<libpressio_compressor_plugin>> registry;
+  registry.regsiter_factory("noop", []{ return compressor_plugins().build("noop"); });
+  registry.regsiter_factory("wrapper", [&registry]{ return registry.build("noop"); });
+
+  ASSERT_TRUE(registry.use_prototype("wrapper"));
+  auto built = registry.build("wrapper");
+  ASSERT_NE(built, nullptr);
+  EXPECT_STREQ(built->prefix(), "noop");
+}
+
+TEST(Registry, IoPluginsAreNotBuiltFromPrototypes) {
+  pressio_registry<std::unique_ptr<libpressio_io_plugin>> registry;
+  registry.regsiter_factory("posix", []{ return io_plugins().build("posix"); });
+
+  //io clones are shared_ptrs which cannot become the unique_ptrs the registry returns
+  EXPECT_FALSE(registry.use_prototype("posix"));
+  auto built = registry.build("posix");
+  ASSERT_NE(built, nullptr);
+  EXPECT_STREQ(built->prefix(), "posix");
+}
+
+TEST(Registry, IteratesOverOneSnapshot) {
+  metrics_registry registry;
+  registry.regsiter_factory("a", []{ return metrics_plugins().build("size"); });
+  registry.regsiter_factory("b", []{ return metrics_plugins().build("size"); });
+
+  //a registration after begin() publishes a new snapshot, but iteration stays within the first one
+  auto it = registry.begin();
+  registry.regsiter_factory("c", []{ return metrics_plugins().build("size"); });
+  std::vector<std::string> names;
+  for (; it != registry.end(); ++it) names.push_back(it->first);
+  EXPECT_EQ(names, std::vector<std::string>({"a", "b"}));
+
+  EXPECT_NE(registry.find("c"), registry.end());
+  EXPECT_EQ(registry.find("missing"), registry.end());
+  EXPECT_EQ(std::distance(registry.begin(), registry.end()), 3);
+}
+
+TEST(Registry, ConcurrentBuildsAndRegistrations) {
+  metrics_registry registry;
+  registry.regsiter_factory("size", []{ return metrics_plugins().build("size"); });
+  registry.freeze();
+  auto const& before = registry.current();
+
+  std::atomic<int> failures{0};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&]{
+      for (int j = 0; j < 200; ++j) {
+        if(!registry.build("size")) ++failures;
+      }
+    });
+  }
+  for (int i = 0; i < 20; ++i) {
+    registry.regsiter_factory("late" + std::to_string(i), []{ return metrics_plugins().build("size"); });
+  }
+  for (auto& reader : readers) reader.join();
+
+  EXPECT_EQ(failures, 0);
+  EXPECT_EQ(before.size(), 1);
+  EXPECT_EQ(registry.current().size(), 21);
+  EXPECT_TRUE(registry.contains("late19"));
+  std::vector<std::string> names;
+  for (auto const& entry : registry) names.push_back(entry.first);
+  EXPECT_TRUE(std::is_sorted(names.begin(), names.end()));
+}
+
+TEST(PluginLoader, LoadsModulesOnFirstUse) {
+  auto& loader = plugin_loader();
+  loader.set_search_path({"/nonexistent", PLUGIN_MODULE_DIR});
+  EXPECT_FALSE(compressor_plugins().contains("not_a_module"));
+
+  auto modules = loader.modules();
+  ASSERT_EQ(modules.size(), 1);
+  EXPECT_EQ(modules.front().name, "loaded_noop");
+  EXPECT_FALSE(modules.front().loaded);
+
+  auto compressor = compressor_plugins().build("loaded_noop");
+  ASSERT_NE(compressor, nullptr);
+  EXPECT_STREQ(compressor->prefix(), "noop");
+
+  modules = loader.modules();
+  ASSERT_EQ(modules.size(), 1);
+  EXPECT_TRUE(modules.front().loaded);
+  EXPECT_GE(modules.front().load_seconds, 0);
+  EXPECT_EQ(modules.front().provides, std::vector<std::string>{"compressor:loaded_noop"});
+
+  pressio* library = pressio_instance();
+  EXPECT_EQ(pressio_load_plugin(library, modules.front().path.c_str()), 0);
+  EXPECT_NE(pressio_load_plugin(library, "/nonexistent/libpressio_plugin_missing.so"), 0);
+  EXPECT_NE(pressio_error_code(library), 0);
+  pressio_release(library);
+}
+
+TEST(StartupReport, RecordsRegistrations) {
+  pressio_options* report = pressio_startup_report();
+  ASSERT_NE(report, nullptr);
+  std::vector<std::string> names;
+  ASSERT_EQ(report->get("startup:names", &names), pressio_options_key_set);
+  EXPECT_NE(std::find(names.begin(), names.end(), "register:noop"), names.end());
+
+  pressio_data seconds;
+  ASSERT_EQ(report->get("startup:seconds", &seconds), pressio_options_key_set);
+  EXPECT_EQ(seconds.num_elements(), names.size());
+  pressio_options_free(report);
+}
@@ -0,0 +1,83 @@
+/**
+ * reports the cost of starting libpressio and constructing each compressor so that regressions in
+ * startup time can be tracked
+ *
+ * usage: startup_benchmark [iterations] [compressor_id...]
+ *
+ * prints one tab separated line per static registration or library initialization recorded by
+ * pressio_startup_report, then the median and maximum latency of pressio_instance() followed by
+ * pressio_get_compressor() for each compressor.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <libpressio.h>
+#include <libpressio_ext/cpp/data.h>
+#include <libpressio_ext/cpp/options.h>
+#include <libpressio_ext/cpp/pressio.h>
+
+namespace {
+  std::vector<std::string> compressor_ids() {
+    std::vector<std::string> ids;
+    for (auto const& entry : compressor_plugins()) {
+      ids.emplace_back(entry.first);
+    }
+    return ids;
+  }
+
+  void print_startup_report() {
+    pressio_options* report = pressio_startup_report();
+    std::vector<std::string> names;
+    pressio_data seconds, rss_bytes;
+    double total = 0;
+    report->get("startup:names", &names);
+    report->get("startup:seconds", &seconds);
+    report->get("startup:rss_bytes", &rss_bytes);
+    report->get("startup:total_seconds", &total);
+    auto seconds_v = seconds.to_vector<double>();
+    auto rss_v = rss_bytes.to_vector<int64_t>();
+    std::cout << "event\tseconds\trss_bytes\n";
+    for (size_t i = 0; i < names.size(); ++i) {
+      std::cout << names[i] << '\t' << seconds_v[i] << '\t' << rss_v[i] << '\n';
+    }
+    std::cout << "total\t" << total << "\t-\n\n";
+    pressio_options_free(report);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  const size_t iterations = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 100;
+  std::vector<std::string> ids(argv + std::min(argc, 2), argv + argc);
+  if(ids.empty()) ids = compressor_ids();
+
+  print_startup_report();
+
+  std::cout << "compressor\tmedian_seconds\tmax_seconds\n";
+  int failed = 0;
+  for (auto const& id : ids) {
+    std::vector<double> latencies;
+    latencies.reserve(iterations);
+    for (size_t i = 0; i < iterations; ++i) {
+      const auto begin = std::chrono::steady_clock::now();
+      pressio* library = pressio_instance();
+      pressio_compressor* compressor = pressio_get_compressor(library, id.c_str());
+      const auto end = std::chrono::steady_clock::now();
+      if(compressor == nullptr) {
+        std::cerr << "failed to construct " << id << ": " << pressio_error_msg(library) << std::endl;
+        pressio_release(library);
+        ++failed;
+        break;
+      }
+      latencies.emplace_back(std::chrono::duration<double>(end - begin).count());
+      pressio_compressor_release(compressor);
+      pressio_release(library);
+    }
+    if(latencies.empty()) continue;
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << id << '\t' << latencies[latencies.size() / 2] << '\t' << latencies.back() << '\n';
+  }
+  return failed != 0;
+}
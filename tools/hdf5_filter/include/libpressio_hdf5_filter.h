@@ -1,3 +1,4 @@
+#include <stddef.h>
 #include <H5PLextern.h>
 
 #ifdef __cplusplus
@@ -14,6 +15,33 @@ herr_t H5Pset_libpressio(hid_t dcpl, const char* compressor_id, struct pressio_o
 
 const void* H5PLget_plugin_info();
 
+/**
+ * statistics for the cache of configured compressors used by the filter
+ */
+struct H5Z_libpressio_cache_stats {
+  /** chunks filtered with a compressor configured from the same cd_values */
+  size_t hits;
+  /** chunks that required configuring a new compressor */
+  size_t misses;
+  /** configurations evicted to stay within the cache size */
+  size_t evictions;
+  /** configurations currently cached */
+  size_t entries;
+};
+
+/**
+ * \param[out] stats the current statistics for the compressor cache
+ */
+void H5Z_libpressio_get_cache_stats(struct H5Z_libpressio_cache_stats* stats);
+
+/**
+ * sets the number of distinct configurations the filter keeps configured compressors for; the least
+ * recently used configurations are evicted first.  The default is 16; 0 disables the cache.
+ *
+ * \param[in] max_entries the number of configurations to cache
+ */
+void H5Z_libpressio_set_cache_size(size_t max_entries);
+
 extern const H5Z_class2_t H5Z_LIBPRESSIO[1];
 
 #ifdef __cplusplus
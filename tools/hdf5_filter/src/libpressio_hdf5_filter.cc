@@ -3,6 +3,9 @@
 #include <libpressio_ext/cpp/libpressio.h>
 #include <libpressio_ext/cpp/json.h>
 #include <nlohmann/json.hpp>
+#include <list>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 #include <string>
 #include <endian.h>
@@ -69,8 +72,153 @@ static std::vector<unsigned int> get_cd_values_from_options(compression_options
   return ret;
 }
 
+namespace {
+  /**
+   * caches configured compressors by the bytes of their cd_values so that each chunk does not have to
+   * decode the options and build and configure a new compressor.  Each key keeps a configured prototype
+   * which is only ever cloned, and a small pool of idle instances so that concurrent users of the same
+   * key each get their own instance.  Keys are evicted in least recently used order.
+   */
+  class compressor_cache {
+    public:
+    /**
+     * a compressor checked out of the cache; it is returned to the pool of its key when destroyed
+     */
+    class lease {
+      public:
+      lease(compressor_cache* cache, std::string key, pressio_compressor compressor, pressio_dtype dtype, std::vector<size_t> dims):
+        compressor(std::move(compressor)), dtype(dtype), dims(std::move(dims)), cache(cache), key(std::move(key)) {}
+      lease(lease&& rhs)=default;
+      lease& operator=(lease&&)=delete;
+      lease(lease const&)=delete;
+      lease& operator=(lease const&)=delete;
+      ~lease() {
+        if(cache && compressor) cache->release(key, std::move(compressor));
+      }
+
+      pressio_compressor compressor;
+      pressio_dtype dtype;
+      std::vector<size_t> dims;
+
+      private:
+      compressor_cache* cache;
+      std::string key;
+    };
+
+    /**
+     * \returns a configured compressor for cd_values; lease::compressor is null if it could not be built
+     */
+    lease acquire(size_t cd_nelmts, const unsigned int* cd_values) {
+      std::string key(reinterpret_cast<const char*>(cd_values), cd_nelmts * sizeof(unsigned int));
+      std::unique_lock<std::mutex> guard(lock);
+      auto it = entries.find(key);
+      if(it != entries.end()) {
+        ++hits;
+        auto& entry = it->second;
+        lru.splice(lru.begin(), lru, entry.lru);
+        if(!entry.idle.empty()) {
+          pressio_compressor compressor = std::move(entry.idle.back());
+          entry.idle.pop_back();
+          return lease(this, std::move(key), std::move(compressor), entry.dtype, entry.dims);
+        }
+        auto prototype = entry.prototype.plugin;
+        const pressio_dtype dtype = entry.dtype;
+        std::vector<size_t> dims = entry.dims;
+        //clone outside of the lock; the prototype is never modified so concurrent clones are safe
+        guard.unlock();
+        return lease(this, std::move(key), pressio_compressor(prototype->clone()), dtype, std::move(dims));
+      }
+      ++misses;
+      guard.unlock();
+
+      auto options = get_options_from_cd_values(cd_nelmts, cd_values);
+      pressio library;
+      pressio_compressor compressor = library.get_compressor(options.compressor_id);
+      if(!compressor || compressor->set_options(options.options)) {
+        return lease(nullptr, std::move(key), pressio_compressor(), options.dtype, std::move(options.dims));
+      }
+
+      //the prototype is a separate clone so that it is never used to compress while other threads clone it
+      pressio_compressor prototype(compressor->clone());
+
+      guard.lock();
+      if(max_entries != 0 && entries.find(key) == entries.end()) {
+        while(entries.size() >= max_entries) {
+          entries.erase(lru.back());
+          lru.pop_back();
+          ++evictions;
+        }
+        lru.push_front(key);
+        auto& entry = entries[key];
+        entry.prototype = std::move(prototype);
+        entry.dtype = options.dtype;
+        entry.dims = options.dims;
+        entry.lru = lru.begin();
+      }
+      return lease(this, std::move(key), std::move(compressor), options.dtype, std::move(options.dims));
+    }
+
+    void stats(H5Z_libpressio_cache_stats* stats) {
+      std::lock_guard<std::mutex> guard(lock);
+      stats->hits = hits;
+      stats->misses = misses;
+      stats->evictions = evictions;
+      stats->entries = entries.size();
+    }
+
+    void resize(size_t new_max_entries) {
+      std::lock_guard<std::mutex> guard(lock);
+      max_entries = new_max_entries;
+      while(entries.size() > max_entries) {
+        entries.erase(lru.back());
+        lru.pop_back();
+        ++evictions;
+      }
+    }
+
+    private:
+    void release(std::string const& key, pressio_compressor&& compressor) {
+      std::lock_guard<std::mutex> guard(lock);
+      auto it = entries.find(key);
+      if(it != entries.end() && it->second.idle.size() < max_idle) {
+        it->second.idle.emplace_back(std::move(compressor));
+      }
+    }
+
+    struct entry {
+      pressio_compressor prototype;
+      std::vector<pressio_compressor> idle;
+      pressio_dtype dtype;
+      std::vector<size_t> dims;
+      std::list<std::string>::iterator lru;
+    };
+
+    std::mutex lock;
+    std::unordered_map<std::string, entry> entries;
+    std::list<std::string> lru;
+    size_t max_entries = 16;
+    static const size_t max_idle = 4;
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+  };
+
+  compressor_cache& filter_cache() {
+    static compressor_cache cache;
+    return cache;
+  }
+}
+
 extern "C" {
 
+void H5Z_libpressio_get_cache_stats(struct H5Z_libpressio_cache_stats* stats) {
+  filter_cache().stats(stats);
+}
+
+void H5Z_libpressio_set_cache_size(size_t max_entries) {
+  filter_cache().resize(max_entries);
+}
+
 #define H5Z_LIBPRESSIO_PUSH_AND_GOTO(MAJ, MIN, RET, MSG) \
   do {                                                                         \
     H5Epush(H5E_DEFAULT, __FILE__, _funcname_, __LINE__, H5E_ERR_CLS, MAJ,     \
@@ -99,41 +247,53 @@ extern "C" {
                                       size_t n_bytes, size_t* buf_size,
                                       void** buf)
   {
-    //parse compression_options from cd_values, cd_nelmts
-    auto comp_options = get_options_from_cd_values(cd_nelmts, cd_values);
-    
-    //instantiate the data
-
-    //instantiate the compressor from cd_values
-    pressio library;
-    pressio_compressor compressor = library.get_compressor(comp_options.compressor_id);
-    compressor->set_options(comp_options.options);
+    static char const*_funcname_ = "H5Z_filter_libpressio";
+    size_t retval = 0;
+
+    //reuse a compressor configured from the same cd_values if possible
+    auto leased = filter_cache().acquire(cd_nelmts, cd_values);
+    auto& compressor = leased.compressor;
+    if(!compressor) {
+      H5Z_LIBPRESSIO_PUSH_AND_GOTO(H5E_PLINE, H5E_CANTINIT, 0, "failed to configure the libpressio compressor");
+    }
         
-    if (flags & H5Z_FLAG_REVERSE) {
-      // preform decompression
-      pressio_data const& input = pressio_data::nonowning(pressio_byte_dtype, *buf, {n_bytes});
-      pressio_data output = pressio_data::owning(comp_options.dtype, comp_options.dims);
-      int rc = compressor->decompress(&input, &output);
-      if(rc == 0) {
-        H5free_memory(*buf);
-        *buf = pressio_data_copy(&output, buf_size);
+    {
+      int rc;
+      pressio_data output;
+      if (flags & H5Z_FLAG_REVERSE) {
+        // preform decompression
+        pressio_data const& input = pressio_data::nonowning(pressio_byte_dtype, *buf, {n_bytes});
+        output = pressio_data::owning(leased.dtype, leased.dims);
+        rc = compressor->decompress(&input, &output);
       } else {
-        *buf_size = 0;
+        // preform compression
+        pressio_data const& input = pressio_data::nonowning(leased.dtype, *buf, leased.dims);
+        output = pressio_data::empty(pressio_byte_dtype, {});
+        rc = compressor->compress(&input, &output);
       }
-    } else {
-      // preform compression
-      pressio_data const& input = pressio_data::nonowning(comp_options.dtype, *buf, comp_options.dims);
-      pressio_data output = pressio_data::empty(pressio_byte_dtype, {});
-      int rc = compressor->compress(&input, &output);
-      if(rc == 0) {
-        H5free_memory(*buf);
-        *buf = pressio_data_copy(&output, buf_size);
-      } else {
-        *buf_size = 0;
+      if(rc) {
+        H5Z_LIBPRESSIO_PUSH_AND_GOTO(H5E_PLINE, H5E_CANTFILTER, 0, "libpressio failed to filter the chunk");
       }
+
+      //HDF5 frees filter buffers with free(), so a malloc'd result is handed over without a copy;
+      //anything else is copied once into memory from HDF5's allocator
+      const size_t output_bytes = output.size_in_bytes();
+      void* result = output.release_malloc();
+      if(result == nullptr) {
+        result = H5allocate_memory(output_bytes, false);
+        if(result == nullptr) {
+          H5Z_LIBPRESSIO_PUSH_AND_GOTO(H5E_RESOURCE, H5E_NOSPACE, 0, "failed to allocate the filtered chunk");
+        }
+        memcpy(result, output.data(), output_bytes);
+      }
+      H5free_memory(*buf);
+      *buf = result;
+      *buf_size = output_bytes;
     }
 
     return *buf_size;
+done:
+    return retval;
   }
 
   /**
@@ -156,7 +156,7 @@ def _from_data_option(x):
     if pressio.data_dtype(lp) == pressio.byte_dtype:
         ret = pressio.io_data_to_bytes(lp)
     else:
-        ret = pressio.io_data_to_numpy(lp)
+        ret = pressio.io_data_move_to_numpy(lp)
     pressio.data_free(lp)
     return ret
 
@@ -301,7 +301,7 @@ class PressioCompressor(Codec):
             if rc:
                 raise PressioException.from_compressor(self._compressor)
 
-            dec = pressio.io_data_to_numpy(decompressed_lp)
+            dec = pressio.io_data_move_to_numpy(decompressed_lp)
 
             if decompressed is not None:
                 return dec
@@ -311,6 +311,38 @@ class PressioCompressor(Codec):
             pressio.data_free(compressed_lp)
             pressio.data_free(decompressed_lp)
 
+    def compress_many(self, uncompressed):
+        """compress a batch of arrays in one call; compressors such as many_independent_threaded
+        process the batch in parallel.  The GIL is released while compressing.
+
+        params:
+            uncompressed: List[np.ndarray] - the arrays to be compressed
+        returns:
+            List[bytes] - the compressed arrays
+        """
+        uncompressed = [np.ascontiguousarray(i) for i in uncompressed]
+        comp = pressio._pressio_compressor_compress_many(self._compressor, uncompressed)
+        if comp is None:
+            raise PressioException.from_compressor(self._compressor)
+        return comp
+
+    def decompress_many(self, compressed, decompressed):
+        """decompress a batch of buffers in one call; compressors such as many_independent_threaded
+        process the batch in parallel.  The GIL is released while decompressing.
+
+        params:
+            compressed: List[bytes] - the data to be decompressed
+            decompressed: List[np.ndarray] - arrays with the type and shape of the decompressed data;
+                they are decompressed into when the compressor supports it
+        returns:
+            List[np.ndarray] - the decompressed arrays
+        """
+        decompressed = [np.ascontiguousarray(i) for i in decompressed]
+        dec = pressio._pressio_compressor_decompress_many(self._compressor, compressed, decompressed)
+        if dec is None:
+            raise PressioException.from_compressor(self._compressor)
+        return dec
+
     def get_compile_config(self):
         """get compile time configuration"""
         lp_options = pressio.compressor_get_configuration(self._compressor)
@@ -425,7 +457,7 @@ class PressioIO:
         ret_lp = pressio.io_read(self._io, template)
         if not ret_lp:
             raise PressioException.from_io(self._io)
-        ret = pressio.io_data_to_numpy(ret_lp)
+        ret = pressio.io_data_move_to_numpy(ret_lp)
         pressio.data_free(ret_lp)
         if template is not None:
             pressio.data_free(template)
@@ -2,7 +2,7 @@
 python bindings for pressio
 */
 
-%module pressio
+%module(threads="1") pressio
 
 %{
 #define SWIG_FILE_WITH_INIT
@@ -26,6 +26,23 @@ python bindings for pressio
 import_array();
 %}
 
+/*
+ * the GIL is held by default, and released only around calls that may run for a long time and
+ * do not touch python objects so that other python threads can run concurrently
+ */
+%nothread;
+%thread pressio_compressor_compress;
+%thread pressio_compressor_decompress;
+%thread pressio_compressor_compress_many;
+%thread pressio_compressor_decompress_many;
+%thread pressio_compressor_compress_stream;
+%thread pressio_compressor_decompress_stream;
+%thread pressio_compressor_set_options;
+%thread pressio_metrics_evaluate;
+%thread pressio_io_read;
+%thread pressio_io_read_region;
+%thread pressio_io_write;
+
 
 %include "pressio_version.h"
 %include "pybuffer.i"
@@ -237,15 +254,32 @@ __pressio_to_np_dtype = {
 
 
 def io_data_from_numpy(array):
+  """wraps array without copying it when it is writable and C-contiguous, otherwise copies it"""
+  view = _pressio_io_data_from_numpy_view(array)
+  if view is not None:
+    return view
+  array = numpy.ascontiguousarray(array)
   length = len(array.shape)
   dtype = array.dtype
   return __pressio_from_numpy[length, dtype](array)
 
 def io_data_to_numpy(ptr):
+  """returns a numpy array holding a copy of ptr"""
+  array = _pressio_io_data_to_numpy_copy(ptr)
+  if array is not None:
+    return array
   num_dims = data_num_dimensions(ptr)
   dtype = data_dtype(ptr)
   return __pressio_to_numpy[num_dims, dtype](ptr)
 
+def io_data_move_to_numpy(ptr):
+  """returns a numpy array that takes over the buffer of ptr without copying it when ptr owns its buffer;
+  afterwards ptr has no buffer, but still needs to be freed"""
+  array = _pressio_io_data_to_numpy_view(ptr)
+  if array is not None:
+    return array
+  return io_data_to_numpy(ptr)
+
 %}
 
 %include "pressio.h"
@@ -1,12 +1,17 @@
+#include <Python.h>
 #include "pressio_data.h"
 #include "pressio_options.h"
+#include "pressio_compressor.h"
 #include "libpressio_ext/cpp/dtype.h"
 #include "libpressio_ext/cpp/data.h"
 #include "libpressio_ext/cpp/options.h"
 #include <vector>
 #include <cstdint>
 #include <algorithm>
+#include <memory>
 #include "pressio_version.h"
+#define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
+#include <numpy/arrayobject.h>
 
 #if LIBPRESSIO_HAS_MPI4PY
 #include <mpi.h>
@@ -21,6 +26,295 @@ pressio_option* option_new_comm(MPI_Comm comm) {
 
 #endif
 
+#ifndef SWIG
+namespace {
+  /**
+   * releases the buffer of an exporting python object once libpressio is done with it;
+   * this may be called from threads that do not hold the GIL
+   */
+  void _pressio_release_py_buffer(void*, void* metadata) {
+    PyGILState_STATE state = PyGILState_Ensure();
+    Py_buffer* view = static_cast<Py_buffer*>(metadata);
+    PyBuffer_Release(view);
+    delete view;
+    PyGILState_Release(state);
+  }
+
+  /**
+   * \returns true and sets dtype if format describes a native scalar type libpressio supports
+   */
+  bool _pressio_dtype_from_format(const char* format, Py_ssize_t itemsize, pressio_dtype* dtype) {
+    if(format == nullptr) format = "B";
+    switch(*format) {
+      case '@': case '=': ++format; break;
+#if PY_BIG_ENDIAN
+      case '>': case '!': ++format; break;
+#else
+      case '<': ++format; break;
+#endif
+    }
+    if(format[0] == '\0' || format[1] != '\0') return false;
+    switch(format[0]) {
+      case 'f': case 'd':
+        if(itemsize == 4) *dtype = pressio_float_dtype;
+        else if(itemsize == 8) *dtype = pressio_double_dtype;
+        else return false;
+        return true;
+      case 'b': case 'h': case 'i': case 'l': case 'q': case 'n':
+        switch(itemsize) {
+          case 1: *dtype = pressio_int8_dtype; return true;
+          case 2: *dtype = pressio_int16_dtype; return true;
+          case 4: *dtype = pressio_int32_dtype; return true;
+          case 8: *dtype = pressio_int64_dtype; return true;
+          default: return false;
+        }
+      case 'B': case 'H': case 'I': case 'L': case 'Q': case 'N':
+        switch(itemsize) {
+          case 1: *dtype = pressio_uint8_dtype; return true;
+          case 2: *dtype = pressio_uint16_dtype; return true;
+          case 4: *dtype = pressio_uint32_dtype; return true;
+          case 8: *dtype = pressio_uint64_dtype; return true;
+          default: return false;
+        }
+      default:
+        return false;
+    }
+  }
+
+  int _pressio_numpy_typenum(pressio_dtype dtype) {
+    switch(dtype) {
+      case pressio_float_dtype: return NPY_FLOAT32;
+      case pressio_double_dtype: return NPY_FLOAT64;
+      case pressio_int8_dtype: return NPY_INT8;
+      case pressio_int16_dtype: return NPY_INT16;
+      case pressio_int32_dtype: return NPY_INT32;
+      case pressio_int64_dtype: return NPY_INT64;
+      case pressio_uint8_dtype: return NPY_UINT8;
+      case pressio_uint16_dtype: return NPY_UINT16;
+      case pressio_uint32_dtype: return NPY_UINT32;
+      case pressio_uint64_dtype: return NPY_UINT64;
+      default: return -1;
+    }
+  }
+
+  void _pressio_free_capsule_data(PyObject* capsule) {
+    delete static_cast<pressio_data*>(PyCapsule_GetPointer(capsule, "pressio_data"));
+  }
+
+  /**
+   * wraps the buffer exported by obj, keeping obj alive until the pressio_data is freed
+   *
+   * \param[in] obj the object to wrap
+   * \param[in] flags the flags passed to PyObject_GetBuffer
+   * \param[in] as_bytes if true, wrap the buffer as a 1d byte array regardless of its format
+   * \returns a new pressio_data or nullptr if obj cannot be wrapped
+   */
+  pressio_data* _pressio_wrap_py_buffer(PyObject* obj, int flags, bool as_bytes) {
+    Py_buffer* view = new Py_buffer;
+    if(PyObject_GetBuffer(obj, view, flags) != 0) {
+      PyErr_Clear();
+      delete view;
+      return nullptr;
+    }
+    pressio_dtype dtype = pressio_byte_dtype;
+    std::vector<size_t> dims{static_cast<size_t>(view->len)};
+    if(!as_bytes) {
+      if(view->ndim == 0 || !_pressio_dtype_from_format(view->format, view->itemsize, &dtype)) {
+        PyBuffer_Release(view);
+        delete view;
+        return nullptr;
+      }
+      dims.assign(view->shape, view->shape + view->ndim);
+    }
+    return new pressio_data(pressio_data::move(dtype, view->buf, dims, _pressio_release_py_buffer, view));
+  }
+}
+#endif
+
+/**
+ * wraps a writable, C-contiguous object supporting the buffer protocol of any rank without copying it.
+ * The object is kept alive until the returned pressio_data is freed.
+ *
+ * \param[in] array the object to wrap
+ * \returns a new pressio_data or nullptr if the object cannot be wrapped without a copy
+ */
+pressio_data* _pressio_io_data_from_numpy_view(PyObject* array) {
+  return _pressio_wrap_py_buffer(array, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | PyBUF_WRITABLE, false);
+}
+
+/**
+ * creates a numpy array of any rank that refers to the buffer of data.  The buffer is moved into a capsule
+ * owned by the array, so data is left without a buffer and still needs to be freed.
+ *
+ * \param[in] data the data to convert, it must own its buffer
+ * \returns a new numpy array, or None if data does not own a buffer of a numeric type
+ */
+PyObject* _pressio_io_data_to_numpy_view(pressio_data* data) {
+  const int typenum = _pressio_numpy_typenum(data->dtype());
+  if(typenum < 0 || !data->has_data() || !data->owns_data()) {
+    Py_RETURN_NONE;
+  }
+  std::unique_ptr<pressio_data> owner(new pressio_data(std::move(*data)));
+  std::vector<npy_intp> dims(owner->dimensions().begin(), owner->dimensions().end());
+  PyObject* array = PyArray_SimpleNewFromData(static_cast<int>(dims.size()), dims.data(), typenum, owner->data());
+  if(array == nullptr) {
+    *data = std::move(*owner);
+    return nullptr;
+  }
+  PyObject* capsule = PyCapsule_New(owner.get(), "pressio_data", _pressio_free_capsule_data);
+  if(capsule == nullptr) {
+    Py_DECREF(array);
+    *data = std::move(*owner);
+    return nullptr;
+  }
+  owner.release();
+  if(PyArray_SetBaseObject(reinterpret_cast<PyArrayObject*>(array), capsule) != 0) {
+    //the capsule reference is stolen even on failure and frees the buffer
+    Py_DECREF(array);
+    return nullptr;
+  }
+  return array;
+}
+
+/**
+ * creates a numpy array of any rank holding a copy of data
+ *
+ * \param[in] data the data to convert
+ * \returns a new numpy array, or None if data is not of a numeric type
+ */
+PyObject* _pressio_io_data_to_numpy_copy(pressio_data const* data) {
+  pressio_data copy = pressio_data::clone(*data);
+  return _pressio_io_data_to_numpy_view(&copy);
+}
+
+#ifndef SWIG
+namespace {
+  /**
+   * owns the pressio_data structures of a batch;  they are freed while holding the GIL since
+   * they may refer to python buffers
+   */
+  struct _pressio_batch {
+    ~_pressio_batch() {
+      for (auto i : inputs) delete i;
+      for (auto o : outputs) delete o;
+    }
+    std::vector<const pressio_data*> inputs;
+    std::vector<pressio_data*> outputs;
+  };
+
+  /**
+   * wraps each element of sequence appending it to batch
+   * \returns false and sets a python exception if an element could not be wrapped
+   */
+  template <class T>
+  bool _pressio_wrap_sequence(PyObject* sequence, int flags, bool as_bytes, std::vector<T*>& batch, const char* what) {
+    PyObject* fast = PySequence_Fast(sequence, "expected a sequence");
+    if(fast == nullptr) return false;
+    const Py_ssize_t size = PySequence_Fast_GET_SIZE(fast);
+    PyObject** items = PySequence_Fast_ITEMS(fast);
+    for (Py_ssize_t i = 0; i < size; ++i) {
+      pressio_data* data = _pressio_wrap_py_buffer(items[i], flags, as_bytes);
+      if(data == nullptr) {
+        PyErr_Format(PyExc_TypeError, "%s %zd must be a C-contiguous buffer of a numeric type", what, i);
+        Py_DECREF(fast);
+        return false;
+      }
+      batch.push_back(data);
+    }
+    Py_DECREF(fast);
+    return true;
+  }
+}
+#endif
+
+/**
+ * compresses each of a sequence of C-contiguous arrays in one call to pressio_compressor_compress_many
+ * without copying them.  The GIL is released while compressing.
+ *
+ * \param[in] compressor the compressor to use
+ * \param[in] arrays the arrays to compress
+ * \returns a list of bytes objects with the compressed arrays, or None if compression failed
+ */
+PyObject* _pressio_compressor_compress_many(pressio_compressor* compressor, PyObject* arrays) {
+  _pressio_batch batch;
+  if(!_pressio_wrap_sequence(arrays, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT, false, batch.inputs, "array")) {
+    return nullptr;
+  }
+  for (size_t i = 0; i < batch.inputs.size(); ++i) {
+    batch.outputs.push_back(new pressio_data(pressio_data::empty(pressio_byte_dtype, {})));
+  }
+  int rc;
+  Py_BEGIN_ALLOW_THREADS
+  rc = pressio_compressor_compress_many(compressor,
+      batch.inputs.data(), batch.inputs.size(),
+      batch.outputs.data(), batch.outputs.size());
+  Py_END_ALLOW_THREADS
+  if(rc) {
+    Py_RETURN_NONE;
+  }
+  PyObject* results = PyList_New(batch.outputs.size());
+  if(results == nullptr) return nullptr;
+  for (size_t i = 0; i < batch.outputs.size(); ++i) {
+    PyObject* bytes = PyBytes_FromStringAndSize(static_cast<const char*>(batch.outputs[i]->data()), batch.outputs[i]->size_in_bytes());
+    if(bytes == nullptr) {
+      Py_DECREF(results);
+      return nullptr;
+    }
+    PyList_SET_ITEM(results, i, bytes);
+  }
+  return results;
+}
+
+/**
+ * decompresses each of a sequence of buffers in one call to pressio_compressor_decompress_many.
+ * The outputs are decompressed into the provided arrays where the compressor supports it.  The GIL
+ * is released while decompressing.
+ *
+ * \param[in] compressor the compressor to use
+ * \param[in] compressed the compressed buffers, for example bytes objects
+ * \param[in] decompressed writable C-contiguous arrays with the type and shape of the decompressed data
+ * \returns a list of numpy arrays with the decompressed data, or None if decompression failed
+ */
+PyObject* _pressio_compressor_decompress_many(pressio_compressor* compressor, PyObject* compressed, PyObject* decompressed) {
+  _pressio_batch batch;
+  if(!_pressio_wrap_sequence(compressed, PyBUF_C_CONTIGUOUS, true, batch.inputs, "compressed buffer") ||
+     !_pressio_wrap_sequence(decompressed, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | PyBUF_WRITABLE, false, batch.outputs, "output array")) {
+    return nullptr;
+  }
+  if(batch.inputs.size() != batch.outputs.size()) {
+    PyErr_SetString(PyExc_ValueError, "the number of compressed buffers and output arrays must match");
+    return nullptr;
+  }
+  int rc;
+  Py_BEGIN_ALLOW_THREADS
+  rc = pressio_compressor_decompress_many(compressor,
+      batch.inputs.data(), batch.inputs.size(),
+      batch.outputs.data(), batch.outputs.size());
+  Py_END_ALLOW_THREADS
+  if(rc) {
+    Py_RETURN_NONE;
+  }
+  PyObject* results = PyList_New(batch.outputs.size());
+  if(results == nullptr) return nullptr;
+  for (size_t i = 0; i < batch.outputs.size(); ++i) {
+    PyObject* array = _pressio_io_data_to_numpy_view(batch.outputs[i]);
+    if(array == Py_None) {
+      Py_DECREF(array);
+      array = _pressio_io_data_to_numpy_copy(batch.outputs[i]);
+    }
+    if(array == nullptr || array == Py_None) {
+      if(array == Py_None) {
+        Py_DECREF(array);
+        PyErr_Format(PyExc_TypeError, "output %zu is not of a numeric type", i);
+      }
+      Py_DECREF(results);
+      return nullptr;
+    }
+    PyList_SET_ITEM(results, i, array);
+  }
+  return results;
+}
+
 namespace {
   template <class T>
   pressio_data*